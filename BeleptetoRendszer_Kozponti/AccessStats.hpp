@@ -0,0 +1,546 @@
+/**
+ ***************************************************************************************************
+ * @file AccessStats.hpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief This file contains the definition of the AccessStats class.
+ ***************************************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include "AuthenticateList.hpp"
+
+/**
+ * @brief Number of UIDs with statistics, must be a power of 2 and at least AUTH_LIST_SIZE.
+ */
+#define ACCESS_STATS_MAX_UIDS 256
+
+/**
+ * @brief Marks a missing first-in or last-out time.
+ */
+#define ACCESS_STATS_NO_TIME 0xFFFF
+
+/**
+ * @brief Statistics of a UID.
+ */
+typedef struct _access_stats_entry
+{
+    uint32_t uidHash; /**< Hash of the UID, 0 if the entry is free */
+    uint16_t grants;  /**< Number of granted accesses */
+    uint16_t denies;  /**< Number of denied accesses */
+    uint16_t firstIn; /**< Minute of the day of the first granted access on the current day */
+    uint16_t lastOut; /**< Minute of the day of the last granted access on the current day */
+} access_stats_entry_t;
+
+/**
+ * @brief Access statistics, updated by every added log.
+ * @note The UIDs of the auth list are kept by their 32 bit hash in an open addressing hash table,
+ *       every UID of the list has an entry from setAuthList(), so updating a UID costs a hash and
+ *       usually one probe, without scanning the list. The accesses of the unknown UIDs are counted
+ *       together in the overflow counters, so the swipes of random cards do not fill the table.
+ *       The counters saturate at 65535.
+ */
+class AccessStats
+{
+public:
+    /**
+     * @brief Size of the statistics in the EEPROM.
+     * @note Format: MAGIC{2} + DAY{2} + OVERFLOW_GRANTS{2} + OVERFLOW_DENIES{2} + AUTH_HASH{4} +
+     *       (HOUR_GRANTS{2} + HOUR_DENIES{2}) * 24 + (GRANTS{2} + DENIES{2} + FIRST_IN{12 bits} +
+     *       LAST_OUT{12 bits}) * AUTH_LIST_SIZE, big endian. The UIDs are not saved, the records
+     *       follow the order of the auth list saved in the same image, AUTH_HASH is the hash of
+     *       its UIDs. A missing time is 0xFFF.
+     */
+    static const uint16_t STORAGE_SIZE = 12 + 24 * 4 + AUTH_LIST_SIZE * 7;
+
+private:
+    static_assert(ACCESS_STATS_MAX_UIDS >= AUTH_LIST_SIZE, "every UID of the auth list must fit");
+    static_assert((ACCESS_STATS_MAX_UIDS & (ACCESS_STATS_MAX_UIDS - 1)) == 0,
+                  "ACCESS_STATS_MAX_UIDS must be a power of 2");
+
+    static const uint16_t MAGIC = 0x5355;
+
+    access_stats_entry_t entries[ACCESS_STATS_MAX_UIDS];
+
+    /**
+     * @brief The published auth list, only its UIDs get an entry.
+     */
+    const AuthenticateList *authList = nullptr;
+
+    uint16_t hourGrants[24];
+    uint16_t hourDenies[24];
+
+    uint16_t overflowGrants = 0;
+    uint16_t overflowDenies = 0;
+
+    /**
+     * @brief The current day (days since the epoch), first-in and last-out are kept for it.
+     */
+    uint16_t day = 0;
+
+public:
+    /**
+     * @brief Default constructor
+     */
+    AccessStats(void)
+    {
+        clear();
+    }
+
+    /**
+     * @brief Clear the statistics.
+     */
+    void clear(void)
+    {
+        memset(entries, 0, sizeof(entries));
+        memset(hourGrants, 0, sizeof(hourGrants));
+        memset(hourDenies, 0, sizeof(hourDenies));
+        overflowGrants = 0;
+        overflowDenies = 0;
+        day = 0;
+        insertAuthList();
+    }
+
+    /**
+     * @brief Set the auth list whose UIDs are counted one by one.
+     * @param auth_list The published auth list
+     * @note Set it again when the list is replaced, the entries of the removed UIDs move to the
+     *       overflow counters and the new UIDs get an entry.
+     */
+    void setAuthList(const AuthenticateList *auth_list)
+    {
+        authList = auth_list;
+        removeUnlisted();
+        insertAuthList();
+    }
+
+    /**
+     * @brief Count an access.
+     * @param uid UID of an RFID tag
+     * @param timestamp Time of the access, 0 if unknown
+     * @param auth Authentication state, nonzero if granted
+     * @note First-in and last-out are reset when an access of a later day arrives. The accesses of
+     *       earlier days, uploaded late by a reader, are only counted.
+     */
+    void add(const uint8_t *uid, uint32_t timestamp, uint8_t auth)
+    {
+        bool granted = (auth != 0);
+        // Only the UIDs of the auth list have an entry
+        access_stats_entry_t *entry = find(hashUid(uid));
+        if (entry == nullptr)
+        {
+            increment(granted ? &overflowGrants : &overflowDenies);
+        }
+        else
+        {
+            increment(granted ? &(entry->grants) : &(entry->denies));
+        }
+
+        if (timestamp == 0)
+        {
+            // The clock of the reader was not set
+            return;
+        }
+
+        uint8_t hour = timestamp % (60 * 60 * 24) / (60 * 60);
+        increment(granted ? &(hourGrants[hour]) : &(hourDenies[hour]));
+
+        uint16_t access_day = timestamp / (60 * 60 * 24);
+        if (access_day > day)
+        {
+            startDay(access_day);
+        }
+        if ((entry != nullptr) && granted && (access_day == day))
+        {
+            uint16_t minute = timestamp % (60 * 60 * 24) / 60;
+            if ((entry->firstIn == ACCESS_STATS_NO_TIME) || (minute < entry->firstIn))
+            {
+                entry->firstIn = minute;
+            }
+            if ((entry->lastOut == ACCESS_STATS_NO_TIME) || (minute > entry->lastOut))
+            {
+                entry->lastOut = minute;
+            }
+        }
+    }
+
+    /**
+     * @brief Get an entry of the hash table.
+     * @param slot Slot of the table, 0 to ACCESS_STATS_MAX_UIDS - 1
+     * @return Pointer to the entry, nullptr if the slot is free or its UID had no access yet
+     */
+    const access_stats_entry_t *getEntry(int slot) const
+    {
+        if ((slot < 0) || (slot >= ACCESS_STATS_MAX_UIDS) || (entries[slot].uidHash == 0) ||
+            ((entries[slot].grants == 0) && (entries[slot].denies == 0)))
+        {
+            return nullptr;
+        }
+        return &(entries[slot]);
+    }
+
+    /**
+     * @brief Get the number of granted accesses in an hour of the day.
+     * @param hour Hour of the day
+     * @return Number of granted accesses
+     */
+    uint16_t getHourGrants(uint8_t hour) const
+    {
+        return (hour < 24) ? hourGrants[hour] : 0;
+    }
+
+    /**
+     * @brief Get the number of denied accesses in an hour of the day.
+     * @param hour Hour of the day
+     * @return Number of denied accesses
+     */
+    uint16_t getHourDenies(uint8_t hour) const
+    {
+        return (hour < 24) ? hourDenies[hour] : 0;
+    }
+
+    /**
+     * @brief Get the number of granted accesses of the UIDs that are not in the auth list.
+     * @return Number of granted accesses
+     */
+    uint16_t getOverflowGrants(void) const
+    {
+        return overflowGrants;
+    }
+
+    /**
+     * @brief Get the number of denied accesses of the UIDs that are not in the auth list.
+     * @return Number of denied accesses
+     */
+    uint16_t getOverflowDenies(void) const
+    {
+        return overflowDenies;
+    }
+
+    /**
+     * @brief Get the current day.
+     * @return Days since the epoch
+     */
+    uint16_t getDay(void) const
+    {
+        return day;
+    }
+
+    /**
+     * @brief Hash a UID.
+     * @param uid UID of an RFID tag
+     * @return Nonzero hash of the UID
+     */
+    static uint32_t hashUid(const uint8_t *uid)
+    {
+        uint32_t hash = 2166136261UL;
+        for (int i = 0; i < 10; i++)
+        {
+            hash ^= uid[i];
+            hash *= 16777619UL;
+        }
+        return (hash == 0) ? 1 : hash;
+    }
+
+    /**
+     * @brief Write the statistics into a buffer.
+     * @param buffer Buffer of STORAGE_SIZE bytes
+     * @note Only the UIDs of the auth list are saved, the accesses of the others are added to the
+     *       overflow counters.
+     */
+    void serialize(uint8_t *buffer) const
+    {
+        // The accesses of the table minus the saved ones go to the overflow counters
+        uint32_t grants = 0;
+        uint32_t denies = 0;
+        for (int i = 0; i < ACCESS_STATS_MAX_UIDS; i++)
+        {
+            grants += entries[i].grants;
+            denies += entries[i].denies;
+        }
+
+        int listed = (authList != nullptr) ? authList->size() : 0;
+        uint8_t *p = &(buffer[12 + 24 * 4]);
+        for (int i = 0; i < AUTH_LIST_SIZE; i++)
+        {
+            const access_stats_entry_t *entry = nullptr;
+            if (i < listed)
+            {
+                entry = find(hashUid(authList->get(i)->getUid()));
+            }
+            if (entry != nullptr)
+            {
+                grants -= (entry->grants < grants) ? entry->grants : grants;
+                denies -= (entry->denies < denies) ? entry->denies : denies;
+            }
+            uint16_t firstIn = (entry != nullptr) ? entry->firstIn & 0xFFF : 0xFFF;
+            uint16_t lastOut = (entry != nullptr) ? entry->lastOut & 0xFFF : 0xFFF;
+            p = put16(p, (entry != nullptr) ? entry->grants : 0);
+            p = put16(p, (entry != nullptr) ? entry->denies : 0);
+            p[0] = firstIn >> 4;
+            p[1] = ((firstIn & 0x0F) << 4) | (lastOut >> 8);
+            p[2] = lastOut & 0xFF;
+            p += 3;
+        }
+        p = buffer;
+        p = put16(p, MAGIC);
+        p = put16(p, day);
+        p = put16(p, saturate(overflowGrants + grants));
+        p = put16(p, saturate(overflowDenies + denies));
+        uint32_t authHash = (authList != nullptr) ? authList->hashUids() : 0;
+        p = put16(p, authHash >> 16);
+        p = put16(p, authHash & 0xFFFF);
+        for (int i = 0; i < 24; i++)
+        {
+            p = put16(p, hourGrants[i]);
+            p = put16(p, hourDenies[i]);
+        }
+    }
+
+    /**
+     * @brief Read the statistics from a buffer.
+     * @param buffer Buffer of STORAGE_SIZE bytes
+     * @return True if the buffer held statistics, false if it did not and the statistics were cleared
+     * @note If the auth list is not the one saved with the statistics, the accesses of the UIDs are
+     *       added to the overflow counters.
+     */
+    bool deserialize(const uint8_t *buffer)
+    {
+        const uint8_t *p = buffer;
+        if (get16(&p) != MAGIC)
+        {
+            clear();
+            return false;
+        }
+        memset(entries, 0, sizeof(entries));
+        day = get16(&p);
+        overflowGrants = get16(&p);
+        overflowDenies = get16(&p);
+        uint32_t authHash = (uint32_t)get16(&p) << 16;
+        authHash |= get16(&p);
+        for (int i = 0; i < 24; i++)
+        {
+            hourGrants[i] = get16(&p);
+            hourDenies[i] = get16(&p);
+        }
+
+        bool listValid = (authList != nullptr) && (authHash == authList->hashUids());
+        for (int i = 0; i < AUTH_LIST_SIZE; i++)
+        {
+            uint16_t grants = get16(&p);
+            uint16_t denies = get16(&p);
+            uint16_t firstIn = ((uint16_t)(p[0]) << 4) | (p[1] >> 4);
+            uint16_t lastOut = ((uint16_t)(p[1] & 0x0F) << 8) | p[2];
+            p += 3;
+            if ((grants == 0) && (denies == 0))
+            {
+                continue;
+            }
+            if (!listValid || (i >= authList->size()))
+            {
+                overflowGrants = saturate((uint32_t)overflowGrants + grants);
+                overflowDenies = saturate((uint32_t)overflowDenies + denies);
+                continue;
+            }
+            access_stats_entry_t *entry = findOrInsert(hashUid(authList->get(i)->getUid()));
+            if (entry == nullptr)
+            {
+                overflowGrants = saturate((uint32_t)overflowGrants + grants);
+                overflowDenies = saturate((uint32_t)overflowDenies + denies);
+                continue;
+            }
+            entry->grants = grants;
+            entry->denies = denies;
+            entry->firstIn = (firstIn == 0xFFF) ? ACCESS_STATS_NO_TIME : firstIn;
+            entry->lastOut = (lastOut == 0xFFF) ? ACCESS_STATS_NO_TIME : lastOut;
+        }
+        insertAuthList();
+        return true;
+    }
+
+private:
+    /**
+     * @brief Find the entry of a UID.
+     * @param uidHash Hash of the UID
+     * @return Pointer to the entry, nullptr if the UID has none
+     */
+    const access_stats_entry_t *find(uint32_t uidHash) const
+    {
+        for (int i = 0; i < ACCESS_STATS_MAX_UIDS; i++)
+        {
+            const access_stats_entry_t *entry = &(entries[(uidHash + i) & (ACCESS_STATS_MAX_UIDS - 1)]);
+            if (entry->uidHash == uidHash)
+            {
+                return entry;
+            }
+            if (entry->uidHash == 0)
+            {
+                break;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Find the entry of a UID.
+     * @param uidHash Hash of the UID
+     * @return Pointer to the entry, nullptr if the UID has none
+     */
+    access_stats_entry_t *find(uint32_t uidHash)
+    {
+        return const_cast<access_stats_entry_t *>(static_cast<const AccessStats *>(this)->find(uidHash));
+    }
+
+    /**
+     * @brief Find the entry of a UID, or add one if the UID is new.
+     * @param uidHash Hash of the UID
+     * @return Pointer to the entry, nullptr if the table is full
+     */
+    access_stats_entry_t *findOrInsert(uint32_t uidHash)
+    {
+        // Linear probing
+        for (int i = 0; i < ACCESS_STATS_MAX_UIDS; i++)
+        {
+            access_stats_entry_t *entry = &(entries[(uidHash + i) & (ACCESS_STATS_MAX_UIDS - 1)]);
+            if (entry->uidHash == uidHash)
+            {
+                return entry;
+            }
+            if (entry->uidHash == 0)
+            {
+                entry->uidHash = uidHash;
+                entry->firstIn = ACCESS_STATS_NO_TIME;
+                entry->lastOut = ACCESS_STATS_NO_TIME;
+                return entry;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Add an entry for every UID of the auth list that has none.
+     */
+    void insertAuthList(void)
+    {
+        if (authList == nullptr)
+        {
+            return;
+        }
+        for (int i = 0; i < authList->size(); i++)
+        {
+            findOrInsert(hashUid(authList->get(i)->getUid()));
+        }
+    }
+
+    /**
+     * @brief Remove the entries of the UIDs that are not in the auth list, their accesses move to
+     *        the overflow counters.
+     */
+    void removeUnlisted(void)
+    {
+        // Mark the entries of the listed UIDs, one bit per slot
+        uint8_t listed[ACCESS_STATS_MAX_UIDS / 8];
+        memset(listed, 0, sizeof(listed));
+        int count = (authList != nullptr) ? authList->size() : 0;
+        for (int i = 0; i < count; i++)
+        {
+            const access_stats_entry_t *entry = find(hashUid(authList->get(i)->getUid()));
+            if (entry != nullptr)
+            {
+                int slot = entry - entries;
+                listed[slot / 8] |= (1 << (slot % 8));
+            }
+        }
+
+        for (int slot = 0; slot < ACCESS_STATS_MAX_UIDS; slot++)
+        {
+            // The freed slot may get an unlisted entry back from its probe sequence
+            while ((entries[slot].uidHash != 0) && !(listed[slot / 8] & (1 << (slot % 8))))
+            {
+                overflowGrants = saturate((uint32_t)overflowGrants + entries[slot].grants);
+                overflowDenies = saturate((uint32_t)overflowDenies + entries[slot].denies);
+                removeSlot(slot, listed);
+            }
+        }
+    }
+
+    /**
+     * @brief Remove an entry, the entries after it in its probe sequence are shifted back.
+     * @param slot Slot of the entry
+     * @param marks Marks of the slots, one bit per slot, moved together with the entries
+     */
+    void removeSlot(int slot, uint8_t *marks)
+    {
+        const int mask = ACCESS_STATS_MAX_UIDS - 1;
+        int hole = slot;
+        for (int next = (slot + 1) & mask; entries[next].uidHash != 0; next = (next + 1) & mask)
+        {
+            // An entry stays if its home slot is after the hole, up to its own slot
+            int home = entries[next].uidHash & mask;
+            bool stays = (hole <= next) ? ((hole < home) && (home <= next))
+                                        : ((hole < home) || (home <= next));
+            if (stays)
+            {
+                continue;
+            }
+            entries[hole] = entries[next];
+            if (marks[next / 8] & (1 << (next % 8)))
+            {
+                marks[hole / 8] |= (1 << (hole % 8));
+            }
+            else
+            {
+                marks[hole / 8] &= ~(1 << (hole % 8));
+            }
+            hole = next;
+        }
+        memset(&(entries[hole]), 0, sizeof(entries[hole]));
+        marks[hole / 8] &= ~(1 << (hole % 8));
+    }
+
+    /**
+     * @brief Start a new day, the first-in and last-out times are reset.
+     * @param new_day Days since the epoch
+     */
+    void startDay(uint16_t new_day)
+    {
+        day = new_day;
+        for (int i = 0; i < ACCESS_STATS_MAX_UIDS; i++)
+        {
+            entries[i].firstIn = ACCESS_STATS_NO_TIME;
+            entries[i].lastOut = ACCESS_STATS_NO_TIME;
+        }
+    }
+
+    static void increment(uint16_t *counter)
+    {
+        if (*counter < 0xFFFF)
+        {
+            (*counter)++;
+        }
+    }
+
+    static uint16_t saturate(uint32_t value)
+    {
+        return (value > 0xFFFF) ? 0xFFFF : value;
+    }
+
+    static uint8_t *put16(uint8_t *p, uint16_t value)
+    {
+        p[0] = value >> 8;
+        p[1] = value & 0xFF;
+        return p + 2;
+    }
+
+    static uint16_t get16(const uint8_t **p)
+    {
+        uint16_t value = ((uint16_t)((*p)[0]) << 8) | (*p)[1];
+        *p += 2;
+        return value;
+    }
+}; // AccessStats
@@ -19,20 +19,23 @@
 class AuthenticateData
 {
 private:
-    const int uidSize = 10;
-    const int nameSize = 16;
+    static const int uidSize = 10;
+    static const int nameSize = 16;
 
     uint8_t uid[10];
     char name[17];
-    uint32_t interval_start;
-    uint32_t interval_end;
+
+    /**
+     * @brief ID of the authentication interval in the ScheduleTable of the list.
+     */
+    uint8_t schedule_id;
 
 public:
     /**
      * @brief Default constructor
      */
     AuthenticateData(void)
-        : interval_start(0), interval_end(0)
+        : schedule_id(0)
     {
         for (int i = 0; i < uidSize; i++)
         {
@@ -45,11 +48,10 @@ public:
      * @brief Constructor with data initialization
      * @param uid UID of an RFID tag
      * @param name Name of the RFID tag owner
-     * @param interval_start Start of the authentication interval
-     * @param interval_end End of the authentication interval
+     * @param schedule_id ID of the authentication interval
      */
-    AuthenticateData(const uint8_t *uid, const char *name, uint32_t interval_start, uint32_t interval_end)
-        : interval_start(interval_start), interval_end(interval_end)
+    AuthenticateData(const uint8_t *uid, const char *name, uint8_t schedule_id)
+        : schedule_id(schedule_id)
     {
         for (int i = 0; i < uidSize; i++)
         {
@@ -64,7 +66,7 @@ public:
      * @param other Other AuthenticateData object
      */
     AuthenticateData(const AuthenticateData &other)
-        : interval_start(other.interval_start), interval_end(other.interval_end)
+        : schedule_id(other.schedule_id)
     {
         for (int i = 0; i < uidSize; i++)
         {
@@ -102,39 +104,21 @@ public:
     }
 
     /**
-     * @brief Get the start of the authentication interval
-     * @return Start of the authentication interval
-     */
-    uint32_t getIntervalStart(void) const
-    {
-        return interval_start;
-    }
-
-    /**
-     * @brief Get the end of the authentication interval
-     * @return End of the authentication interval
-     */
-    uint32_t getIntervalEnd(void) const
-    {
-        return interval_end;
-    }
-
-    /**
-     * @brief Set the interval start
-     * @param interval_start Start of the authentication interval
+     * @brief Get the ID of the authentication interval
+     * @return ID of the authentication interval
      */
-    void setIntervalStart(uint32_t interval_start)
+    uint8_t getScheduleId(void) const
     {
-        this->interval_start = interval_start;
+        return schedule_id;
     }
 
     /**
-     * @brief Set the interval end
-     * @param interval_end End of the authentication interval
+     * @brief Set the ID of the authentication interval
+     * @param schedule_id ID of the authentication interval
      */
-    void setIntervalEnd(uint32_t interval_end)
+    void setScheduleId(uint8_t schedule_id)
     {
-        this->interval_end = interval_end;
+        this->schedule_id = schedule_id;
     }
 
     /**
@@ -150,8 +134,7 @@ public:
         }
         strncpy(this->name, other.name, nameSize);
         this->name[nameSize] = '\0';
-        this->interval_start = other.interval_start;
-        this->interval_end = other.interval_end;
+        this->schedule_id = other.schedule_id;
         return *this;
     }
 
@@ -170,18 +153,19 @@ public:
             }
         }
         bool name_equal = (strcmp(this->name, other.name) == 0);
-        bool interval_start_equal = (this->interval_start == other.interval_start);
-        bool interval_end_equal = (this->interval_end == other.interval_end);
+        bool schedule_equal = (this->schedule_id == other.schedule_id);
 
-        return name_equal && interval_start_equal && interval_end_equal;
+        return name_equal && schedule_equal;
     }
 
     /**
      * @brief Convert the object to a string
      * @param str String to be filled
+     * @param interval_start Start of the authentication interval, from the ScheduleTable of the list
+     * @param interval_end End of the authentication interval, from the ScheduleTable of the list
      * @note Format: "UID{20} NAME{16} INTERVAL_START{10} INTERVAL_END{10}"
      */
-    void toString(char *str) const
+    void toString(char *str, uint32_t interval_start, uint32_t interval_end) const
     {
         sprintf(str, "%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X %16s %010u %010u",
                 uid[0], uid[1], uid[2], uid[3], uid[4],
@@ -12,14 +12,30 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "CircularBuffer.hpp"
 #include "AuthenticateData.hpp"
+#include "BloomFilter.hpp"
+#include "ScheduleTable.hpp"
 
 /**
- * @brief Size of the authentication list.
+ * @brief Size of the authentication list, it holds AUTH_LIST_SIZE - 1 users.
+ * @note The records of 30 bytes must end before the logs in the EEPROM image, at half of it.
  */
-#define AUTH_LIST_SIZE 145
+#define AUTH_LIST_SIZE 137
+
+/**
+ * @brief Number of bits of the UID filter of the authentication list.
+ * @note With 7 hashes the false positive rate at 137 entries is 0.10% (0.13% measured with random
+ *       UIDs), so almost every unknown UID is rejected without scanning the list.
+ */
+#define AUTH_LIST_FILTER_BITS 2048
+
+/**
+ * @brief Number of hashes of the UID filter of the authentication list.
+ */
+#define AUTH_LIST_FILTER_HASHES 7
 
 class AuthenticateList
 {
@@ -29,14 +45,64 @@ private:
      */
     CircularBuffer<AuthenticateData, AUTH_LIST_SIZE> data_list;
 
+    /**
+     * @brief Indices of the authentication data ordered by name.
+     * @note Maintained incrementally on add and remove.
+     */
+    uint8_t name_index[AUTH_LIST_SIZE];
+
+    /**
+     * @brief Filter of the UIDs in the list, for the fast rejection of unknown UIDs.
+     * @note Updated on add and clear. The removed UIDs stay in it until refreshUidFilter(), they
+     *       only make the filter pass more unknown UIDs.
+     */
+    BloomFilter<AUTH_LIST_FILTER_BITS, AUTH_LIST_FILTER_HASHES, 10> uid_filter;
+
+    /**
+     * @brief Number of UIDs removed since the filter was built, they still pass the filter.
+     */
+    uint16_t uid_filter_removed = 0;
+
+    /**
+     * @brief Authentication intervals of the list, the data refer to them by ID.
+     */
+    ScheduleTable schedules;
+
+    /**
+     * @brief Incremented on every change of the list.
+     */
+    uint32_t version = 0;
+
 public:
     /**
      * @brief Add an authentication data to the list.
-     * @param data Pointer to the authentication data
+     * @param uid UID of an RFID tag
+     * @param name Name of the RFID tag owner
+     * @param interval_start Start of the authentication interval
+     * @param interval_end End of the authentication interval
+     * @return True if added
+     * @note Not added if the list is full, or the interval is new and the schedule table is full.
      */
-    void add(const AuthenticateData *data)
+    bool add(const uint8_t *uid, const char *name, uint32_t interval_start, uint32_t interval_end)
     {
-        data_list.enqueue(data);
+        bool added = false;
+        int schedule_id = schedules.intern(interval_start, interval_end);
+        if (schedule_id != -1)
+        {
+            AuthenticateData data(uid, name, schedule_id);
+            if (data_list.enqueue(&data))
+            {
+                insertIntoNameIndex(data_list.size() - 1);
+                uid_filter.add(data.getUid());
+                added = true;
+            }
+            else
+            {
+                schedules.release(schedule_id);
+            }
+        }
+        version++;
+        return added;
     }
 
     /**
@@ -45,21 +111,61 @@ public:
      * @param name Name of the RFID tag owner
      * @param interval_start Start of the authentication interval
      * @param interval_end End of the authentication interval
+     * @return True if added
      */
-    void add(const uint8_t *uid, const char *name, uint32_t interval_start, uint32_t interval_end)
+    bool add(const char *uid, const char *name, uint32_t interval_start, uint32_t interval_end)
     {
-        AuthenticateData data(uid, name, interval_start, interval_end);
-        data_list.enqueue(&data);
+        uint8_t uid_bytes[10];
+        sscanf(uid, "%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx",
+               &uid_bytes[0], &uid_bytes[1], &uid_bytes[2], &uid_bytes[3],
+               &uid_bytes[4], &uid_bytes[5], &uid_bytes[6], &uid_bytes[7],
+               &uid_bytes[8], &uid_bytes[9]);
+
+        return add(uid_bytes, name, interval_start, interval_end);
     }
 
     /**
-     * @brief Add an authentication data to the list.
+     * @brief Add an authentication data to the list, replacing the one with the same UID.
+     * @param uid UID of an RFID tag
+     * @param name Name of the RFID tag owner
+     * @param interval_start Start of the authentication interval
+     * @param interval_end End of the authentication interval
+     * @return True if added or replaced
+     * @note If the new interval does not fit in the schedule table, the old data is kept.
+     */
+    bool addOrReplace(const uint8_t *uid, const char *name, uint32_t interval_start, uint32_t interval_end)
+    {
+        int index = findByUid(uid);
+        if (index == -1)
+        {
+            return add(uid, name, interval_start, interval_end);
+        }
+
+        // The new interval is held while the old data is removed, so its slot cannot be lost. If
+        // the table is full, only the slot freed by the old data can take it.
+        int schedule_id = schedules.intern(interval_start, interval_end);
+        if ((schedule_id == -1) && (schedules.getUsers(data_list[index]->getScheduleId()) != 1))
+        {
+            return false;
+        }
+        remove(index);
+        bool added = add(uid, name, interval_start, interval_end);
+        if (schedule_id != -1)
+        {
+            schedules.release(schedule_id);
+        }
+        return added;
+    }
+
+    /**
+     * @brief Add an authentication data to the list, replacing the one with the same UID.
      * @param uid UID of an RFID tag
      * @param name Name of the RFID tag owner
      * @param interval_start Start of the authentication interval
      * @param interval_end End of the authentication interval
+     * @return True if added or replaced
      */
-    void add(const char *uid, const char *name, uint32_t interval_start, uint32_t interval_end)
+    bool addOrReplace(const char *uid, const char *name, uint32_t interval_start, uint32_t interval_end)
     {
         uint8_t uid_bytes[10];
         sscanf(uid, "%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx",
@@ -67,8 +173,7 @@ public:
                &uid_bytes[4], &uid_bytes[5], &uid_bytes[6], &uid_bytes[7],
                &uid_bytes[8], &uid_bytes[9]);
 
-        AuthenticateData data(uid_bytes, name, interval_start, interval_end);
-        data_list.enqueue(&data);
+        return addOrReplace(uid_bytes, name, interval_start, interval_end);
     }
 
     /**
@@ -94,43 +199,38 @@ public:
     /**
      * @brief Remove the authentication data at the given index.
      * @param index Index of the authentication data
+     * @return True if removed, false if the index is out of range
      */
-    void remove(int index)
+    bool remove(int index)
     {
+        if (index < 0 || index >= data_list.size())
+        {
+            return false;
+        }
+        schedules.release(data_list[index]->getScheduleId());
+        removeFromNameIndex(index);
         data_list.remove(index);
+        uid_filter_removed++;
+        version++;
+        return true;
     }
 
     /**
      * @brief Remove the authentication data with the given UID.
      * @param uid UID of the authentication data
+     * @return True if removed, false if the UID is not in the list
      */
-    void remove(const uint8_t *uid)
+    bool remove(const uint8_t *uid)
     {
-        for (int i = 0; i < data_list.size(); i++)
-        {
-            const uint8_t *data_uid = data_list[i]->getUid();
-            bool match = true;
-            for (int j = 0; j < data_list[i]->getUidSize(); j++)
-            {
-                if (data_uid[j] != uid[j])
-                {
-                    match = false;
-                    break;
-                }
-            }
-            if (match)
-            {
-                data_list.remove(i);
-                break;
-            }
-        }
+        return remove(findByUid(uid));
     }
 
     /**
      * @brief Remove the authentication data with the given UID.
      * @param uid UID of the authentication data
+     * @return True if removed, false if the UID is not in the list
      */
-    void remove(const char *uid)
+    bool remove(const char *uid)
     {
         uint8_t uid_bytes[10];
         sscanf(uid, "%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx",
@@ -138,7 +238,7 @@ public:
                &uid_bytes[4], &uid_bytes[5], &uid_bytes[6], &uid_bytes[7],
                &uid_bytes[8], &uid_bytes[9]);
 
-        remove(uid_bytes);
+        return remove(uid_bytes);
     }
 
     /**
@@ -167,6 +267,11 @@ public:
      */
     int findByUid(const uint8_t *uid) const
     {
+        if (!uid_filter.mayContain(uid))
+        {
+            return -1;
+        }
+
         for (int i = 0; i < data_list.size(); i++)
         {
             const uint8_t *data_uid = data_list[i]->getUid();
@@ -226,5 +331,369 @@ public:
         {
             // Do nothing
         }
+        uid_filter.clear();
+        uid_filter_removed = 0;
+        schedules.clear();
+        version++;
+    }
+
+    /**
+     * @brief Get the start of the authentication interval of the data at the given index.
+     * @param index Index of the authentication data
+     * @return Start of the authentication interval
+     */
+    uint32_t getIntervalStart(int index) const
+    {
+        return schedules.getStart(data_list[index]->getScheduleId());
+    }
+
+    /**
+     * @brief Get the end of the authentication interval of the data at the given index.
+     * @param index Index of the authentication data
+     * @return End of the authentication interval
+     */
+    uint32_t getIntervalEnd(int index) const
+    {
+        return schedules.getEnd(data_list[index]->getScheduleId());
+    }
+
+    /**
+     * @brief Set the authentication interval of the data at the given index.
+     * @param index Index of the authentication data
+     * @param interval_start Start of the authentication interval
+     * @param interval_end End of the authentication interval
+     * @return True if set, false if the index is out of range or the schedule table is full
+     * @note Only this data is changed, use setSchedule() to change an interval for all its users.
+     */
+    bool setInterval(int index, uint32_t interval_start, uint32_t interval_end)
+    {
+        if (index < 0 || index >= data_list.size())
+        {
+            return false;
+        }
+
+        AuthenticateData *data = data_list[index];
+        uint8_t old_id = data->getScheduleId();
+        int schedule_id = schedules.intern(interval_start, interval_end);
+        if (schedule_id == -1)
+        {
+            if (schedules.getUsers(old_id) != 1)
+            {
+                return false;
+            }
+            // The only user, the interval is changed in place
+            schedules.set(old_id, interval_start, interval_end);
+        }
+        else
+        {
+            schedules.release(old_id);
+            data->setScheduleId(schedule_id);
+        }
+        version++;
+        return true;
+    }
+
+    /**
+     * @brief Change an authentication interval for all of its users.
+     * @param schedule_id ID of the interval
+     * @param interval_start Start of the authentication interval
+     * @param interval_end End of the authentication interval
+     * @return True if changed, false if the ID is not in use
+     * @note If another ID already has the new interval, the users of this one move to it and this
+     *       ID is freed, so an interval never has two IDs.
+     */
+    bool setSchedule(uint8_t schedule_id, uint32_t interval_start, uint32_t interval_end)
+    {
+        if (schedules.getUsers(schedule_id) == 0)
+        {
+            return false;
+        }
+
+        int existing = schedules.find(interval_start, interval_end);
+        if ((existing != -1) && (existing != schedule_id))
+        {
+            for (int i = 0; i < data_list.size(); i++)
+            {
+                if (data_list[i]->getScheduleId() == schedule_id)
+                {
+                    data_list[i]->setScheduleId(existing);
+                }
+            }
+            schedules.merge(schedule_id, existing);
+        }
+        else
+        {
+            schedules.set(schedule_id, interval_start, interval_end);
+        }
+        version++;
+        return true;
+    }
+
+    /**
+     * @brief Rebuild the UID filter if UIDs were removed since it was built.
+     * @note Called once after a batch of changes, so a batch with many removals rebuilds the filter
+     *       only once.
+     */
+    void refreshUidFilter(void)
+    {
+        if (uid_filter_removed > 0)
+        {
+            rebuildUidFilter();
+        }
+    }
+
+    /**
+     * @brief Get the authentication intervals of the list.
+     * @return Reference to the schedule table
+     */
+    const ScheduleTable &getSchedules() const
+    {
+        return schedules;
+    }
+
+    /**
+     * @brief Convert the authentication data at the given index to a string.
+     * @param index Index of the authentication data
+     * @param str String to be filled
+     * @note Format: see AuthenticateData::toString().
+     */
+    void toString(int index, char *str) const
+    {
+        data_list[index]->toString(str, getIntervalStart(index), getIntervalEnd(index));
+    }
+
+    /**
+     * @brief Get the index of the authentication data at the given position in name order.
+     * @param rank Position in name order
+     * @return Index of the authentication data, -1 if the position is out of range
+     */
+    int getSortedIndex(int rank) const
+    {
+        if (rank < 0 || rank >= data_list.size())
+        {
+            return -1;
+        }
+        return name_index[rank];
+    }
+
+    /**
+     * @brief Get the position of the authentication data in name order.
+     * @param index Index of the authentication data
+     * @return Position in name order, -1 if the index is out of range
+     */
+    int getRank(int index) const
+    {
+        for (int rank = 0; rank < data_list.size(); rank++)
+        {
+            if (name_index[rank] == index)
+            {
+                return rank;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Get the initial of the name at the given position in name order.
+     * @param rank Position in name order
+     * @return Upper case initial, '\0' if the position is out of range
+     */
+    char getInitial(int rank) const
+    {
+        if (rank < 0 || rank >= data_list.size())
+        {
+            return '\0';
+        }
+        return initialOf(data_list[name_index[rank]]->getName());
+    }
+
+    /**
+     * @brief Find the first name in name order whose initial is not less than the given one.
+     * @param initial Upper case initial
+     * @return Position in name order, size() if there is no such name
+     */
+    int findFirstByInitial(char initial) const
+    {
+        int low = 0;
+        int high = data_list.size();
+        while (low < high)
+        {
+            int middle = (low + high) / 2;
+            if ((uint8_t)getInitial(middle) < (uint8_t)initial)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    /**
+     * @brief Assignment operator.
+     * @param other The list to copy
+     * @return Reference to this list
+     * @note The version is not copied but incremented, so the change is always noticed.
+     */
+    AuthenticateList &operator=(const AuthenticateList &other)
+    {
+        if (this != &other)
+        {
+            data_list = other.data_list;
+            memcpy(name_index, other.name_index, sizeof(name_index));
+            uid_filter = other.uid_filter;
+            uid_filter_removed = other.uid_filter_removed;
+            schedules = other.schedules;
+            version++;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Get the version of the list.
+     * @return Counter that changes on every change of the list
+     * @note Changes made through the pointers returned by get() are not counted.
+     */
+    uint32_t getVersion() const
+    {
+        return version;
+    }
+
+    /**
+     * @brief Hash the UIDs of the list, in index order.
+     * @return FNV-1a hash of the UIDs
+     * @note Data saved with the list checks by it that the indices still point to the same UIDs.
+     */
+    uint32_t hashUids() const
+    {
+        uint32_t hash = 2166136261UL;
+        for (int i = 0; i < data_list.size(); i++)
+        {
+            const uint8_t *uid = data_list[i]->getUid();
+            for (int j = 0; j < 10; j++)
+            {
+                hash ^= uid[j];
+                hash *= 16777619UL;
+            }
+        }
+        return hash;
+    }
+
+private:
+    /**
+     * @brief Get the first character of a name that is not a padding space.
+     * @param name Name
+     * @return Pointer to the first character
+     */
+    static const char *skipPadding(const char *name)
+    {
+        while (*name == ' ')
+        {
+            name++;
+        }
+        return name;
+    }
+
+    /**
+     * @brief Get the upper case initial of a name.
+     * @param name Name
+     * @return Upper case initial
+     */
+    static char initialOf(const char *name)
+    {
+        char initial = *skipPadding(name);
+        if (initial >= 'a' && initial <= 'z')
+        {
+            initial = initial - 'a' + 'A';
+        }
+        return initial;
+    }
+
+    /**
+     * @brief Compare two names case insensitively, ignoring the padding spaces.
+     * @param a First name
+     * @param b Second name
+     * @return Negative if a is before b, 0 if equal, positive if a is after b
+     */
+    static int compareNames(const char *a, const char *b)
+    {
+        a = skipPadding(a);
+        b = skipPadding(b);
+        while (true)
+        {
+            uint8_t ca = (*a >= 'a' && *a <= 'z') ? (*a - 'a' + 'A') : (uint8_t)*a;
+            uint8_t cb = (*b >= 'a' && *b <= 'z') ? (*b - 'a' + 'A') : (uint8_t)*b;
+            if (ca != cb || ca == '\0')
+            {
+                return (int)ca - (int)cb;
+            }
+            a++;
+            b++;
+        }
+    }
+
+    /**
+     * @brief Rebuild the UID filter from the list.
+     */
+    void rebuildUidFilter(void)
+    {
+        uid_filter.clear();
+        uid_filter_removed = 0;
+        for (int i = 0; i < data_list.size(); i++)
+        {
+            uid_filter.add(data_list[i]->getUid());
+        }
+    }
+
+    /**
+     * @brief Insert the authentication data at the given index into the name index.
+     * @param index Index of the authentication data
+     * @note The index must be the last one, i.e. the data was just appended.
+     */
+    void insertIntoNameIndex(int index)
+    {
+        const char *name = data_list[index]->getName();
+
+        // Binary search for the position after the equal names, to keep the insertion order
+        int low = 0;
+        int high = index;
+        while (low < high)
+        {
+            int middle = (low + high) / 2;
+            if (compareNames(data_list[name_index[middle]]->getName(), name) <= 0)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        memmove(&(name_index[low + 1]), &(name_index[low]), index - low);
+        name_index[low] = index;
+    }
+
+    /**
+     * @brief Remove the authentication data at the given index from the name index.
+     * @param index Index of the authentication data
+     * @note Must be called before the data is removed from the list. The indices after the removed
+     *       one are shifted, as the list is shifted on removal.
+     */
+    void removeFromNameIndex(int index)
+    {
+        int count = data_list.size();
+        int rank = getRank(index);
+
+        memmove(&(name_index[rank]), &(name_index[rank + 1]), count - rank - 1);
+        for (int i = 0; i < count - 1; i++)
+        {
+            if (name_index[i] > index)
+            {
+                name_index[i]--;
+            }
+        }
     }
 }; // AuthenticateList
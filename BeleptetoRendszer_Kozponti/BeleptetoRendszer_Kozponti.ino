@@ -18,8 +18,16 @@
 #include "DataListManager.hpp"
 #include "realtime.h"
 #include "eeprom.h"
+#include "EepromStorageBackend.hpp"
 #include "UiStateMachine.hpp"
 #include "wifi.h"
+#include "scheduler.h"
+#include "profiler.h"
+#include "button.h"
+#include "frame.h"
+#include "serialtx.h"
+#include "authstore.h"
+#include "capture.h"
 
 // #define DEBUG 0
 
@@ -31,61 +39,194 @@
 
 /** @brief LCD display object. */
 LCD_I2C lcd(0x27, 16, 2);
+/** @brief The lower 3 bits of the device address of the EEPROM of the memory image. */
+#define EEPROM_ADDRESS_LOWER_3_BITS 0b111
+
+/** @brief EEPROM of the memory image. */
+EEPROM_24LC64 eeprom(Wire, EEPROM_ADDRESS_LOWER_3_BITS);
+/** @brief Storage of the memory image. */
+EepromStorageBackend eepromStorage(eeprom, EEPROM_24LC64_SIZE);
+/** @brief External EEPROM of the user store. */
+EEPROM_24LC64 authStoreEeprom(Wire, AUTH_STORE_ADDRESS_LOWER_3_BITS);
+/** @brief Storage of the user store. */
+EepromStorageBackend authStoreStorage(authStoreEeprom, AUTH_STORE_SIZE);
 /** @brief Data list manager object. */
 DataListManager dataListManager;
 /** @brief UI state machine object. */
-UiStateMachine uiStateMachine(&(dataListManager.authList), &lcd);
+UiStateMachine uiStateMachine(&dataListManager, &lcd);
+
+/**
+ * @defgroup button_hold_config Button hold configuration
+ * @brief Timing of the repeated events of the held LEFT and RIGHT buttons.
+ * @{
+ */
+#define BUTTON_HOLD_DELAY_MS 600
+#define BUTTON_HOLD_REPEAT_MS 300
+/** @} */
+
+/**
+ * @brief A batch update is discarded if no message arrives for this long.
+ */
+#define AUTH_BATCH_TIMEOUT_MS 30000
+
+/**
+ * @defgroup binary_records Binary records
+ * @brief Sizes of the records of the binary messages.
+ * @{
+ */
+/** @brief UID{10} + NAME{16} + INTERVAL_START{4} + INTERVAL_END{4}, big endian. */
+#define BINARY_ADD_RECORD_SIZE 34
+/** @brief UID{10}. */
+#define BINARY_REMOVE_RECORD_SIZE 10
+/** @} */
 
 /**
- * @defgroup button_state_bits Button state bits
- * @brief Bits for button states.
+ * @defgroup binary_status Binary reply status
+ * @brief Status codes of the replies to the binary messages.
  * @{
  */
-#define BUTTON_E_PRESSED_BIT (1 << 0)
-#define BUTTON_E_RELEASED_BIT (1 << 1)
-#define BUTTON_1_PRESSED_BIT (1 << 2)
-#define BUTTON_1_RELEASED_BIT (1 << 3)
-#define BUTTON_2_PRESSED_BIT (1 << 4)
-#define BUTTON_2_RELEASED_BIT (1 << 5)
-#define BUTTON_3_PRESSED_BIT (1 << 6)
-#define BUTTON_3_RELEASED_BIT (1 << 7)
+#define BINARY_STATUS_OK 0
+#define BINARY_STATUS_BAD_FRAME 1
+#define BINARY_STATUS_BAD_LENGTH 2
+#define BINARY_STATUS_UNKNOWN 3
+#define BINARY_STATUS_FULL 4
 /** @} */
 
-/** @brief Stores the button states. */
-uint32_t buttonSinglePressStates = 0;
+/**
+ * @brief An unfinished binary frame is dropped after this time, so a stray delimiter does not
+ *        hide the following ASCII messages. A full frame takes 22 ms at 115200 baud.
+ */
+#define BINARY_FRAME_TIMEOUT_MS 100
+
+/**
+ * @brief Maximum number of logs sent by one log export message.
+ */
+#define LOG_EXPORT_MAX_CHUNK 16
+
+/**
+ * @brief Space reserved in the transmit buffer for a line of a dump.
+ */
+#define DUMP_LINE_SIZE 80
+
+/**
+ * @brief Maximum length of an ASCII message, "#ID " and an 'A' message fit in it.
+ */
+#define MESSAGE_MAX_LENGTH 80
+
+/**
+ * @brief Number of ASCII messages that can wait for processing, e.g. during a dump.
+ */
+#define MESSAGE_QUEUE_SIZE 8
+
+/**
+ * @brief Size of the receive buffer of the UART, the core allocates 256 bytes by default.
+ * @note It holds the bytes that arrive while the queue is full, e.g. during a dump. A host that
+ *       streams commands must keep at most this many bytes of unanswered commands in flight
+ *       (besides the queued ones), the bytes over it are lost.
+ */
+#define SERIAL_RX_BUFFER_SIZE 1024
+
+/**
+ * @brief A received ASCII message waiting for processing.
+ */
+typedef struct _serial_message
+{
+    char text[MESSAGE_MAX_LENGTH + 1];
+} serial_message_t;
 
 /** @brief Begin marker of the message. */
 const char messageBeginMarker = '<';
 /** @brief End marker of the message. */
 const char messageEndMarker = '>';
 /** @brief Message buffer. */
-char message[64 + 1];
+char message[MESSAGE_MAX_LENGTH + 1];
 /** @brief Index of the message buffer. */
 int messageIndex = 0;
 /** @brief Stores if the message has started. */
 bool messageStarted = false;
+/** @brief Binary frame buffer. */
+uint8_t binaryFrame[FRAME_MAX_ENCODED];
+/** @brief Length of the received part of the binary frame, may exceed the buffer size. */
+int binaryFrameIndex = 0;
+/** @brief Stores if a binary frame has started. */
+bool binaryFrameStarted = false;
+/** @brief Start time of the binary frame. */
+unsigned long binaryFrameMillis = 0;
+/** @brief Messages waiting for processing, in order of arrival. */
+CircularBuffer<serial_message_t, MESSAGE_QUEUE_SIZE + 1> messageQueue;
+/** @brief Stores if the received binary frame waits for the queued messages. */
+bool binaryFramePending = false;
+/** @brief Sequence ID of the message being processed. */
+unsigned long replyTag = 0;
+/** @brief Stores if the message being processed has a sequence ID. */
+bool replyTagged = false;
+/** @brief Time of the last received message. */
+unsigned long lastMessageMillis = 0;
+
+/** @brief Buffered serial output, the replies are sent in order by taskSerialTransmit(). */
+Print &serialOut = SERIALTX_GetPrint();
+
+/** @brief Type of the dump in progress ('L', 'Q', 'G', 'F' or 'S'), 0 if there is none. */
+char dumpType = 0;
+/** @brief Index of the next item of the dump. */
+int dumpIndex = 0;
+/** @brief Index after the last item of the dump. */
+int dumpEnd = 0;
+/** @brief Indices of the logs found by the 'F' query, sent by the dump. */
+uint16_t queryResults[LOG_LIST_MAX_SIZE];
+/** @brief Version of the auth list when the 'Q' dump started. */
+uint32_t dumpVersion = 0;
+
+/**
+ * @brief Random ID of the run, reported by the log export.
+ * @note The log sequence numbers restart after a reset, the host detects it by the changed ID.
+ */
+uint16_t logExportSession = 0;
+
+/** @brief Start time of the batch update in progress. */
+unsigned long authBatchStartMicros = 0;
+/** @brief Number of entries added or replaced in the batch update in progress. */
+int authBatchAdded = 0;
+/** @brief Number of entries removed and not replaced in the batch update in progress. */
+int authBatchRemoved = 0;
 
 void ioPinsInit(void);
-void ioButtonSample(void);
-uint32_t ioButtonGetSinglePressStates(uint32_t bitMask);
+void countAuthBatchChange(bool removed, bool added);
 
 void processMessage(const char *msg);
+void beginReply(char type);
+void processBinaryMessage(const uint8_t *frame, int length);
+void sendBinaryReply(uint8_t type, uint8_t status, uint8_t count);
 void revceiveMessage(void);
 
+void startDump(char type, int index, int count);
+void continueDump(void);
+bool formatAccessStats(int item, char *line);
+
+void taskSerialTransmit(void);
+void taskButtons(void);
+void taskUserInterface(void);
+void taskEepromUpdate(void);
+void taskEepromCommit(void);
+
 /**
  * @brief Arduino setup function.
  */
 void setup()
 {
+    Serial.setRxBufferSize(SERIAL_RX_BUFFER_SIZE);
     Serial.begin(115200);
     delay(10);
     Serial.println();
 
     ioPinsInit();
 
+    logExportSession = ESP.random() & 0xFFFF;
+
     Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
 
-    EEPROM_Init();
+    EEPROM_Init(&eepromStorage);
+    AUTHSTORE_Init(&authStoreStorage);
 
 #ifdef DEBUG
     for (uint16_t i = 0; i < EEPROM_GetSize(); i++)
@@ -109,12 +250,17 @@ void setup()
     dataListManager.Initialize();
 
 #ifdef DEBUG
-    DEBUG_PRINT((dataListManager.authList).size());
+    if (dataListManager.getDroppedAuthCount() != 0)
+    {
+        DEBUG_PRINT(dataListManager.getDroppedAuthCount());
+        DEBUG_PRINT(" items dropped, the list or the schedule table is full!\r\n");
+    }
+    DEBUG_PRINT(dataListManager.getAuthList()->size());
     DEBUG_PRINT(" items in list:\r\n");
-    for (int i = 0; i < dataListManager.authList.size(); i++)
+    for (int i = 0; i < dataListManager.getAuthList()->size(); i++)
     {
         char buffer[64 + 1];
-        dataListManager.authList[i]->toString(buffer);
+        dataListManager.getAuthList()->toString(i, buffer);
         DEBUG_PRINT(buffer);
         DEBUG_PRINT("\r\n");
     }
@@ -131,6 +277,18 @@ void setup()
 
     lcd.begin(false);
     lcd.backlight();
+    uiStateMachine.Update(UiStateMachine::Button::NONE, millis());
+
+    // Communication and button events are handled in every pass to avoid missing messages and
+    // keep the user interface responsive, the periodic refresh and the EEPROM update run
+    // infrequently to save CPU time
+    SCHEDULER_AddPeriodic("wifi", WIFI_HandleClients, 0, SCHEDULER_PRIORITY_HIGH, 10000);
+    SCHEDULER_AddPeriodic("serial", revceiveMessage, 0, SCHEDULER_PRIORITY_HIGH, 10000);
+    SCHEDULER_AddPeriodic("tx", taskSerialTransmit, 0, SCHEDULER_PRIORITY_HIGH, 5000);
+    SCHEDULER_AddPeriodic("buttons", taskButtons, 0, SCHEDULER_PRIORITY_NORMAL, 20000);
+    SCHEDULER_AddPeriodic("ui", taskUserInterface, 1000, SCHEDULER_PRIORITY_NORMAL, 20000);
+    SCHEDULER_AddPeriodic("eeprom", taskEepromUpdate, 500, SCHEDULER_PRIORITY_LOW, 5000);
+    SCHEDULER_AddPeriodic("commit", taskEepromCommit, 1, SCHEDULER_PRIORITY_LOW, 2000);
 }
 
 /**
@@ -138,53 +296,105 @@ void setup()
  */
 void loop()
 {
-    static uint8_t ledState = LED_OFF;
-    static unsigned long lastMillisFast = 0;
-    static unsigned long lastMillisSlow = 0;
-
-    unsigned long current_millis = millis();
+    SCHEDULER_Run();
+}
 
-    if (current_millis - lastMillisFast > 50)
-    {
-        lastMillisFast = current_millis;
+/**
+ * @brief Dispatch the queued button events to the user interface.
+ * @note Holding LEFT or RIGHT generates repeated hold events, the list view pages with them.
+ */
+void taskButtons(void)
+{
+    static unsigned long holdMillis[BUTTON_COUNT];
 
-        // Sample buttons frequently
-        ioButtonSample();
-    }
+    BUTTON_Poll();
 
-    if (current_millis - lastMillisSlow > 500)
+    button_event_t event;
+    while (BUTTON_GetEvent(&event))
     {
-        lastMillisSlow = current_millis;
-
-        // Handle user interface and EEPROM update infrequently to save CPU time
-
-        if (ioButtonGetSinglePressStates(BUTTON_E_PRESSED_BIT))
-        {
-            uiStateMachine.Update(UiStateMachine::Button::ENTER, current_millis);
-        }
-        else if (ioButtonGetSinglePressStates(BUTTON_2_PRESSED_BIT))
-        {
-            uiStateMachine.Update(UiStateMachine::Button::BACK, current_millis);
-        }
-        else if (ioButtonGetSinglePressStates(BUTTON_1_PRESSED_BIT))
+        CAPTURE_Button(event.button, event.pressed);
+        if (!event.pressed)
         {
-            uiStateMachine.Update(UiStateMachine::Button::LEFT, current_millis);
+            continue;
         }
-        else if (ioButtonGetSinglePressStates(BUTTON_3_PRESSED_BIT))
-        {
-            uiStateMachine.Update(UiStateMachine::Button::RIGHT, current_millis);
-        }
-        else
+        holdMillis[event.button] = event.timeMillis + BUTTON_HOLD_DELAY_MS;
+
+        switch (event.button)
         {
-            uiStateMachine.Update(UiStateMachine::Button::NONE, current_millis);
+        case BUTTON_ID_E:
+            uiStateMachine.Update(UiStateMachine::Button::ENTER, event.timeMillis);
+            break;
+
+        case BUTTON_ID_2:
+            uiStateMachine.Update(UiStateMachine::Button::BACK, event.timeMillis);
+            break;
+
+        case BUTTON_ID_1:
+            uiStateMachine.Update(UiStateMachine::Button::LEFT, event.timeMillis);
+            break;
+
+        case BUTTON_ID_3:
+            uiStateMachine.Update(UiStateMachine::Button::RIGHT, event.timeMillis);
+            break;
         }
+    }
 
-        dataListManager.updateEepromFromList();
+    unsigned long current_millis = millis();
+    if (BUTTON_IsPressed(BUTTON_ID_1) && ((long)(current_millis - holdMillis[BUTTON_ID_1]) >= 0))
+    {
+        holdMillis[BUTTON_ID_1] = current_millis + BUTTON_HOLD_REPEAT_MS;
+        uiStateMachine.Update(UiStateMachine::Button::LEFT_HOLD, current_millis);
     }
+    if (BUTTON_IsPressed(BUTTON_ID_3) && ((long)(current_millis - holdMillis[BUTTON_ID_3]) >= 0))
+    {
+        holdMillis[BUTTON_ID_3] = current_millis + BUTTON_HOLD_REPEAT_MS;
+        uiStateMachine.Update(UiStateMachine::Button::RIGHT_HOLD, current_millis);
+    }
+}
 
-    // Handle communication tasks the most frequently to avoid missing messages and timeouts
-    WIFI_HandleClients();
-    revceiveMessage();
+/**
+ * @brief Refresh the user interface.
+ * @note Only redraws if the displayed data or the minute of the clock changed, the button events
+ *       are handled by taskButtons() as soon as they arrive.
+ */
+void taskUserInterface(void)
+{
+    uiStateMachine.Update(UiStateMachine::Button::NONE, millis());
+}
+
+/**
+ * @brief Update the EEPROM memory image from the data lists.
+ */
+void taskEepromUpdate(void)
+{
+    dataListManager.updateEepromImageFromList();
+}
+
+/**
+ * @brief Write the updated pages of the EEPROM memory image to the EEPROM.
+ * @note Writes at most one page per run, so the other tasks are not blocked by the write cycles.
+ */
+void taskEepromCommit(void)
+{
+    EEPROM_MemoryImage_CommitStep();
+}
+
+/**
+ * @brief Count a change in the batch update in progress.
+ * @param removed True if an entry was removed.
+ * @param added True if an entry was added.
+ * @note Only the applied changes of an open batch are counted, not the single updates.
+ */
+void countAuthBatchChange(bool removed, bool added)
+{
+    if (added)
+    {
+        authBatchAdded++;
+    }
+    else if (removed)
+    {
+        authBatchRemoved++;
+    }
 }
 
 /**
@@ -193,168 +403,717 @@ void loop()
  */
 void processMessage(const char *msg)
 {
+    // Optional sequence ID: "#ID COMMAND", the reply is tagged with it
+    replyTagged = false;
+    if (msg[0] == '#')
+    {
+        char *end;
+        replyTag = strtoul(&(msg[1]), &end, 10);
+        if ((end == &(msg[1])) || (*end != ' '))
+        {
+            return;
+        }
+        replyTagged = true;
+        msg = end + 1;
+    }
+    bool acknowledge = false;
+
     String message(msg);
 
+    // Outside of a batch update every change is published at once as a batch of one
+    bool singleUpdate = (((message[0] == 'A') || (message[0] == 'R') ||
+                          ((message[0] == 'W') && (message.length() > 1))) &&
+                         (dataListManager.getAuthBatch() == nullptr));
+    if (singleUpdate)
+    {
+        dataListManager.beginAuthBatch(true);
+    }
+    AuthenticateList *authList = dataListManager.getAuthBatch();
+
     if (message[0] == 'A')
     {
-        // Add
+        // Add, the tagged reply is "<A ERR>" if the user could not be stored
         String uid = message.substring(2, 22);
         String name = message.substring(23, 39);
         String intervalStart = message.substring(40, 50);
         String intervalEnd = message.substring(51, 61);
 
-        (dataListManager.authList).remove(uid.c_str());
-        (dataListManager.authList).add(uid.c_str(), name.c_str(), intervalStart.toInt(), intervalEnd.toInt());
+        // A user is replaced in place, a new interval that does not fit keeps the old entry
+        bool added = authList->addOrReplace(uid.c_str(), name.c_str(), intervalStart.toInt(), intervalEnd.toInt());
+        if (!singleUpdate)
+        {
+            countAuthBatchChange(false, added);
+        }
+        if (added)
+        {
+            acknowledge = true;
+        }
+        else if (replyTagged)
+        {
+            beginReply('A');
+            serialOut.print(" ERR>");
+        }
     }
     else if (message[0] == 'R')
     {
-        // Remove
+        // Remove, the tagged reply is "<R ERR>" if the user was not in the list
         String uid = message.substring(2, 22);
 
-        (dataListManager.authList).remove(uid.c_str());
+        bool removed = authList->remove(uid.c_str());
+        if (!singleUpdate)
+        {
+            countAuthBatchChange(removed, false);
+        }
+        if (removed)
+        {
+            acknowledge = true;
+        }
+        else if (replyTagged)
+        {
+            beginReply('R');
+            serialOut.print(" ERR>");
+        }
+    }
+    else if (message[0] == 'B')
+    {
+        // Begin batch update, "B M" merges into the current list, otherwise the list is replaced
+        dataListManager.beginAuthBatch(message[2] == 'M');
+        authBatchStartMicros = micros();
+        authBatchAdded = 0;
+        authBatchRemoved = 0;
+
+        beginReply('B');
+        serialOut.print(">");
+    }
+    else if (message[0] == 'E')
+    {
+        // Commit batch update: "<E ADDED REMOVED SIZE BATCH_MS COMMIT_US>", "<E ERR>" without a batch
+        unsigned long commitStartMicros = micros();
+        if (dataListManager.commitAuthBatch())
+        {
+            unsigned long commitEndMicros = micros();
+
+            beginReply('E');
+            serialOut.print(" ");
+            serialOut.print(authBatchAdded);
+            serialOut.print(" ");
+            serialOut.print(authBatchRemoved);
+            serialOut.print(" ");
+            serialOut.print(dataListManager.getAuthList()->size());
+            serialOut.print(" ");
+            serialOut.print((commitEndMicros - authBatchStartMicros) / 1000);
+            serialOut.print(" ");
+            serialOut.print(commitEndMicros - commitStartMicros);
+            serialOut.print(">");
+        }
+        else
+        {
+            beginReply('E');
+            serialOut.print(" ERR>");
+        }
+    }
+    else if (message[0] == 'X')
+    {
+        // Abort batch update
+        dataListManager.abortAuthBatch();
+
+        beginReply('X');
+        serialOut.print(">");
     }
     else if (message[0] == 'T')
     {
-        // Time
+        // Time, optionally with milliseconds: "T SECONDS{10} [MILLIS{3}]"
         String time = message.substring(2, 12);
 
-        REALTIME_Set(time.toInt());
+        if (REALTIME_IsSet() && (message.length() >= 16))
+        {
+            // Small corrections are slewed to keep the log timestamps monotonic
+            String timeMillis = message.substring(13, 16);
+            int64_t target = (int64_t)time.toInt() * 1000 + timeMillis.toInt();
+            int64_t offset = target - (int64_t)REALTIME_GetMillis();
+            if ((offset > INT32_MAX) || (offset < INT32_MIN))
+            {
+                REALTIME_Set(time.toInt());
+            }
+            else
+            {
+                REALTIME_Adjust((int32_t)offset);
+            }
+        }
+        else
+        {
+            REALTIME_Set(time.toInt());
+        }
+        acknowledge = true;
     }
     else if (message[0] == 'L')
     {
         // Get log list
-        char buffer[32 + 1];
+        beginReply('L');
+        serialOut.print(" ");
+        serialOut.print((dataListManager.logList).size());
+        serialOut.print("\n");
+        startDump('L', 0, (dataListManager.logList).size());
+    }
+    else if (message[0] == 'G')
+    {
+        // Export logs from a sequence number: "G SEQ [COUNT]", at most LOG_EXPORT_MAX_CHUNK logs.
+        // Reply: "<G SESSION FIRST NEXT COUNT" and a "SEQ UID TIME AUTH" line per log, where
+        // FIRST is the oldest log kept and NEXT follows the last log of the list
+        unsigned long seq = 0;
+        int count = LOG_EXPORT_MAX_CHUNK;
+        sscanf(msg, "G %lu %d", &seq, &count);
+        if ((count <= 0) || (count > LOG_EXPORT_MAX_CHUNK))
+        {
+            count = LOG_EXPORT_MAX_CHUNK;
+        }
 
-        Serial.print("<L ");
-        Serial.print((dataListManager.logList).size());
-        Serial.print("\n");
-        for (int i = 0; i < (dataListManager.logList).size(); i++)
+        const LogList &logList = dataListManager.logList;
+        if (seq < logList.getFirstSequence())
         {
-            (dataListManager.logList).get(i)->toString(buffer);
-            Serial.print(buffer);
-            Serial.print("\n");
+            // The requested logs were already freed, continue with the oldest one
+            seq = logList.getFirstSequence();
         }
-        Serial.print(">");
+        int index = logList.findBySequence(seq);
+        if (index == -1)
+        {
+            count = 0;
+        }
+        else if (count > logList.size() - index)
+        {
+            count = logList.size() - index;
+        }
+
+        beginReply('G');
+        serialOut.print(" ");
+        serialOut.print(logExportSession);
+        serialOut.print(" ");
+        serialOut.print(logList.getFirstSequence());
+        serialOut.print(" ");
+        serialOut.print(logList.getNextSequence());
+        serialOut.print(" ");
+        serialOut.print(count);
+        serialOut.print("\n");
+        startDump('G', index, count);
+    }
+    else if (message[0] == 'F')
+    {
+        // Find logs: "F FROM TO [UID|*] [AUTH|*]", the time range is inclusive, AUTH is 0 or 1.
+        // Reply: "<F COUNT" and a "SEQ UID TIME AUTH" line per log in time order, "<F ERR>" if a
+        // filter is malformed
+        unsigned long from = 0;
+        unsigned long to = 0;
+        char uidText[21 + 1] = "*";
+        char authText = '*';
+        int fields = sscanf(msg, "F %lu %lu %21s %c", &from, &to, uidText, &authText);
+
+        uint8_t uid[10];
+        log_query_t query;
+        query.from = from;
+        query.to = to;
+        query.uid = nullptr;
+        query.auth = (authText == '*') ? -1 : (authText - '0');
+        bool valid = (fields >= 2) && ((authText == '*') || (authText == '0') || (authText == '1'));
+        if (valid && (strcmp(uidText, "*") != 0))
+        {
+            // A UID that does not parse must not turn into a query of every log
+            valid = (strlen(uidText) == 20) &&
+                    (strspn(uidText, "0123456789ABCDEFabcdef") == 20) &&
+                    (sscanf(uidText, "%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx",
+                            &uid[0], &uid[1], &uid[2], &uid[3], &uid[4],
+                            &uid[5], &uid[6], &uid[7], &uid[8], &uid[9]) == 10);
+            query.uid = uid;
+        }
+
+        beginReply('F');
+        if (!valid)
+        {
+            serialOut.print(" ERR>");
+        }
+        else
+        {
+            int count = (dataListManager.logList).query(&query, queryResults, LOG_LIST_MAX_SIZE);
+
+            serialOut.print(" ");
+            serialOut.print(count);
+            serialOut.print("\n");
+            startDump('F', 0, count);
+        }
+    }
+    else if (message[0] == 'K')
+    {
+        // Acknowledge and free the logs up to a sequence number: "K SEQ", reply: "<K FREED FIRST>"
+        unsigned long seq = 0;
+        int freed = 0;
+        if (sscanf(msg, "K %lu", &seq) == 1)
+        {
+            freed = (dataListManager.logList).acknowledge(seq);
+        }
+
+        beginReply('K');
+        serialOut.print(" ");
+        serialOut.print(freed);
+        serialOut.print(" ");
+        serialOut.print((dataListManager.logList).getFirstSequence());
+        serialOut.print(">");
     }
     else if (message[0] == 'Q')
     {
         // Get auth list
-        char buffer[64 + 1];
+        beginReply('Q');
+        serialOut.print(" ");
+        serialOut.print(dataListManager.getAuthList()->size());
+        serialOut.print("\n");
+        dumpVersion = dataListManager.getAuthListVersion();
+        startDump('Q', 0, dataListManager.getAuthList()->size());
+    }
+    else if (message[0] == 'P')
+    {
+        // Get loop time profile, "P R" resets it after printing
+        beginReply('P');
+        serialOut.print(" ");
+        PROFILER_Print(serialOut);
+        serialOut.print(">");
+        if (message[2] == 'R')
+        {
+            PROFILER_Reset();
+        }
+    }
+    else if (message[0] == 'W')
+    {
+        // Shared authentication intervals: "W ID START{10} END{10}" changes one for all its users,
+        // if another ID has that interval, the users join it and ID is freed,
+        // reply: "<W OK>" or "<W ERR>", "W" lists them: "<W\n" + "ID START END USERS\n" for each + ">"
+        unsigned int id;
+        unsigned long intervalStart;
+        unsigned long intervalEnd;
+        if (message.length() <= 1)
+        {
+            const ScheduleTable &schedules = dataListManager.getAuthList()->getSchedules();
+            beginReply('W');
+            serialOut.print("\n");
+            for (int i = 0; i < SCHEDULE_TABLE_SIZE; i++)
+            {
+                if (schedules.getUsers(i) != 0)
+                {
+                    char line[DUMP_LINE_SIZE];
+                    sprintf(line, "%d %010lu %010lu %u\n", i, (unsigned long)schedules.getStart(i),
+                            (unsigned long)schedules.getEnd(i), schedules.getUsers(i));
+                    serialOut.print(line);
+                }
+            }
+            serialOut.print(">");
+        }
+        else if ((sscanf(msg, "W %u %lu %lu", &id, &intervalStart, &intervalEnd) == 3) &&
+                 (id < SCHEDULE_TABLE_SIZE) && authList->setSchedule(id, intervalStart, intervalEnd))
+        {
+            beginReply('W');
+            serialOut.print(" OK>");
+        }
+        else
+        {
+            beginReply('W');
+            serialOut.print(" ERR>");
+        }
+    }
+    else if (message[0] == 'U')
+    {
+        // User store: "U A UID{20} NAME{16} START{10} END{10}" add, "U R UID{20}" remove, "U C" clear,
+        // reply: "<U OK>" or "<U ERR>", "U F UID{20}" find, reply: "<U UID NAME START END>" or
+        // "<U ERR>", "U S" statistics (reset by "U S R"), reply:
+        // "<U COUNT HITS MISSES SLOT_READS MISS_AVG_US MISS_MAX_US>". A, R and F with a UID that is
+        // short or not hex get "<U ERR>"
+        auth_store_record_t record;
+        String uidText = message.substring(4, 24);
+        bool uidValid = (uidText.length() == 20) &&
+                        (strspn(uidText.c_str(), "0123456789ABCDEFabcdef") == 20) &&
+                        (sscanf(uidText.c_str(), "%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx",
+                                &record.uid[0], &record.uid[1], &record.uid[2], &record.uid[3],
+                                &record.uid[4], &record.uid[5], &record.uid[6], &record.uid[7],
+                                &record.uid[8], &record.uid[9]) == 10);
 
-        Serial.print("<Q ");
-        Serial.print((dataListManager.authList).size());
-        Serial.print("\n");
-        for (int i = 0; i < (dataListManager.authList).size(); i++)
+        beginReply('U');
+        if (message[2] == 'F')
+        {
+            if (uidValid && AUTHSTORE_Find(record.uid, &record))
+            {
+                AuthenticateData data(record.uid, record.name, 0);
+                char line[DUMP_LINE_SIZE];
+                data.toString(line, record.intervalStart, record.intervalEnd);
+                serialOut.print(" ");
+                serialOut.print(line);
+                serialOut.print(">");
+            }
+            else
+            {
+                serialOut.print(" ERR>");
+            }
+        }
+        else if (message[2] == 'S')
+        {
+            auth_store_stats_t stats;
+            AUTHSTORE_GetStats(&stats);
+            char line[DUMP_LINE_SIZE];
+            sprintf(line, " %u %lu %lu %lu %lu %lu>", stats.count, (unsigned long)stats.hits,
+                    (unsigned long)stats.misses, (unsigned long)stats.slotReads,
+                    (unsigned long)((stats.misses == 0) ? 0 : (stats.missMicrosTotal / stats.misses)),
+                    (unsigned long)stats.missMicrosMax);
+            serialOut.print(line);
+            if (message[4] == 'R')
+            {
+                AUTHSTORE_ResetStats();
+            }
+        }
+        else
         {
-            (dataListManager.authList).get(i)->toString(buffer);
-            Serial.print(buffer);
-            Serial.print("\n");
+            bool success = false;
+            if ((message[2] == 'A') && uidValid)
+            {
+                strncpy(record.name, message.substring(25, 41).c_str(), 16);
+                record.name[16] = '\0';
+                record.intervalStart = message.substring(42, 52).toInt();
+                record.intervalEnd = message.substring(53, 63).toInt();
+                success = AUTHSTORE_Put(&record);
+            }
+            else if ((message[2] == 'R') && uidValid)
+            {
+                success = AUTHSTORE_Remove(record.uid);
+            }
+            else if (message[2] == 'C')
+            {
+                AUTHSTORE_Clear();
+                success = AUTH_STORE_ENABLED;
+            }
+            serialOut.print(success ? " OK>" : " ERR>");
         }
-        Serial.print(">");
     }
-    else if (message[0] = 'C')
+    else if (message[0] == 'S')
+    {
+        // Get access statistics: "<S DAY OVERFLOW_GRANTS OVERFLOW_DENIES\n" + 24 hour lines + UID lines
+        const AccessStats &stats = dataListManager.getAccessStats();
+        beginReply('S');
+        serialOut.print(" ");
+        serialOut.print(stats.getDay());
+        serialOut.print(" ");
+        serialOut.print(stats.getOverflowGrants());
+        serialOut.print(" ");
+        serialOut.print(stats.getOverflowDenies());
+        serialOut.print("\n");
+        startDump('S', 0, 24 + ACCESS_STATS_MAX_UIDS);
+    }
+    else if (message[0] == 'C')
     {
-        // Clear log list
+        // Clear log list, logs added since the last query are lost, use "K" to free the exported ones
         (dataListManager.logList).clear();
+        acknowledge = true;
+    }
+    else if (message[0] == 'Y')
+    {
+        // Record the inbound traffic for the replay on the host: "Y 1" starts, "Y 0" stops
+        if (CAPTURE_SetRecording(message[2] == '1'))
+        {
+            acknowledge = true;
+        }
+        else
+        {
+            beginReply('Y');
+            serialOut.print(" ERR>");
+        }
+    }
+    else if (replyTagged)
+    {
+        // Unknown command
+        beginReply(message[0]);
+        serialOut.print(" ERR>");
+    }
+
+    if (singleUpdate)
+    {
+        dataListManager.commitAuthBatch();
+    }
+
+    if (acknowledge && replyTagged)
+    {
+        // The commands without a reply are only acknowledged if tagged, for the old hosts
+        beginReply(message[0]);
+        serialOut.print(" OK>");
     }
 }
 
 /**
- * @brief Initialize the IO pins.
+ * @brief Print the beginning of a reply: the begin marker, the sequence ID of the message being
+ *        processed if it has one, and the type.
+ * @param type Type of the reply, the command letter.
  */
-void ioPinsInit(void)
+void beginReply(char type)
 {
-    pinMode(BUTTON_1_PIN, INPUT);
-    pinMode(BUTTON_2_PIN, INPUT);
-    pinMode(BUTTON_3_PIN, INPUT);
-    pinMode(BUTTON_E_PIN, INPUT);
-
-    pinMode(LED_1_PIN, OUTPUT);
-    pinMode(LED_2_PIN, OUTPUT);
-    pinMode(LED_3_PIN, OUTPUT);
-
-    digitalWrite(LED_1_PIN, LED_ON);
-    digitalWrite(LED_2_PIN, LED_ON);
-    digitalWrite(LED_3_PIN, LED_ON);
+    serialOut.print(messageBeginMarker);
+    if (replyTagged)
+    {
+        serialOut.print("#");
+        serialOut.print(replyTag);
+        serialOut.print(" ");
+    }
+    serialOut.print(type);
 }
 
 /**
- * @brief Sample the IO buttons.
+ * @brief Process the received binary message.
+ * @param frame The received frame without the delimiters.
+ * @param length The length of the frame, more than FRAME_MAX_ENCODED if it did not fit.
+ * @note Payload: TYPE{1} + COUNT{1} + COUNT records, see binary_records. Types: 'A' add, 'R'
+ *       remove. Reply: TYPE{1} + STATUS{1} + COUNT{1}, see binary_status. Outside of a batch update
+ *       the records of a message are published together. The users that do not fit in the list or
+ *       the schedule table are not counted and the status is BINARY_STATUS_FULL, the entries they
+ *       would replace are kept.
  */
-void ioButtonSample(void)
+void processBinaryMessage(const uint8_t *frame, int length)
 {
-    static uint8_t button1Prev = !BUTTON_PRESSED;
-    static uint8_t button2Prev = !BUTTON_PRESSED;
-    static uint8_t button3Prev = !BUTTON_PRESSED;
-    static uint8_t buttonEPrev = !BUTTON_PRESSED;
+    uint8_t payload[FRAME_MAX_ENCODED];
 
-    uint8_t button1 = digitalRead(BUTTON_1_PIN);
-    uint8_t button2 = digitalRead(BUTTON_2_PIN);
-    uint8_t button3 = digitalRead(BUTTON_3_PIN);
-    uint8_t buttonE = digitalRead(BUTTON_E_PIN);
+    if (length > FRAME_MAX_ENCODED)
+    {
+        sendBinaryReply(0, BINARY_STATUS_BAD_LENGTH, 0);
+        return;
+    }
 
-    if (button1 != button1Prev)
+    int payloadLength = FRAME_Decode(frame, length, payload);
+    if (payloadLength < 2)
     {
-        if (button1 == BUTTON_PRESSED)
+        sendBinaryReply(0, BINARY_STATUS_BAD_FRAME, 0);
+        return;
+    }
+
+    uint8_t type = payload[0];
+    uint8_t count = payload[1];
+    int recordSize;
+    if (type == 'A')
+    {
+        recordSize = BINARY_ADD_RECORD_SIZE;
+    }
+    else if (type == 'R')
+    {
+        recordSize = BINARY_REMOVE_RECORD_SIZE;
+    }
+    else
+    {
+        sendBinaryReply(type, BINARY_STATUS_UNKNOWN, 0);
+        return;
+    }
+
+    if (payloadLength != 2 + count * recordSize)
+    {
+        sendBinaryReply(type, BINARY_STATUS_BAD_LENGTH, 0);
+        return;
+    }
+
+    bool singleUpdate = (dataListManager.getAuthBatch() == nullptr);
+    if (singleUpdate)
+    {
+        dataListManager.beginAuthBatch(true);
+    }
+    AuthenticateList *authList = dataListManager.getAuthBatch();
+
+    uint8_t processed = 0;
+    const uint8_t *record = &(payload[2]);
+    for (uint8_t i = 0; i < count; i++, record += recordSize)
+    {
+        bool removed = false;
+        bool added = false;
+        if (type == 'R')
         {
-            buttonSinglePressStates |= BUTTON_1_PRESSED_BIT;
+            removed = authList->remove(record);
+            processed++;
         }
         else
         {
-            buttonSinglePressStates |= BUTTON_1_RELEASED_BIT;
+            char name[16 + 1];
+            memcpy(name, &(record[10]), 16);
+            name[16] = '\0';
+            uint32_t intervalStart = ((uint32_t)record[26] << 24) | ((uint32_t)record[27] << 16) |
+                                     ((uint32_t)record[28] << 8) | record[29];
+            uint32_t intervalEnd = ((uint32_t)record[30] << 24) | ((uint32_t)record[31] << 16) |
+                                   ((uint32_t)record[32] << 8) | record[33];
+
+            added = authList->addOrReplace(record, name, intervalStart, intervalEnd);
+            if (added)
+            {
+                processed++;
+            }
+        }
+        if (!singleUpdate)
+        {
+            countAuthBatchChange(removed, added);
         }
     }
-    if (button2 != button2Prev)
+
+    if (singleUpdate)
     {
-        if (button2 == BUTTON_PRESSED)
+        dataListManager.commitAuthBatch();
+    }
+
+    sendBinaryReply(type, (processed == count) ? BINARY_STATUS_OK : BINARY_STATUS_FULL, processed);
+}
+
+/**
+ * @brief Send the reply to a binary message.
+ * @param type Type of the message, 0 if unknown.
+ * @param status Status, see binary_status.
+ * @param count Number of records processed.
+ */
+void sendBinaryReply(uint8_t type, uint8_t status, uint8_t count)
+{
+    uint8_t reply[3] = {type, status, count};
+    FRAME_Send(serialOut, reply, sizeof(reply));
+}
+
+/**
+ * @brief Start sending the lines of a dump, the header must be already sent.
+ * @param type Type of the dump: 'L' logs, 'G' logs with sequence numbers, 'F' found logs with
+ *             sequence numbers, 'Q' auth list, 'S' access statistics.
+ * @param index Index of the first item.
+ * @param count Number of items.
+ * @note The lines are formatted by taskSerialTransmit() as the transmit buffer has space for them,
+ *       the dump ends with the end marker. The status lines printed meanwhile are sent after it.
+ */
+void startDump(char type, int index, int count)
+{
+    dumpType = type;
+    dumpIndex = index;
+    dumpEnd = index + count;
+    SERIALTX_BeginBlock(continueDump);
+    continueDump();
+}
+
+/**
+ * @brief Format the next lines of the dump in progress into the transmit buffer.
+ */
+void continueDump(void)
+{
+    while (dumpIndex < dumpEnd)
+    {
+        char *line = SERIALTX_Reserve(DUMP_LINE_SIZE);
+        if (line == nullptr)
         {
-            buttonSinglePressStates |= BUTTON_2_PRESSED_BIT;
+            return;
         }
-        else
+
+        int length = 0;
+        if (dumpType == 'Q')
         {
-            buttonSinglePressStates |= BUTTON_2_RELEASED_BIT;
+            if (dataListManager.getAuthListVersion() != dumpVersion)
+            {
+                // The list was replaced, the dump ends early and the host sees fewer lines than
+                // announced
+                break;
+            }
+            dataListManager.getAuthList()->toString(dumpIndex, line);
         }
-    }
-    if (button3 != button3Prev)
-    {
-        if (button3 == BUTTON_PRESSED)
+        else if (dumpType == 'S')
         {
-            buttonSinglePressStates |= BUTTON_3_PRESSED_BIT;
+            if (!formatAccessStats(dumpIndex, line))
+            {
+                // Free slot of the UID table
+                dumpIndex++;
+                continue;
+            }
         }
         else
         {
-            buttonSinglePressStates |= BUTTON_3_RELEASED_BIT;
+            int index = (dumpType == 'F') ? queryResults[dumpIndex] : dumpIndex;
+            if (dumpType != 'L')
+            {
+                // The logs are not freed during the dump, so the numbering is stable
+                length = sprintf(line, "%lu ", (unsigned long)((dataListManager.logList).getFirstSequence() + index));
+            }
+            (dataListManager.logList).get(index)->toString(&(line[length]));
         }
+        length += strlen(&(line[length]));
+        line[length] = '\n';
+        SERIALTX_Commit(length + 1);
+        dumpIndex++;
     }
-    if (buttonE != buttonEPrev)
+
+    char *end = SERIALTX_Reserve(1);
+    if (end != nullptr)
     {
-        if (buttonE == BUTTON_PRESSED)
-        {
-            buttonSinglePressStates |= BUTTON_E_PRESSED_BIT;
-        }
-        else
+        *end = messageEndMarker;
+        SERIALTX_Commit(1);
+        SERIALTX_EndBlock();
+        dumpType = 0;
+    }
+}
+
+/**
+ * @brief Format a line of the access statistics dump.
+ * @param item Item of the dump, the hours of the day and then the slots of the UID table.
+ * @param line Buffer of DUMP_LINE_SIZE characters.
+ * @return True if the line was formatted, false if the item is a free slot.
+ * @note Formats: "H HOUR GRANTS DENIES", "UID GRANTS DENIES FIRST_IN LAST_OUT". The UIDs of the
+ *       auth list are printed in hex, a UID without a match only by its hash as "#HASH". The table
+ *       only holds the UIDs of the auth list, the unknown ones are in the overflow counters. The
+ *       first-in and last-out are minutes of the current day, 65535 if none.
+ */
+bool formatAccessStats(int item, char *line)
+{
+    const AccessStats &stats = dataListManager.getAccessStats();
+    if (item < 24)
+    {
+        sprintf(line, "H %d %u %u", item, stats.getHourGrants(item), stats.getHourDenies(item));
+        return true;
+    }
+
+    const access_stats_entry_t *entry = stats.getEntry(item - 24);
+    if (entry == nullptr)
+    {
+        return false;
+    }
+
+    int length = sprintf(line, "#%08lX", (unsigned long)entry->uidHash);
+    const AuthenticateList *authList = dataListManager.getAuthList();
+    for (int i = 0; i < authList->size(); i++)
+    {
+        const uint8_t *uid = authList->get(i)->getUid();
+        if (AccessStats::hashUid(uid) == entry->uidHash)
         {
-            buttonSinglePressStates |= BUTTON_E_RELEASED_BIT;
+            length = sprintf(line, "%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X",
+                             uid[0], uid[1], uid[2], uid[3], uid[4],
+                             uid[5], uid[6], uid[7], uid[8], uid[9]);
+            break;
         }
     }
+    sprintf(&(line[length]), " %u %u %u %u", entry->grants, entry->denies, entry->firstIn, entry->lastOut);
+    return true;
+}
 
-    button1Prev = button1;
-    button2Prev = button2;
-    button3Prev = button3;
-    buttonEPrev = buttonE;
+/**
+ * @brief Send the buffered serial output.
+ * @note Formats the lines of the dump in progress and passes the buffer to the UART as its FIFO
+ *       has space, without blocking.
+ */
+void taskSerialTransmit(void)
+{
+    if (dumpType != 0)
+    {
+        continueDump();
+    }
+    SERIALTX_Flush();
 }
 
 /**
- * @brief Get the IO button states.
- * @param bitMask The bit mask of the buttons to get the states of.
- * @return The button states.
- * @note The returned states are cleared.
+ * @brief Initialize the IO pins.
  */
-uint32_t ioButtonGetSinglePressStates(uint32_t bitMask)
+void ioPinsInit(void)
 {
-    uint32_t states = buttonSinglePressStates & bitMask;
-    buttonSinglePressStates &= ~bitMask;
-    return states;
+    BUTTON_Init();
+
+    pinMode(LED_1_PIN, OUTPUT);
+    pinMode(LED_2_PIN, OUTPUT);
+    pinMode(LED_3_PIN, OUTPUT);
+
+    digitalWrite(LED_1_PIN, LED_ON);
+    digitalWrite(LED_2_PIN, LED_ON);
+    digitalWrite(LED_3_PIN, LED_ON);
 }
 
 /**
@@ -363,10 +1122,51 @@ uint32_t ioButtonGetSinglePressStates(uint32_t bitMask)
  */
 void revceiveMessage(void)
 {
-    while (Serial.available() > 0)
+    if ((dataListManager.getAuthBatch() != nullptr) &&
+        ((millis() - lastMessageMillis) >= AUTH_BATCH_TIMEOUT_MS))
+    {
+        // The sender is gone, do not keep the half built list
+        dataListManager.abortAuthBatch();
+    }
+
+    if (binaryFrameStarted && ((millis() - binaryFrameMillis) >= BINARY_FRAME_TIMEOUT_MS))
+    {
+        binaryFrameStarted = false;
+    }
+
+    // Stop reading while the queue is full or a binary frame waits, the rest stays in the receive
+    // buffer of the UART, up to SERIAL_RX_BUFFER_SIZE bytes
+    while ((Serial.available() > 0) && !binaryFramePending &&
+           (messageQueue.size() < MESSAGE_QUEUE_SIZE))
     {
         char c = Serial.read();
-        if (!messageStarted)
+        if (c == FRAME_DELIMITER)
+        {
+            // Binary frame: DELIMITER + COBS(PAYLOAD + CRC16) + DELIMITER
+            messageStarted = false;
+            if (binaryFrameStarted && (binaryFrameIndex > 0))
+            {
+                binaryFrameStarted = false;
+                binaryFramePending = true;
+                lastMessageMillis = millis();
+                CAPTURE_SerialFrame(binaryFrame, binaryFrameIndex);
+            }
+            else
+            {
+                binaryFrameStarted = true;
+                binaryFrameIndex = 0;
+                binaryFrameMillis = millis();
+            }
+        }
+        else if (binaryFrameStarted)
+        {
+            if (binaryFrameIndex < FRAME_MAX_ENCODED)
+            {
+                binaryFrame[binaryFrameIndex] = c;
+            }
+            binaryFrameIndex++;
+        }
+        else if (!messageStarted)
         {
             if (c == messageBeginMarker)
             {
@@ -380,17 +1180,40 @@ void revceiveMessage(void)
             {
                 message[messageIndex] = '\0';
                 messageStarted = false;
-                processMessage(message);
+                lastMessageMillis = millis();
+                CAPTURE_SerialMessage(message);
+                serial_message_t received;
+                memcpy(received.text, message, messageIndex + 1);
+                messageQueue.enqueue(&received);
             }
             else
             {
                 message[messageIndex] = c;
                 messageIndex++;
-                if (messageIndex >= 64)
+                if (messageIndex >= MESSAGE_MAX_LENGTH)
                 {
                     messageStarted = false;
                 }
             }
         }
     }
+
+    // The messages are processed in order, and not during a dump, so their replies follow it
+    while (dumpType == 0)
+    {
+        serial_message_t queued;
+        if (messageQueue.dequeue(&queued))
+        {
+            processMessage(queued.text);
+        }
+        else if (binaryFramePending)
+        {
+            binaryFramePending = false;
+            processBinaryMessage(binaryFrame, binaryFrameIndex);
+        }
+        else
+        {
+            break;
+        }
+    }
 }
@@ -0,0 +1,114 @@
+/**
+ ***************************************************************************************************
+ * @file BloomFilter.hpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief A Bloom filter class template for UIDs.
+ ***************************************************************************************************
+ */
+
+#ifndef BLOOMFILTER_HPP
+#define BLOOMFILTER_HPP
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief A Bloom filter for fixed size keys.
+ * @tparam BIT_COUNT The number of bits of the filter, must be a power of 2.
+ * @tparam HASH_COUNT The number of hash functions.
+ * @tparam KEY_SIZE The size of the keys in bytes.
+ * @note The hash functions are derived from two hashes by double hashing (h1 + i * h2). Keys can
+ *       not be removed, rebuild the filter instead.
+ */
+template <int BIT_COUNT, int HASH_COUNT, int KEY_SIZE>
+class BloomFilter
+{
+    static_assert((BIT_COUNT & (BIT_COUNT - 1)) == 0, "BIT_COUNT must be a power of 2");
+
+    uint8_t bits[BIT_COUNT / 8];
+
+public:
+    /**
+     * @brief Construct an empty filter.
+     */
+    BloomFilter()
+    {
+        clear();
+    }
+
+    /**
+     * @brief Remove all keys from the filter.
+     */
+    void clear()
+    {
+        memset(bits, 0, sizeof(bits));
+    }
+
+    /**
+     * @brief Add a key to the filter.
+     * @param key The key to add.
+     */
+    void add(const uint8_t *key)
+    {
+        uint32_t h1;
+        uint32_t h2;
+        hash(key, &h1, &h2);
+
+        for (int i = 0; i < HASH_COUNT; i++)
+        {
+            uint32_t bit = (h1 + i * h2) & (BIT_COUNT - 1);
+            bits[bit >> 3] |= (1 << (bit & 7));
+        }
+    }
+
+    /**
+     * @brief Check if a key may be in the filter.
+     * @param key The key to check.
+     * @return False if the key is surely not in the filter, true if it may be.
+     */
+    bool mayContain(const uint8_t *key) const
+    {
+        uint32_t h1;
+        uint32_t h2;
+        hash(key, &h1, &h2);
+
+        for (int i = 0; i < HASH_COUNT; i++)
+        {
+            uint32_t bit = (h1 + i * h2) & (BIT_COUNT - 1);
+            if (!(bits[bit >> 3] & (1 << (bit & 7))))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    /**
+     * @brief Compute the two base hashes of a key.
+     * @param key The key.
+     * @param h1 First hash (FNV-1a).
+     * @param h2 Second hash (MurmurHash3 finalizer of the first one), always odd.
+     */
+    static void hash(const uint8_t *key, uint32_t *h1, uint32_t *h2)
+    {
+        uint32_t h = 2166136261UL;
+        for (int i = 0; i < KEY_SIZE; i++)
+        {
+            h ^= key[i];
+            h *= 16777619UL;
+        }
+        *h1 = h;
+
+        h ^= h >> 16;
+        h *= 0x85EBCA6BUL;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35UL;
+        h ^= h >> 16;
+        *h2 = h | 1;
+    }
+};
+
+#endif /* BLOOMFILTER_HPP */
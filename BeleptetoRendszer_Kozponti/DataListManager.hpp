@@ -12,27 +12,75 @@
 
 #include <cstdint>
 
+#include "AccessStats.hpp"
 #include "AuthenticateList.hpp"
 #include "LogList.hpp"
 #include "eeprom.h"
+#include "logpack.h"
 #include "realtime.h"
+#include "timesync.h"
 
 /**
  * @brief This class manages the data lists.
+ * @note The authentication list is double buffered. The readers get the published list, which is
+ *       never changed. The changes are made to the other buffer by a batch update, and committing
+ *       the batch publishes it by swapping the two pointers. The readers and the writers run in
+ *       the loop, so the readers never see a half-applied update and no locking is needed.
  */
 class DataListManager
 {
 public:
     /**
-     * @brief List of authentication data.
+     * @brief Size of a log in the legacy format of the readers: UID{10} + TIME{4} + AUTH{1}.
      */
-    AuthenticateList authList;
+    static const uint16_t LEGACY_LOG_SIZE = 15;
+
     /**
      * @brief List of log data.
      */
     LogList logList;
 
 private:
+    /**
+     * @brief Buffers of the authentication list.
+     */
+    AuthenticateList authListBuffers[2];
+
+    /**
+     * @brief The authentication list seen by the readers.
+     */
+    AuthenticateList *publishedAuthList;
+
+    /**
+     * @brief The authentication list built by the batch update.
+     */
+    AuthenticateList *draftAuthList;
+
+    /**
+     * @brief Stores if a batch update is in progress.
+     */
+    bool authBatchActive = false;
+
+    /**
+     * @brief Incremented on every publication of the authentication list.
+     */
+    uint32_t authListVersion = 0;
+
+    /**
+     * @brief Number of users of the EEPROM that did not fit in the list at the initialization.
+     */
+    uint16_t droppedAuthCount = 0;
+
+    /**
+     * @brief Statistics of the accesses, updated by every log added after the initialization.
+     */
+    AccessStats accessStats;
+
+    /**
+     * @brief Buffer of the packed logs and the statistics written to the EEPROM.
+     */
+    uint8_t eepromBuffer[EEPROM_SIZE - EEPROM_SIZE / 2 - AccessStats::STORAGE_SIZE];
+
     typedef struct _eeprom_header
     {
         uint16_t headerSize;
@@ -51,8 +99,16 @@ private:
     const uint16_t LAST_TIME_UPDATE_ADDRESS = 10;
 
     const uint16_t HEADER_SIZE = 14;
+    static_assert(14 + (AUTH_LIST_SIZE - 1) * 30 <= EEPROM_SIZE / 2,
+                  "the records of a full auth list must end before the logs");
     const uint16_t AUTHENTICATE_BASE_ADDRESS;
     const uint16_t LOG_BASE_ADDRESS;
+    const uint16_t ACCESS_STATS_BASE_ADDRESS;
+
+    /**
+     * @brief Size of the packed log area, between the log base and the statistics.
+     */
+    const uint16_t LOG_AREA_SIZE;
 
     eeprom_header_t local_header;
 
@@ -61,8 +117,12 @@ public:
      * @brief Default constructor
      */
     DataListManager(void)
-        : AUTHENTICATE_BASE_ADDRESS(HEADER_SIZE),
-          LOG_BASE_ADDRESS(EEPROM_SIZE / 2)
+        : publishedAuthList(&(authListBuffers[0])),
+          draftAuthList(&(authListBuffers[1])),
+          AUTHENTICATE_BASE_ADDRESS(HEADER_SIZE),
+          LOG_BASE_ADDRESS(EEPROM_SIZE / 2),
+          ACCESS_STATS_BASE_ADDRESS(EEPROM_SIZE - AccessStats::STORAGE_SIZE),
+          LOG_AREA_SIZE(EEPROM_SIZE - EEPROM_SIZE / 2 - AccessStats::STORAGE_SIZE)
     {
     }
 
@@ -99,6 +159,8 @@ public:
             local_header.logBaseAddress = LOG_BASE_ADDRESS;
             local_header.lastTimeUpdate = REALTIME_Get();
 
+            accessStats.setAuthList(publishedAuthList);
+            logList.setStats(&accessStats);
             return;
         }
 
@@ -114,15 +176,26 @@ public:
                                       memory_image[LAST_TIME_UPDATE_ADDRESS + 3];
 
         extractAuthenticateData(memory_image, EEPROM_SIZE, &local_header);
-        extractLogData(memory_image, EEPROM_SIZE, &local_header);
+        if (LOGPACK_Decode(&(memory_image[LOG_BASE_ADDRESS]), LOG_AREA_SIZE, publishedAuthList, &logList) < 0)
+        {
+            // Saved by an older version in the legacy format
+            extractLogData(memory_image, EEPROM_SIZE, &local_header, 0);
+        }
+
+        // The logs of the EEPROM were counted before they were saved
+        accessStats.setAuthList(publishedAuthList);
+        accessStats.deserialize(&(memory_image[ACCESS_STATS_BASE_ADDRESS]));
+        logList.setStats(&accessStats);
     }
 
     /**
      * @brief Extract data from an EEPROM image and update the data lists with it.
      * @param memory_image Memory image of the EEPROM
      * @param size Size of the memory image
+     * @param reader_address Address of the reader that uploaded the image, its clock offset is
+     *                       added to the timestamps of the logs, see TIMESYNC_GetLogOffsetSeconds()
      */
-    void extractListFromEepromImage(const uint8_t *memory_image, uint16_t size)
+    void extractListFromEepromImage(const uint8_t *memory_image, uint16_t size, uint32_t reader_address)
     {
         eeprom_header_t header;
         extractEepromHeader(memory_image, size, &header);
@@ -134,18 +207,154 @@ public:
         }
 
         // extractAuthenticateData(memory_image, size, &header);
-        extractLogData(memory_image, size, &header);
+        extractLogData(memory_image, size, &header, reader_address);
+    }
+
+    /**
+     * @brief Add the logs pushed by a reader to the log list.
+     * @param logs The logs in the legacy format of the readers, LEGACY_LOG_SIZE bytes each
+     * @param count Number of logs
+     * @param time_offset Offset in seconds added to the timestamps of the logs
+     * @return Number of logs stored, the first ones of the push
+     * @note A full list stops the push, the reader sends the rest again, so they are not counted
+     *       by the statistics either.
+     */
+    uint16_t addReaderLogs(const uint8_t *logs, uint16_t count, int32_t time_offset)
+    {
+        uint16_t stored = 0;
+        while ((stored < count) && !logList.isFull() &&
+               addLegacyLog(&(logs[stored * LEGACY_LOG_SIZE]), time_offset))
+        {
+            stored++;
+        }
+        return stored;
     }
 
     /**
      * @brief Update the EEPROM image with the data lists.
      */
     void updateEepromFromList(void)
+    {
+        updateEepromImageFromList();
+        EEPROM_MemoryImage_Commit();
+    }
+
+    /**
+     * @brief Update the EEPROM memory image with the data lists without committing it.
+     * @note The changes are written to the EEPROM by EEPROM_MemoryImage_CommitStep().
+     */
+    void updateEepromImageFromList(void)
     {
         updateEepromHeader();
         updateEepromAuthenticateData();
         updateEepromLogData();
-        EEPROM_MemoryImage_Commit();
+        updateEepromAccessStats();
+    }
+
+    /**
+     * @brief Get the published authentication list.
+     * @return Pointer to the list
+     * @note The list is not changed while it is published, but the pointer is only valid until the
+     *       next commitAuthBatch(), get it again after getAuthListVersion() changed.
+     */
+    const AuthenticateList *getAuthList(void) const
+    {
+        return publishedAuthList;
+    }
+
+    /**
+     * @brief Get the number of users dropped at the initialization.
+     * @return Number of users of the EEPROM that did not fit in the list or the schedule table
+     */
+    uint16_t getDroppedAuthCount(void) const
+    {
+        return droppedAuthCount;
+    }
+
+    /**
+     * @brief Get the version of the published authentication list.
+     * @return Counter that changes on every publication
+     */
+    uint32_t getAuthListVersion(void) const
+    {
+        return authListVersion;
+    }
+
+    /**
+     * @brief Get the statistics of the accesses.
+     * @return Reference to the statistics
+     * @note The statistics are kept when the logs are freed or cleared.
+     */
+    const AccessStats &getAccessStats(void) const
+    {
+        return accessStats;
+    }
+
+    /**
+     * @brief Start a batch update of the authentication list.
+     * @param merge If true, the batch starts from a copy of the published list, otherwise from an
+     *              empty list
+     * @note The changes are made to the list returned by getAuthBatch(), the published list and
+     *       the EEPROM are not changed until commitAuthBatch(). A batch in progress is discarded.
+     */
+    void beginAuthBatch(bool merge)
+    {
+        if (merge)
+        {
+            *draftAuthList = *publishedAuthList;
+        }
+        else
+        {
+            draftAuthList->clear();
+        }
+        authBatchActive = true;
+    }
+
+    /**
+     * @brief Get the list of the batch update in progress.
+     * @return Pointer to the list being built, nullptr if there is no batch update in progress
+     */
+    AuthenticateList *getAuthBatch(void)
+    {
+        return authBatchActive ? draftAuthList : nullptr;
+    }
+
+    /**
+     * @brief Publish the list of the batch update.
+     * @return True if the list was published, false if there was no batch update in progress
+     * @note Only the header and the auth list of the EEPROM memory image are updated at once, the
+     *       changed pages are written by EEPROM_MemoryImage_CommitStep(). The logs and the
+     *       statistics are packed against the new list by the next updateEepromImageFromList(),
+     *       until then the hash of the list in their headers tells that their references are old.
+     */
+    bool commitAuthBatch(void)
+    {
+        if (!authBatchActive)
+        {
+            return false;
+        }
+
+        draftAuthList->refreshUidFilter();
+
+        AuthenticateList *previous = publishedAuthList;
+        publishedAuthList = draftAuthList;
+        draftAuthList = previous;
+        authBatchActive = false;
+        authListVersion++;
+
+        // The entries of the removed UIDs move to the overflow counters
+        accessStats.setAuthList(publishedAuthList);
+        updateEepromHeader();
+        updateEepromAuthenticateData();
+        return true;
+    }
+
+    /**
+     * @brief Discard the batch update in progress.
+     */
+    void abortAuthBatch(void)
+    {
+        authBatchActive = false;
     }
 
 private:
@@ -216,48 +425,70 @@ private:
             interval_start = (begin_hour * 60 + begin_minute) * 60;
             interval_end = (end_hour * 60 + end_minute) * 60;
 
-            if (authList.findByUid(uid) == -1)
+            // Called before the list is read by anyone, so it is filled in place
+            if ((publishedAuthList->findByUid(uid) == -1) &&
+                !publishedAuthList->add(uid, name, interval_start, interval_end))
             {
-                authList.add(uid, name, interval_start, interval_end);
+                droppedAuthCount++;
             }
         }
     }
 
-    void extractLogData(const uint8_t *memory_image, uint16_t size, const eeprom_header_t *header)
+    /**
+     * @brief Extract the logs in the legacy format, as saved by the readers.
+     * @param reader_address Address of the reader that uploaded the image, 0 for the own image,
+     *                       whose logs are on the clock of the central
+     */
+    void extractLogData(const uint8_t *memory_image, uint16_t size, const eeprom_header_t *header, uint32_t reader_address)
     {
-        uint16_t address = header->logBaseAddress;
-
-        // Format: UID{10} + TIME{4} + AUTH{1} = 15
-        uint8_t log_data[15];
-        uint8_t uid[10];
-        uint32_t time;
-        uint8_t auth;
-
+        uint32_t newest_time = 0;
         for (uint16_t address = header->logBaseAddress;
              address < header->logBaseAddress + header->logLength;
-             address += 15)
+             address += LEGACY_LOG_SIZE)
         {
-            for (uint16_t j = 0; j < 15; j++)
+            const uint8_t *log_data = &(memory_image[address]);
+            uint32_t time = ((uint32_t)(log_data[10]) << 24) | ((uint32_t)(log_data[11]) << 16) |
+                            ((uint32_t)(log_data[12]) << 8) | log_data[13];
+            int32_t time_offset = (reader_address == 0) ? 0 : TIMESYNC_GetLogOffsetSeconds(reader_address, time);
+            addLegacyLog(log_data, time_offset);
+            if (time > newest_time)
             {
-                log_data[j] = memory_image[address + j];
+                newest_time = time;
             }
+        }
 
-            for (uint16_t j = 0; j < 10; j++)
-            {
-                uid[j] = log_data[j];
-            }
-            time = (log_data[10] << 24) | (log_data[11] << 16) | (log_data[12] << 8) | log_data[13];
-            auth = log_data[14];
+        if (reader_address != 0)
+        {
+            TIMESYNC_LogsTaken(reader_address, newest_time);
+        }
+    }
+
+    /**
+     * @brief Add a log in the legacy format to the log list.
+     * @param log_data The log, UID{10} + TIME{4} + AUTH{1}
+     * @param time_offset Offset in seconds added to the timestamp of the log
+     * @return True if added, false if the log list is full
+     */
+    bool addLegacyLog(const uint8_t *log_data, int32_t time_offset)
+    {
+        uint32_t time = ((uint32_t)(log_data[10]) << 24) | ((uint32_t)(log_data[11]) << 16) |
+                        ((uint32_t)(log_data[12]) << 8) | log_data[13];
 
-            logList.add(uid, time, auth);
+        if (time != 0)
+        {
+            // A zero timestamp means the clock of the logging module was not set
+            time += time_offset;
         }
+
+        return logList.add(log_data, time, log_data[14]);
     }
 
     void updateEepromHeader(void)
     {
         // local_header.lastTimeUpdate = REALTIME_Get();
-        local_header.authenticateLength = authList.size() * 30;
-        local_header.logLength = logList.size() * 14;
+        local_header.authenticateLength = publishedAuthList->size() * 30;
+        // The logs are packed, the old parsers of the image see no legacy records
+        local_header.logLength = 0;
 
         uint8_t buffer[4];
         uint16_t address = HEADER_SIZE_ADDRESS;
@@ -296,17 +527,19 @@ private:
 
     void updateEepromAuthenticateData(void)
     {
-        for (int i = 0; i < authList.size(); i++)
+        const AuthenticateList *authList = publishedAuthList;
+        for (int i = 0; i < authList->size(); i++)
         {
             uint16_t address = local_header.authenticateBaseAddress + (i * 30);
 
-            uint8_t begin_hour = authList.get(i)->getIntervalStart() % (60 * 60 * 24) / (60 * 60);
-            uint8_t begin_minute = authList.get(i)->getIntervalStart() % (60 * 60) / 60;
-            uint8_t end_hour = authList.get(i)->getIntervalEnd() % (60 * 60 * 24) / (60 * 60);
-            uint8_t end_minute = authList.get(i)->getIntervalEnd() % (60 * 60) / 60;
+            // The readers parse the records, so the interval is saved in every record
+            uint8_t begin_hour = authList->getIntervalStart(i) % (60 * 60 * 24) / (60 * 60);
+            uint8_t begin_minute = authList->getIntervalStart(i) % (60 * 60) / 60;
+            uint8_t end_hour = authList->getIntervalEnd(i) % (60 * 60 * 24) / (60 * 60);
+            uint8_t end_minute = authList->getIntervalEnd(i) % (60 * 60) / 60;
 
-            EEPROM_Write(address, authList.get(i)->getUid(), 10);
-            EEPROM_Write(address + 10, (const uint8_t *)(authList.get(i)->getName()), 16);
+            EEPROM_Write(address, authList->get(i)->getUid(), 10);
+            EEPROM_Write(address + 10, (const uint8_t *)(authList->get(i)->getName()), 16);
             EEPROM_Write(address + 26, &begin_hour, 1);
             EEPROM_Write(address + 27, &begin_minute, 1);
             EEPROM_Write(address + 28, &end_hour, 1);
@@ -316,20 +549,15 @@ private:
 
     void updateEepromLogData(void)
     {
-        uint16_t address = local_header.logBaseAddress;
-        for (int i = 0; i < logList.size(); i++, address += 15)
-        {
-            uint32_t timestamp = logList.get(i)->getTimestamp();
-            uint8_t buffer[4];
-            buffer[0] = timestamp >> 24;
-            buffer[1] = (timestamp >> 16) & 0xFF;
-            buffer[2] = (timestamp >> 8) & 0xFF;
-            buffer[3] = timestamp & 0xFF;
-            uint8_t auth = logList.get(i)->getAuthentication();
-
-            EEPROM_Write(address, logList.get(i)->getUid(), 10);
-            EEPROM_Write(address + 10, buffer, 4);
-            EEPROM_Write(address + 14, &auth, 1);
-        }
+        // The oldest logs are saved if not all of them fit, they are waiting the longest for the export
+        uint16_t log_count;
+        uint16_t length = LOGPACK_Encode(&logList, publishedAuthList, eepromBuffer, LOG_AREA_SIZE, &log_count);
+        EEPROM_Write(local_header.logBaseAddress, eepromBuffer, length);
+    }
+
+    void updateEepromAccessStats(void)
+    {
+        accessStats.serialize(eepromBuffer);
+        EEPROM_Write(ACCESS_STATS_BASE_ADDRESS, eepromBuffer, AccessStats::STORAGE_SIZE);
     }
 }; // DataListManager
@@ -0,0 +1,71 @@
+/**
+ ***************************************************************************************************
+ * @file EepromStorageBackend.hpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief This file contains the definition of the EepromStorageBackend class.
+ ***************************************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "EEPROM_24LC64.h"
+#include "StorageBackend.hpp"
+
+/**
+ * @brief A memory in an I2C EEPROM of the 24LC family.
+ * @note The EEPROM_24LC64 driver works with the larger parts of the family too, as long as their
+ *       pages are at least EEPROM_24LC64_PAGE_SIZE bytes.
+ */
+class EepromStorageBackend : public StorageBackend
+{
+private:
+    EEPROM_24LC64 &device;
+    uint32_t size;
+
+public:
+    /**
+     * @brief Constructor
+     * @param device The EEPROM.
+     * @param size Size of the EEPROM in bytes.
+     */
+    EepromStorageBackend(EEPROM_24LC64 &device, uint32_t size)
+        : device(device), size(size)
+    {
+    }
+
+    uint32_t getSize(void) const override
+    {
+        return size;
+    }
+
+    uint16_t getPageSize(void) const override
+    {
+        return EEPROM_24LC64_PAGE_SIZE;
+    }
+
+    uint16_t getWriteDelayMs(void) const override
+    {
+        return EEPROM_24LC64_WRITE_DELAY_MS;
+    }
+
+    uint16_t read(uint32_t address, uint8_t *data, uint16_t length) override
+    {
+        return device.readMultiBytes(address, data, length);
+    }
+
+    void write(uint32_t address, const uint8_t *data, uint16_t length) override
+    {
+        if (length == 1)
+        {
+            device.writeByte(address, data[0]);
+        }
+        else
+        {
+            device.writePage(address, (uint8_t *)data, length);
+        }
+    }
+}; // EepromStorageBackend
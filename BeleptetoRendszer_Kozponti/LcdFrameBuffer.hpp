@@ -0,0 +1,174 @@
+/**
+ ***************************************************************************************************
+ * @file LcdFrameBuffer.hpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief This file contains the definition of the LcdFrameBuffer class.
+ ***************************************************************************************************
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string.h>
+#include <LCD_I2C.h>
+
+/**
+ * @brief Number of columns of the LCD.
+ */
+#define LCD_COLUMNS 16
+
+/**
+ * @brief Number of rows of the LCD.
+ */
+#define LCD_ROWS 2
+
+/**
+ * @brief Runs of changed characters separated by at most this many unchanged ones are sent
+ *        together, because repositioning the cursor costs as much as sending a character.
+ */
+#define LCD_MAX_UNCHANGED_GAP 1
+
+/**
+ * @brief Shadow framebuffer of the LCD.
+ * @note The content is drawn into the frame, and flush() sends only the characters that differ
+ *       from what is on the LCD. The LCD is never cleared, so redrawing does not flicker.
+ */
+class LcdFrameBuffer
+{
+private:
+    /**
+     * @brief Content drawn since the last flush.
+     */
+    char frame[LCD_ROWS][LCD_COLUMNS];
+
+    /**
+     * @brief Content of the LCD.
+     */
+    char shadow[LCD_ROWS][LCD_COLUMNS];
+
+    uint8_t cursorColumn = 0;
+    uint8_t cursorRow = 0;
+
+public:
+    /**
+     * @brief Default constructor
+     * @note The LCD is assumed to be blank, as it is after LCD_I2C::begin().
+     */
+    LcdFrameBuffer(void)
+    {
+        clear();
+        invalidate();
+    }
+
+    /**
+     * @brief Fill the frame with spaces and move the cursor to the top left corner.
+     */
+    void clear(void)
+    {
+        memset(frame, ' ', sizeof(frame));
+        cursorColumn = 0;
+        cursorRow = 0;
+    }
+
+    /**
+     * @brief Set the position of the next print.
+     * @param column Column, 0 is the leftmost
+     * @param row Row, 0 is the top
+     */
+    void setCursor(uint8_t column, uint8_t row)
+    {
+        cursorColumn = column;
+        cursorRow = row;
+    }
+
+    /**
+     * @brief Print a string at the cursor.
+     * @param str String to print
+     * @note The text is cut at the end of the row.
+     */
+    void print(const char *str)
+    {
+        if (cursorRow >= LCD_ROWS)
+        {
+            return;
+        }
+
+        while ((*str != '\0') && (cursorColumn < LCD_COLUMNS))
+        {
+            frame[cursorRow][cursorColumn] = *str;
+            cursorColumn++;
+            str++;
+        }
+    }
+
+    /**
+     * @brief Check if the frame differs from the content of the LCD.
+     * @return True if a flush would send anything, false otherwise
+     */
+    bool isDirty(void) const
+    {
+        return (memcmp(frame, shadow, sizeof(frame)) != 0);
+    }
+
+    /**
+     * @brief Forget the content of the LCD, so the next flush redraws everything.
+     * @note Call it if the LCD was cleared or reinitialized directly.
+     */
+    void invalidate(void)
+    {
+        memset(shadow, ' ', sizeof(shadow));
+    }
+
+    /**
+     * @brief Send the changed characters of the frame to the LCD.
+     * @param lcd LCD display
+     * @return Number of characters sent
+     */
+    int flush(LCD_I2C *lcd)
+    {
+        int sent = 0;
+
+        for (uint8_t row = 0; row < LCD_ROWS; row++)
+        {
+            uint8_t column = 0;
+            while (column < LCD_COLUMNS)
+            {
+                if (frame[row][column] == shadow[row][column])
+                {
+                    column++;
+                    continue;
+                }
+
+                // Extend the run over short unchanged gaps
+                uint8_t runStart = column;
+                uint8_t runEnd = column + 1;
+                uint8_t gap = 0;
+                for (uint8_t i = runEnd; (i < LCD_COLUMNS) && (gap <= LCD_MAX_UNCHANGED_GAP); i++)
+                {
+                    if (frame[row][i] != shadow[row][i])
+                    {
+                        runEnd = i + 1;
+                        gap = 0;
+                    }
+                    else
+                    {
+                        gap++;
+                    }
+                }
+
+                lcd->setCursor(runStart, row);
+                for (uint8_t i = runStart; i < runEnd; i++)
+                {
+                    lcd->write(frame[row][i]);
+                    shadow[row][i] = frame[row][i];
+                    sent++;
+                }
+                column = runEnd;
+            }
+        }
+
+        return sent;
+    }
+}; // LcdFrameBuffer
@@ -15,10 +15,11 @@
 class LogData
 {
 private:
-    const int uidSize = 10;
+    static const int uidSize = 10;
 
-    uint8_t uid[10];
+    // Ordered by alignment, a log takes 16 bytes
     uint32_t timestamp;
+    uint8_t uid[10];
     uint8_t auth;
 
 public:
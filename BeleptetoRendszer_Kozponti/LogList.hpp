@@ -11,43 +11,126 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 
 #include "LogData.hpp"
 #include "CircularBuffer.hpp"
+#include "AccessStats.hpp"
 
 /**
- * @brief Maximum size of the log list
+ * @brief Maximum size of the log list, it holds LOG_LIST_MAX_SIZE - 1 logs.
+ * @note A log costs 22 bytes of RAM with the indices and the query results, the list takes the
+ *       same 8 KB as the 273 logs of 30 bytes did. The packed EEPROM area holds 400-1000 logs of
+ *       the usual traffic, so the whole list is saved, the legacy records would fit only 201.
  */
-#define LOG_LIST_MAX_SIZE 273
+#define LOG_LIST_MAX_SIZE 372
+
+/**
+ * @brief Number of hash buckets of the UID index of the log list, must be a power of 2.
+ */
+#define LOG_LIST_UID_BUCKETS 32
+
+/**
+ * @brief Marks the end of a chain of the UID index.
+ */
+#define LOG_LIST_NO_SLOT 0xFFFF
+
+/**
+ * @brief Filter of a log query.
+ */
+typedef struct _log_query
+{
+    uint32_t from;      /**< Start of the time range, inclusive */
+    uint32_t to;        /**< End of the time range, inclusive */
+    const uint8_t *uid; /**< UID of the logs, nullptr for any */
+    int auth;           /**< Authentication state of the logs, -1 for any */
+} log_query_t;
 
 /**
  * @brief This class represents a list of logs.
+ * @note The logs are kept in arrival order, which is not the time order, as the readers upload
+ *       their logs in batches. Two indices are maintained for the queries, both refer to the logs
+ *       by slot: the slot of the log with the sequence number seq is seq % LOG_LIST_MAX_SIZE, it
+ *       does not change while the log is in the list.
+ *       - The time index holds the slots ordered by timestamp, for binary search by time.
+ *       - The UID index chains the logs of each UID hash bucket from the newest to the oldest.
+ *         The chains are not updated when the logs are freed, a link that does not lead to an
+ *         older log ends the chain.
  */
 class LogList
 {
 private:
     CircularBuffer<LogData, LOG_LIST_MAX_SIZE> logList;
 
+    /**
+     * @brief Sequence number of the first log in the list.
+     * @note The log at index i has the sequence number first_seq + i. The numbers are not reused
+     *       while the program runs, freed logs just move the first one forward.
+     */
+    uint32_t first_seq = 0;
+
+    /**
+     * @brief Slots of the logs ordered by timestamp, then by sequence number.
+     */
+    uint16_t time_index[LOG_LIST_MAX_SIZE];
+
+    /**
+     * @brief Slot of the newest log of each UID hash bucket.
+     */
+    uint16_t uid_head[LOG_LIST_UID_BUCKETS];
+
+    /**
+     * @brief Slot of the previous log of the same UID hash bucket, indexed by slot.
+     */
+    uint16_t uid_next[LOG_LIST_MAX_SIZE];
+
+    /**
+     * @brief Statistics updated by every added log, nullptr if none.
+     * @note Not owned by the list, and not changed when logs are freed or the list is cleared.
+     */
+    AccessStats *stats = nullptr;
+
 public:
+    /**
+     * @brief Default constructor
+     */
+    LogList(void)
+    {
+        memset(uid_head, 0xFF, sizeof(uid_head));
+    }
+
     /**
      * @brief Add a new log to the list.
      * @param uid UID of an RFID tag
      * @param timestamp Timestamp of the log
      * @param auth Authentication state
+     * @return True if added, false if the list is full
      */
-    void add(const uint8_t *uid, uint32_t timestamp, uint8_t auth)
+    bool add(const uint8_t *uid, uint32_t timestamp, uint8_t auth)
     {
         LogData logData(uid, timestamp, auth);
-        logList.enqueue(&logData);
+        return add(&logData);
     }
 
     /**
      * @brief Add a new log to the list.
      * @param logData LogData object
+     * @return True if added, false if the list is full
      */
-    void add(const LogData *logData)
+    bool add(const LogData *logData)
     {
-        logList.enqueue(logData);
+        if (stats != nullptr)
+        {
+            // Counted even if the list is full, the statistics are about the accesses
+            stats->add(logData->getUid(), logData->getTimestamp(), logData->getAuthentication());
+        }
+
+        if (!logList.enqueue(logData))
+        {
+            return false;
+        }
+        addToIndex(logList.size() - 1);
+        return true;
     }
 
     /**
@@ -55,8 +138,9 @@ public:
      * @param uid UID of an RFID tag
      * @param timestamp Timestamp of the log
      * @param auth Authentication state
+     * @return True if added, false if the list is full
      */
-    void add(const char *uid, uint32_t timestamp, uint8_t auth)
+    bool add(const char *uid, uint32_t timestamp, uint8_t auth)
     {
         uint8_t uid_bytes[10];
         sscanf(uid, "%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx",
@@ -64,7 +148,7 @@ public:
                &uid_bytes[4], &uid_bytes[5], &uid_bytes[6], &uid_bytes[7],
                &uid_bytes[8], &uid_bytes[9]);
 
-        add(uid_bytes, timestamp, auth);
+        return add(uid_bytes, timestamp, auth);
     }
 
     /**
@@ -96,6 +180,15 @@ public:
         return logList.size();
     }
 
+    /**
+     * @brief Check if the list is full.
+     * @return True if no more log can be added
+     */
+    bool isFull(void) const
+    {
+        return logList.size() >= LOG_LIST_MAX_SIZE - 1;
+    }
+
     /**
      * @brief Find a log by UID.
      * @param uid UID of an RFID tag
@@ -124,13 +217,68 @@ public:
         return -1;
     }
 
+    /**
+     * @brief Get the sequence number of the first log in the list.
+     * @return Sequence number of the first log
+     */
+    uint32_t getFirstSequence(void) const
+    {
+        return first_seq;
+    }
+
+    /**
+     * @brief Get the sequence number the next added log will get.
+     * @return Sequence number after the last log
+     */
+    uint32_t getNextSequence(void) const
+    {
+        return first_seq + logList.size();
+    }
+
+    /**
+     * @brief Get the index of the log with the given sequence number.
+     * @param seq Sequence number
+     * @return Index of the log, -1 if it was freed or not yet added
+     */
+    int findBySequence(uint32_t seq) const
+    {
+        if ((seq < first_seq) || (seq >= getNextSequence()))
+        {
+            return -1;
+        }
+        return seq - first_seq;
+    }
+
+    /**
+     * @brief Free the logs up to the given sequence number.
+     * @param seq Sequence number of the last log to free
+     * @return Number of freed logs
+     */
+    int acknowledge(uint32_t seq)
+    {
+        int freed = 0;
+        LogData logData;
+        while ((first_seq <= seq) && logList.dequeue(&logData))
+        {
+            first_seq++;
+            freed++;
+        }
+        if (freed > 0)
+        {
+            removeFreedFromTimeIndex(logList.size() + freed);
+        }
+        return freed;
+    }
+
     /**
      * @brief Remove a log from the list.
      * @param index Index of the log
+     * @note The sequence numbers of the logs after the removed one change.
      */
     void remove(int index)
     {
         logList.remove(index);
+        rebuildIndex();
     }
 
     /**
@@ -153,7 +301,7 @@ public:
             }
             if (match)
             {
-                logList.remove(i);
+                remove(i);
                 break;
             }
         }
@@ -182,7 +330,225 @@ public:
         LogData logData;
         while (logList.dequeue(&logData))
         {
-            // Do nothing
+            first_seq++;
+        }
+        memset(uid_head, 0xFF, sizeof(uid_head));
+    }
+
+    /**
+     * @brief Set the statistics updated by every added log.
+     * @param access_stats Pointer to the statistics, nullptr to stop updating them
+     */
+    void setStats(AccessStats *access_stats)
+    {
+        stats = access_stats;
+    }
+
+    /**
+     * @brief Find the logs matching a query.
+     * @param query Filter of the query
+     * @param results Indices of the matching logs in time order
+     * @param max_results Size of results
+     * @return Number of matching logs, at most max_results
+     * @note With a UID the chain of its bucket is walked, otherwise the time range is found by
+     *       binary search, so only the candidate logs are read.
+     */
+    int query(const log_query_t *query, uint16_t *results, int max_results) const
+    {
+        int count = 0;
+
+        if (query->uid != nullptr)
+        {
+            // Newest to oldest, reversed below
+            int previous = logList.size();
+            uint16_t slot = uid_head[bucketOf(query->uid)];
+            while ((slot != LOG_LIST_NO_SLOT) && (count < max_results))
+            {
+                int index = indexOfSlot(slot);
+                if (index >= previous)
+                {
+                    // Freed log, or its slot was reused by a newer one
+                    break;
+                }
+                if (matches(query, logList[index]) &&
+                    (memcmp(logList[index]->getUid(), query->uid, logList[index]->getUidSize()) == 0))
+                {
+                    results[count++] = index;
+                }
+                previous = index;
+                slot = uid_next[slot];
+            }
+
+            // The logs of a UID are few, insertion sort by time
+            for (int i = 1; i < count; i++)
+            {
+                uint16_t result = results[i];
+                int j = i - 1;
+                while ((j >= 0) && isLater(results[j], result))
+                {
+                    results[j + 1] = results[j];
+                    j--;
+                }
+                results[j + 1] = result;
+            }
+        }
+        else
+        {
+            for (int position = lowerBound(query->from);
+                 (position < logList.size()) && (count < max_results);
+                 position++)
+            {
+                int index = indexOfSlot(time_index[position]);
+                if (logList[index]->getTimestamp() > query->to)
+                {
+                    break;
+                }
+                if (matches(query, logList[index]))
+                {
+                    results[count++] = index;
+                }
+            }
+        }
+
+        return count;
+    }
+
+private:
+    /**
+     * @brief Get the slot of a log.
+     * @param index Index of the log
+     * @return Slot of the log
+     */
+    uint16_t slotOf(int index) const
+    {
+        return (first_seq + index) % LOG_LIST_MAX_SIZE;
+    }
+
+    /**
+     * @brief Get the index of the log in a slot.
+     * @param slot Slot
+     * @return Index of the log, not less than size() if the slot is free
+     */
+    int indexOfSlot(uint16_t slot) const
+    {
+        return (slot + LOG_LIST_MAX_SIZE - (first_seq % LOG_LIST_MAX_SIZE)) % LOG_LIST_MAX_SIZE;
+    }
+
+    /**
+     * @brief Get the UID hash bucket of a UID.
+     * @param uid UID of an RFID tag
+     * @return Bucket
+     */
+    static uint8_t bucketOf(const uint8_t *uid)
+    {
+        uint32_t hash = 2166136261UL;
+        for (int i = 0; i < 10; i++)
+        {
+            hash ^= uid[i];
+            hash *= 16777619UL;
+        }
+        return (hash ^ (hash >> 16)) & (LOG_LIST_UID_BUCKETS - 1);
+    }
+
+    /**
+     * @brief Check if a log matches the time range and the authentication state of a query.
+     * @param query Filter of the query
+     * @param logData The log
+     * @return True if the log matches, false otherwise
+     */
+    static bool matches(const log_query_t *query, const LogData *logData)
+    {
+        return (logData->getTimestamp() >= query->from) && (logData->getTimestamp() <= query->to) &&
+               ((query->auth < 0) || (logData->getAuthentication() == query->auth));
+    }
+
+    /**
+     * @brief Check if a log comes after another one in time order.
+     * @param a Index of the first log
+     * @param b Index of the second log
+     * @return True if a is later than b, false otherwise
+     */
+    bool isLater(int a, int b) const
+    {
+        uint32_t time_a = logList[a]->getTimestamp();
+        uint32_t time_b = logList[b]->getTimestamp();
+        return (time_a > time_b) || ((time_a == time_b) && (a > b));
+    }
+
+    /**
+     * @brief Find the first position of the time index with a timestamp not before the given one.
+     * @param timestamp Timestamp
+     * @return Position in the time index, size() if there is no such log
+     */
+    int lowerBound(uint32_t timestamp) const
+    {
+        int low = 0;
+        int high = logList.size();
+        while (low < high)
+        {
+            int middle = (low + high) / 2;
+            if (logList[indexOfSlot(time_index[middle])]->getTimestamp() < timestamp)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    /**
+     * @brief Add the log at the given index to the indices.
+     * @param index Index of the log
+     * @note The index must be the last one, i.e. the log was just added.
+     */
+    void addToIndex(int index)
+    {
+        uint16_t slot = slotOf(index);
+        const LogData *logData = logList[index];
+
+        // The logs mostly arrive in time order, so the position is near the end
+        int position = index;
+        while ((position > 0) &&
+               (logList[indexOfSlot(time_index[position - 1])]->getTimestamp() > logData->getTimestamp()))
+        {
+            position--;
+        }
+        memmove(&(time_index[position + 1]), &(time_index[position]), (index - position) * sizeof(uint16_t));
+        time_index[position] = slot;
+
+        uint8_t bucket = bucketOf(logData->getUid());
+        uid_next[slot] = uid_head[bucket];
+        uid_head[bucket] = slot;
+    }
+
+    /**
+     * @brief Remove the freed logs from the time index.
+     * @param old_size Size of the list before the logs were freed
+     */
+    void removeFreedFromTimeIndex(int old_size)
+    {
+        int kept = 0;
+        for (int position = 0; position < old_size; position++)
+        {
+            if (indexOfSlot(time_index[position]) < logList.size())
+            {
+                time_index[kept++] = time_index[position];
+            }
+        }
+    }
+
+    /**
+     * @brief Rebuild the indices from the list.
+     */
+    void rebuildIndex(void)
+    {
+        memset(uid_head, 0xFF, sizeof(uid_head));
+        for (int i = 0; i < logList.size(); i++)
+        {
+            addToIndex(i);
         }
     }
 }; // LogList
@@ -0,0 +1,182 @@
+/**
+ ***************************************************************************************************
+ * @file ScheduleTable.hpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief This file contains the definition of the ScheduleTable class.
+ ***************************************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Number of distinct authentication intervals.
+ */
+#define SCHEDULE_TABLE_SIZE 32
+
+/**
+ * @brief Table of the authentication intervals shared by the users.
+ * @note The users refer to an interval by its 1 byte ID. Adding an interval returns the ID of the
+ *       equal one if there is any, and the intervals are reference counted, so a slot is reused
+ *       when its last user is removed.
+ */
+class ScheduleTable
+{
+private:
+    uint32_t interval_start[SCHEDULE_TABLE_SIZE];
+    uint32_t interval_end[SCHEDULE_TABLE_SIZE];
+
+    /**
+     * @brief Number of users of each interval, 0 if the slot is free.
+     */
+    uint8_t users[SCHEDULE_TABLE_SIZE];
+
+public:
+    /**
+     * @brief Default constructor
+     */
+    ScheduleTable(void)
+    {
+        clear();
+    }
+
+    /**
+     * @brief Remove all intervals.
+     */
+    void clear(void)
+    {
+        memset(users, 0, sizeof(users));
+    }
+
+    /**
+     * @brief Get the ID of an interval and add a user to it.
+     * @param start Start of the interval
+     * @param end End of the interval
+     * @return ID of the interval, -1 if it is new and the table is full
+     */
+    int intern(uint32_t start, uint32_t end)
+    {
+        int free_slot = -1;
+        for (int i = 0; i < SCHEDULE_TABLE_SIZE; i++)
+        {
+            if (users[i] == 0)
+            {
+                if (free_slot == -1)
+                {
+                    free_slot = i;
+                }
+            }
+            else if ((interval_start[i] == start) && (interval_end[i] == end))
+            {
+                users[i]++;
+                return i;
+            }
+        }
+
+        if (free_slot != -1)
+        {
+            interval_start[free_slot] = start;
+            interval_end[free_slot] = end;
+            users[free_slot] = 1;
+        }
+        return free_slot;
+    }
+
+    /**
+     * @brief Remove a user from an interval.
+     * @param id ID of the interval
+     */
+    void release(uint8_t id)
+    {
+        if ((id < SCHEDULE_TABLE_SIZE) && (users[id] > 0))
+        {
+            users[id]--;
+        }
+    }
+
+    /**
+     * @brief Find an interval.
+     * @param start Start of the interval
+     * @param end End of the interval
+     * @return ID of the interval, -1 if not found
+     */
+    int find(uint32_t start, uint32_t end) const
+    {
+        for (int i = 0; i < SCHEDULE_TABLE_SIZE; i++)
+        {
+            if ((users[i] != 0) && (interval_start[i] == start) && (interval_end[i] == end))
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Move the users of an interval to another one, the first slot is freed.
+     * @param from ID of the interval whose users move
+     * @param into ID of the interval they move to
+     * @note The users must be remapped by the caller.
+     */
+    void merge(uint8_t from, uint8_t into)
+    {
+        if ((from < SCHEDULE_TABLE_SIZE) && (into < SCHEDULE_TABLE_SIZE) && (from != into))
+        {
+            users[into] += users[from];
+            users[from] = 0;
+        }
+    }
+
+    /**
+     * @brief Change an interval for all of its users.
+     * @param id ID of the interval
+     * @param start Start of the interval
+     * @param end End of the interval
+     * @return True if changed, false if the ID is not in use
+     * @note The new interval must not be in the table yet, see find() and merge().
+     */
+    bool set(uint8_t id, uint32_t start, uint32_t end)
+    {
+        if (getUsers(id) == 0)
+        {
+            return false;
+        }
+        interval_start[id] = start;
+        interval_end[id] = end;
+        return true;
+    }
+
+    /**
+     * @brief Get the start of an interval.
+     * @param id ID of the interval
+     * @return Start of the interval
+     */
+    uint32_t getStart(uint8_t id) const
+    {
+        return (id < SCHEDULE_TABLE_SIZE) ? interval_start[id] : 0;
+    }
+
+    /**
+     * @brief Get the end of an interval.
+     * @param id ID of the interval
+     * @return End of the interval
+     */
+    uint32_t getEnd(uint8_t id) const
+    {
+        return (id < SCHEDULE_TABLE_SIZE) ? interval_end[id] : 0;
+    }
+
+    /**
+     * @brief Get the number of users of an interval.
+     * @param id ID of the interval
+     * @return Number of users, 0 if the ID is not in use
+     */
+    uint8_t getUsers(uint8_t id) const
+    {
+        return (id < SCHEDULE_TABLE_SIZE) ? users[id] : 0;
+    }
+}; // ScheduleTable
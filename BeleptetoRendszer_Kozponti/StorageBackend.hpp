@@ -0,0 +1,123 @@
+/**
+ ***************************************************************************************************
+ * @file StorageBackend.hpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief This file contains the definition of the StorageBackend interface and its RAM-only
+ *        implementation.
+ ***************************************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief A non-volatile memory under the EEPROM memory image and the user store.
+ * @note Writes must not cross a page boundary of the memory. After a write the memory may be busy
+ *       for getWriteDelayMs() milliseconds, the callers wait before the next access.
+ */
+class StorageBackend
+{
+public:
+    virtual ~StorageBackend(void) {}
+
+    /**
+     * @brief Get the size of the memory.
+     * @return Size in bytes.
+     */
+    virtual uint32_t getSize(void) const = 0;
+
+    /**
+     * @brief Get the size of a page of the memory.
+     * @return Size of a page in bytes.
+     */
+    virtual uint16_t getPageSize(void) const = 0;
+
+    /**
+     * @brief Get the duration of the write cycle of the memory.
+     * @return Time in milliseconds the memory is busy after a write.
+     */
+    virtual uint16_t getWriteDelayMs(void) const = 0;
+
+    /**
+     * @brief Read data from the memory.
+     * @param address The address to read from.
+     * @param data The data read.
+     * @param length The length of the data.
+     * @return The number of bytes read.
+     */
+    virtual uint16_t read(uint32_t address, uint8_t *data, uint16_t length) = 0;
+
+    /**
+     * @brief Write data into a page of the memory.
+     * @param address The address to write to.
+     * @param data The data to write.
+     * @param length The length of the data, the data must not cross a page boundary.
+     */
+    virtual void write(uint32_t address, const uint8_t *data, uint16_t length) = 0;
+}; // StorageBackend
+
+/**
+ * @brief A memory in RAM, for running the persistence without an EEPROM.
+ * @note The content is lost at reset. A new memory reads as an erased EEPROM, all 0xFF.
+ */
+class RamStorageBackend : public StorageBackend
+{
+private:
+    uint8_t *memory;
+    uint32_t size;
+    uint16_t page_size;
+    uint16_t write_delay_ms;
+
+public:
+    /**
+     * @brief Constructor
+     * @param memory Buffer of the memory, must be at least size bytes.
+     * @param size Size of the memory in bytes.
+     * @param page_size Size of a page in bytes.
+     * @param write_delay_ms Simulated duration of the write cycle, 0 for none.
+     */
+    RamStorageBackend(uint8_t *memory, uint32_t size, uint16_t page_size, uint16_t write_delay_ms = 0)
+        : memory(memory), size(size), page_size(page_size), write_delay_ms(write_delay_ms)
+    {
+        memset(memory, 0xFF, size);
+    }
+
+    uint32_t getSize(void) const override
+    {
+        return size;
+    }
+
+    uint16_t getPageSize(void) const override
+    {
+        return page_size;
+    }
+
+    uint16_t getWriteDelayMs(void) const override
+    {
+        return write_delay_ms;
+    }
+
+    uint16_t read(uint32_t address, uint8_t *data, uint16_t length) override
+    {
+        if (address + length > size)
+        {
+            return 0;
+        }
+        memcpy(data, &(memory[address]), length);
+        return length;
+    }
+
+    void write(uint32_t address, const uint8_t *data, uint16_t length) override
+    {
+        if ((length == 0) || (address + length > size) ||
+            (address / page_size != (address + length - 1) / page_size))
+        {
+            return;
+        }
+        memcpy(&(memory[address]), data, length);
+    }
+}; // RamStorageBackend
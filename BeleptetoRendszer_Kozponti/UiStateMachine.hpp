@@ -15,7 +15,8 @@
 #include <string>
 #include <LCD_I2C.h>
 
-#include "AuthenticateList.hpp"
+#include "DataListManager.hpp"
+#include "LcdFrameBuffer.hpp"
 #include "realtime.h"
 
 /**
@@ -33,7 +34,9 @@ public:
         ENTER, /**< Enter button was pressed */
         BACK,  /**< Back button was pressed */
         LEFT,  /**< Left button was pressed */
-        RIGHT  /**< Right button was pressed */
+        RIGHT, /**< Right button was pressed */
+        LEFT_HOLD, /**< Left button is held, repeated while held */
+        RIGHT_HOLD /**< Right button is held, repeated while held */
     };
 
 private:
@@ -41,8 +44,10 @@ private:
     {
         IDLE,
         SELECT_OPTION_SELECT_ITEM,
+        SELECT_OPTION_SEARCH,
         SELECT_OPTION_TIME,
         OPTION_SELECT_ITEM,
+        OPTION_SEARCH,
         OPTION_TIME,
         VIEW_NAME,
         VIEW_UID,
@@ -55,49 +60,105 @@ private:
     State state = State::IDLE;
 
     const unsigned long MILLIS_IDLE_TIMEOUT = 30000;
+    const int LIST_PAGE_SIZE = 10;
 
-    AuthenticateList *authList;
+    DataListManager *dataListManager;
+    const AuthenticateList *authList;
     LCD_I2C *lcd;
+    LcdFrameBuffer frameBuffer;
 
     int selectedItem = 0;
+    uint8_t selectedUid[10] = {0};
+    int searchItem = 0;
     unsigned long millisLastInteraction = 0;
     int editedPart = 0;
+    bool editRejected = false;
     uint32_t editTimeHour;
     uint32_t editTimeMinute;
-    bool editStarted = false;
+
+    bool backlightOn = true;
+    bool redrawNeeded = true;
+    uint32_t renderedListVersion = 0;
+    uint32_t renderedMinute = 0;
 
 public:
     /**
      * @brief Construct a new Ui State Machine object.
-     * @param authenticate_list List that contains the authetication data
+     * @param data_list_manager Manager of the list that contains the authetication data
      * @param lcd LCD display
      */
-    UiStateMachine(AuthenticateList *authenticate_list, LCD_I2C *lcd)
-        : authList(authenticate_list), lcd(lcd)
+    UiStateMachine(DataListManager *data_list_manager, LCD_I2C *lcd)
+        : dataListManager(data_list_manager), authList(data_list_manager->getAuthList()), lcd(lcd)
     {
     }
 
     /**
      * @brief Update the state machine.
-     * @param button Button that was pressed
+     * @param button Button that was pressed, NONE to only check for changes
      * @param millis_current Current time in milliseconds
+     * @note The display content is only recomputed if the state or the displayed data changed,
+     *       or the displayed minute of the clock passed. Call it with NONE at least once per
+     *       second to keep the clock and the backlight timeout up to date.
      */
     void Update(Button button, unsigned long millis_current)
     {
+        // The published list is replaced, not changed, by the updates
+        authList = dataListManager->getAuthList();
+
         if (button != Button::NONE)
         {
-            lcd->backlight();
+            if (!backlightOn)
+            {
+                lcd->backlight();
+                backlightOn = true;
+            }
             millisLastInteraction = millis_current;
+
+            handleButton(button);
+            redrawNeeded = true;
         }
-        else if (millis_current - millisLastInteraction > MILLIS_IDLE_TIMEOUT)
+        else if (backlightOn && (millis_current - millisLastInteraction > MILLIS_IDLE_TIMEOUT))
         {
             lcd->noBacklight();
+            backlightOn = false;
+        }
+
+        if (dataListManager->getAuthListVersion() != renderedListVersion)
+        {
+            handleListChange();
+            redrawNeeded = true;
+        }
+
+        if (isClockDisplayed() && (REALTIME_Get() / 60 != renderedMinute))
+        {
+            redrawNeeded = true;
+        }
+
+        if (redrawNeeded)
+        {
+            render();
+        }
+    }
+
+private:
+    void handleButton(Button button)
+    {
+        if (state != State::OPTION_SELECT_ITEM)
+        {
+            // Holding a button repeats it, only the list pages with it
+            if (button == Button::LEFT_HOLD)
+            {
+                button = Button::LEFT;
+            }
+            else if (button == Button::RIGHT_HOLD)
+            {
+                button = Button::RIGHT;
+            }
         }
 
         switch (state)
         {
         case State::IDLE:
-            displayTitle();
             if (button == Button::ENTER)
             {
                 state = State::SELECT_OPTION_SELECT_ITEM;
@@ -105,8 +166,6 @@ public:
             break;
 
         case State::SELECT_OPTION_SELECT_ITEM:
-            displaySelectOptionSelectItem();
-
             switch (button)
             {
             case Button::ENTER:
@@ -114,7 +173,7 @@ public:
                 break;
 
             case Button::RIGHT:
-                state = State::SELECT_OPTION_TIME;
+                state = State::SELECT_OPTION_SEARCH;
                 break;
 
             case Button::LEFT:
@@ -123,20 +182,21 @@ public:
             case Button::BACK:
                 state = State::IDLE;
                 break;
+            default:
+                break;
             }
             break;
 
-        case State::SELECT_OPTION_TIME:
-            displaySelectOptionTime();
-
+        case State::SELECT_OPTION_SEARCH:
             switch (button)
             {
             case Button::ENTER:
-                state = State::OPTION_TIME;
+                searchItem = 0;
+                state = State::OPTION_SEARCH;
                 break;
 
             case Button::RIGHT:
-                state = State::SELECT_OPTION_SELECT_ITEM;
+                state = State::SELECT_OPTION_TIME;
                 break;
 
             case Button::LEFT:
@@ -145,87 +205,113 @@ public:
             case Button::BACK:
                 state = State::IDLE;
                 break;
+            default:
+                break;
             }
             break;
 
-        case State::OPTION_TIME:
-            if (!editStarted)
+        case State::SELECT_OPTION_TIME:
+            switch (button)
+            {
+            case Button::ENTER:
             {
-                editStarted = true; // TODO
                 uint32_t time = REALTIME_Get();
                 editTimeHour = time % (60 * 60 * 24) / (60 * 60);
                 editTimeMinute = time % (60 * 60) / 60;
+                state = State::OPTION_TIME;
+                break;
             }
 
-            displayOptionTime(editedPart);
+            case Button::RIGHT:
+                state = State::SELECT_OPTION_SELECT_ITEM;
+                break;
 
+            case Button::LEFT:
+                state = State::SELECT_OPTION_SEARCH;
+                break;
+            case Button::BACK:
+                state = State::IDLE;
+                break;
+            default:
+                break;
+            }
+            break;
+
+        case State::OPTION_TIME:
+            if (button == Button::BACK)
+            {
+                REALTIME_SetTimeOfDay(editTimeHour * (60 * 60) + editTimeMinute * 60);
+
+                state = State::SELECT_OPTION_TIME;
+            }
+            else
+            {
+                editTime(button);
+            }
+            break;
+
+        case State::OPTION_SELECT_ITEM:
             switch (button)
             {
             case Button::ENTER:
-                editedPart == 1 ? editedPart = 0 : editedPart = 1;
+                if (authList->size() > 0)
+                {
+                    state = State::VIEW_NAME;
+                }
                 break;
 
             case Button::RIGHT:
-                if (editedPart == 0)
-                {
-                    editTimeHour = (editTimeHour + 1) % 24;
-                }
-                else
-                {
-                    editTimeMinute = (editTimeMinute + 1) % 60;
-                }
+                incrementSelected();
                 break;
 
             case Button::LEFT:
-                if (editedPart == 0)
-                {
-                    editTimeHour = (editTimeHour - 1) % 24;
-                }
-                else
-                {
-                    editTimeMinute = (editTimeMinute - 1) % 60;
-                }
+                decrementSelected();
+                break;
 
+            case Button::RIGHT_HOLD:
+                pageSelected(LIST_PAGE_SIZE);
                 break;
 
-            case Button::BACK:
-                REALTIME_Set(editTimeHour * (60 * 60) + editTimeMinute * 60);
+            case Button::LEFT_HOLD:
+                pageSelected(-LIST_PAGE_SIZE);
+                break;
 
-                editStarted = false;
-                state = State::SELECT_OPTION_TIME;
+            case Button::BACK:
+                state = State::SELECT_OPTION_SELECT_ITEM;
+                break;
+            default:
                 break;
             }
             break;
 
-        case State::OPTION_SELECT_ITEM:
-            displayList(selectedItem);
-
+        case State::OPTION_SEARCH:
             switch (button)
             {
             case Button::ENTER:
                 if (authList->size() > 0)
                 {
-                    state = State::VIEW_NAME;
+                    selectedItem = searchItem;
+                    state = State::OPTION_SELECT_ITEM;
                 }
                 break;
 
             case Button::RIGHT:
-                incrementSelected();
+                nextInitial();
                 break;
 
             case Button::LEFT:
-                decrementSelected();
+                previousInitial();
                 break;
 
             case Button::BACK:
-                state = State::SELECT_OPTION_SELECT_ITEM;
+                state = State::SELECT_OPTION_SEARCH;
+                break;
+            default:
                 break;
             }
             break;
 
         case State::VIEW_NAME:
-            displayName(selectedItem);
-
             switch (button)
             {
             case Button::RIGHT:
@@ -239,12 +325,12 @@ public:
             case Button::BACK:
                 state = State::OPTION_SELECT_ITEM;
                 break;
+            default:
+                break;
             }
             break;
 
         case State::VIEW_UID:
-            displayUid(selectedItem);
-
             switch (button)
             {
             case Button::RIGHT:
@@ -258,12 +344,12 @@ public:
             case Button::BACK:
                 state = State::OPTION_SELECT_ITEM;
                 break;
+            default:
+                break;
             }
             break;
 
         case State::VIEW_INTERVAL_START:
-            displayIntervalStart(selectedItem);
-
             switch (button)
             {
             case Button::RIGHT:
@@ -275,18 +361,21 @@ public:
                 break;
 
             case Button::ENTER:
+                editTimeHour = authList->getIntervalStart(authList->getSortedIndex(selectedItem)) % (60 * 60 * 24) / (60 * 60);
+                editTimeMinute = authList->getIntervalStart(authList->getSortedIndex(selectedItem)) % (60 * 60) / 60;
+                editRejected = false;
                 state = State::EDIT_INTERVAL_START;
                 break;
 
             case Button::BACK:
                 state = State::OPTION_SELECT_ITEM;
                 break;
+            default:
+                break;
             }
             break;
 
         case State::VIEW_INTERVAL_END:
-            displayIntervalEnd(selectedItem);
-
             switch (button)
             {
             case Button::RIGHT:
@@ -298,114 +387,234 @@ public:
                 break;
 
             case Button::ENTER:
+                editTimeHour = authList->getIntervalEnd(authList->getSortedIndex(selectedItem)) % (60 * 60 * 24) / (60 * 60);
+                editTimeMinute = authList->getIntervalEnd(authList->getSortedIndex(selectedItem)) % (60 * 60) / 60;
+                editRejected = false;
                 state = State::EDIT_INTERVAL_END;
                 break;
 
             case Button::BACK:
                 state = State::OPTION_SELECT_ITEM;
                 break;
+            default:
+                break;
             }
             break;
 
         case State::EDIT_INTERVAL_START:
-            if (!editStarted)
-            {
-                editStarted = true;
-                editTimeHour = (*authList)[selectedItem]->getIntervalStart() % (60 * 60 * 24) / (60 * 60);
-                editTimeMinute = (*authList)[selectedItem]->getIntervalStart() % (60 * 60) / 60;
-            }
-
-            displayEditIntervalStart(selectedItem, editedPart);
-
-            switch (button)
+            if (button == Button::BACK)
             {
-            case Button::ENTER:
-                editedPart == 1 ? editedPart = 0 : editedPart = 1;
-                break;
-
-            case Button::RIGHT:
-                if (editedPart == 0)
+                if (saveInterval(true, editTimeHour * (60 * 60) + editTimeMinute * 60))
                 {
-                    editTimeHour = (editTimeHour + 1) % 24;
+                    state = State::VIEW_INTERVAL_START;
                 }
                 else
                 {
-                    editTimeMinute = (editTimeMinute + 1) % 60;
+                    // The list is being updated, stay in edit to retry later
+                    editRejected = true;
                 }
-                break;
+            }
+            else
+            {
+                editRejected = false;
+                editTime(button);
+            }
+            break;
 
-            case Button::LEFT:
-                if (editedPart == 0)
+        case State::EDIT_INTERVAL_END:
+            if (button == Button::BACK)
+            {
+                if (saveInterval(false, editTimeHour * (60 * 60) + editTimeMinute * 60))
                 {
-                    editTimeHour = (editTimeHour - 1) % 24;
+                    state = State::VIEW_INTERVAL_END;
                 }
                 else
                 {
-                    editTimeMinute = (editTimeMinute - 1) % 60;
+                    // The list is being updated, stay in edit to retry later
+                    editRejected = true;
                 }
+            }
+            else
+            {
+                editRejected = false;
+                editTime(button);
+            }
+            break;
+        }
+    }
 
-                break;
+    /**
+     * @brief Save the edited interval of the selected item.
+     * @param start True to save the start, false to save the end of the interval
+     * @param value Interval boundary in seconds from midnight
+     * @return True if saved, false if a batch update is in progress or the schedule table is full
+     * @note The change is published as an update of one item. Only the selected item gets the new
+     *       interval, the others sharing the old one keep it.
+     */
+    bool saveInterval(bool start, uint32_t value)
+    {
+        if (dataListManager->getAuthBatch() != nullptr)
+        {
+            return false;
+        }
 
-            case Button::BACK:
-                (*authList)[selectedItem]->setIntervalStart(editTimeHour * (60 * 60) + editTimeMinute * 60);
+        dataListManager->beginAuthBatch(true);
+        AuthenticateList *draft = dataListManager->getAuthBatch();
+        int index = draft->findByUid(selectedUid);
+        bool saved = true;
+        if (index != -1)
+        {
+            uint32_t interval_start = start ? value : draft->getIntervalStart(index);
+            uint32_t interval_end = start ? draft->getIntervalEnd(index) : value;
+            saved = draft->setInterval(index, interval_start, interval_end);
+        }
+        if (!saved)
+        {
+            dataListManager->abortAuthBatch();
+            return false;
+        }
+        dataListManager->commitAuthBatch();
+        authList = dataListManager->getAuthList();
+        return true;
+    }
 
-                editStarted = false;
-                state = State::VIEW_INTERVAL_START;
-                break;
+    void editTime(Button button)
+    {
+        switch (button)
+        {
+        case Button::ENTER:
+            editedPart == 1 ? editedPart = 0 : editedPart = 1;
+            break;
+
+        case Button::RIGHT:
+            if (editedPart == 0)
+            {
+                editTimeHour = (editTimeHour + 1) % 24;
+            }
+            else
+            {
+                editTimeMinute = (editTimeMinute + 1) % 60;
             }
             break;
 
-        case State::EDIT_INTERVAL_END:
-            if (!editStarted)
+        case Button::LEFT:
+            if (editedPart == 0)
             {
-                editStarted = true;
-                editTimeHour = (*authList)[selectedItem]->getIntervalEnd() % (60 * 60 * 24) / (60 * 60);
-                editTimeMinute = (*authList)[selectedItem]->getIntervalEnd() % (60 * 60) / 60;
+                editTimeHour = (editTimeHour + 23) % 24;
             }
+            else
+            {
+                editTimeMinute = (editTimeMinute + 59) % 60;
+            }
+            break;
 
-            displayEditIntervalEnd(selectedItem, editedPart);
+        default:
+            break;
+        }
+    }
 
-            switch (button)
-            {
-            case Button::ENTER:
-                editedPart == 1 ? editedPart = 0 : editedPart = 1;
-                break;
+    void handleListChange(void)
+    {
+        renderedListVersion = dataListManager->getAuthListVersion();
 
-            case Button::RIGHT:
-                if (editedPart == 0)
-                {
-                    editTimeHour = (editTimeHour + 1) % 24;
-                }
-                else
-                {
-                    editTimeMinute = (editTimeMinute + 1) % 60;
-                }
-                break;
+        // Follow the selected item, its position in name order may have changed
+        int index = authList->findByUid(selectedUid);
+        if (index != -1)
+        {
+            selectedItem = authList->getRank(index);
+        }
+        if (selectedItem >= authList->size())
+        {
+            selectedItem = (authList->size() > 0) ? (authList->size() - 1) : 0;
+        }
+        if (searchItem >= authList->size())
+        {
+            searchItem = 0;
+        }
 
-            case Button::LEFT:
-                if (editedPart == 0)
-                {
-                    editTimeHour = (editTimeHour - 1) % 24;
-                }
-                else
-                {
-                    editTimeMinute = (editTimeMinute - 1) % 60;
-                }
+        if ((authList->size() == 0) &&
+            (state != State::IDLE) && (state != State::SELECT_OPTION_SELECT_ITEM) &&
+            (state != State::SELECT_OPTION_TIME) && (state != State::OPTION_TIME))
+        {
+            // The viewed item is gone
+            state = State::OPTION_SELECT_ITEM;
+        }
+    }
 
-                break;
+    bool isClockDisplayed(void) const
+    {
+        return (state == State::SELECT_OPTION_TIME);
+    }
 
-            case Button::BACK:
-                (*authList)[selectedItem]->setIntervalEnd(editTimeHour * (60 * 60) + editTimeMinute * 60);
+    void render(void)
+    {
+        redrawNeeded = false;
+        renderedMinute = REALTIME_Get() / 60;
 
-                editStarted = false;
-                state = State::VIEW_INTERVAL_END;
-                break;
-            }
+        int selectedIndex = authList->getSortedIndex(selectedItem);
+        if (selectedIndex != -1)
+        {
+            memcpy(selectedUid, (*authList)[selectedIndex]->getUid(), sizeof(selectedUid));
+        }
+
+        switch (state)
+        {
+        case State::IDLE:
+            displayTitle();
+            break;
+
+        case State::SELECT_OPTION_SELECT_ITEM:
+            displaySelectOptionSelectItem();
+            break;
+
+        case State::SELECT_OPTION_SEARCH:
+            displaySelectOptionSearch();
+            break;
+
+        case State::SELECT_OPTION_TIME:
+            displaySelectOptionTime();
+            break;
+
+        case State::OPTION_SEARCH:
+            displaySearch(searchItem);
+            break;
+
+        case State::OPTION_TIME:
+            displayOptionTime(editedPart);
+            break;
+
+        case State::OPTION_SELECT_ITEM:
+            displayList(selectedIndex);
+            break;
+
+        case State::VIEW_NAME:
+            displayName(selectedIndex);
+            break;
+
+        case State::VIEW_UID:
+            displayUid(selectedIndex);
+            break;
+
+        case State::VIEW_INTERVAL_START:
+            displayIntervalStart(selectedIndex);
+            break;
+
+        case State::VIEW_INTERVAL_END:
+            displayIntervalEnd(selectedIndex);
+            break;
+
+        case State::EDIT_INTERVAL_START:
+            displayEditIntervalStart(selectedIndex, editedPart);
+            break;
+
+        case State::EDIT_INTERVAL_END:
+            displayEditIntervalEnd(selectedIndex, editedPart);
             break;
         }
+
+        frameBuffer.flush(lcd);
     }
 
-private:
     void incrementSelected(void)
     {
         selectedItem++;
@@ -424,20 +633,87 @@ private:
         }
     }
 
+    void pageSelected(int step)
+    {
+        if ((*authList).size() < 1)
+        {
+            return;
+        }
+
+        // Stop at the ends first, wrap around only from there
+        int last = (*authList).size() - 1;
+        if (step > 0)
+        {
+            selectedItem = (selectedItem == last) ? 0 : ((selectedItem + step > last) ? last : selectedItem + step);
+        }
+        else
+        {
+            selectedItem = (selectedItem == 0) ? last : ((selectedItem + step < 0) ? 0 : selectedItem + step);
+        }
+    }
+
+    void nextInitial(void)
+    {
+        char initial = authList->getInitial(searchItem);
+        searchItem = authList->findFirstByInitial(initial + 1);
+        if (searchItem >= (*authList).size())
+        {
+            searchItem = 0;
+        }
+    }
+
+    void previousInitial(void)
+    {
+        int previous = (searchItem > 0) ? (searchItem - 1) : ((*authList).size() - 1);
+        if (previous < 0)
+        {
+            return;
+        }
+        searchItem = authList->findFirstByInitial(authList->getInitial(previous));
+    }
+
     void displayTitle(void)
     {
-        lcd->clear();
-        lcd->setCursor(0, 0);
-        lcd->print("Belepteto");
-        lcd->setCursor(0, 7);
-        lcd->print("Kozponti");
+        frameBuffer.clear();
+        frameBuffer.setCursor(0, 0);
+        frameBuffer.print("Belepteto");
+        frameBuffer.setCursor(0, 1);
+        frameBuffer.print("Kozponti");
     }
 
     void displaySelectOptionSelectItem(void)
     {
-        lcd->clear();
-        lcd->setCursor(0, 0);
-        lcd->print("Elem kivalasztasa");
+        frameBuffer.clear();
+        frameBuffer.setCursor(0, 0);
+        frameBuffer.print("Elem kivalasztasa");
+    }
+
+    void displaySelectOptionSearch(void)
+    {
+        frameBuffer.clear();
+        frameBuffer.setCursor(0, 0);
+        frameBuffer.print("Kereses betuvel");
+    }
+
+    void displaySearch(int search_item)
+    {
+        if ((*authList).size() < 1)
+        {
+            frameBuffer.clear();
+            frameBuffer.setCursor(0, 0);
+            frameBuffer.print("Ures lista");
+            return;
+        }
+
+        char display_str[17];
+        sprintf(display_str, "Kezdobetu: *%c*", authList->getInitial(search_item));
+
+        const AuthenticateData *item = (*authList)[authList->getSortedIndex(search_item)];
+        frameBuffer.clear();
+        frameBuffer.setCursor(0, 0);
+        frameBuffer.print(display_str);
+        frameBuffer.setCursor(0, 1);
+        frameBuffer.print(item->getName());
     }
 
     void displaySelectOptionTime(void)
@@ -448,11 +724,11 @@ private:
         uint32_t timeMinute = time % (60 * 60) / 60;
         sprintf(display_str, "%02d:%02d", timeHour, timeMinute);
 
-        lcd->clear();
-        lcd->setCursor(0, 0);
-        lcd->print("Ido");
-        lcd->setCursor(0, 1);
-        lcd->print(display_str);
+        frameBuffer.clear();
+        frameBuffer.setCursor(0, 0);
+        frameBuffer.print("Ido");
+        frameBuffer.setCursor(0, 1);
+        frameBuffer.print(display_str);
     }
 
     void displayOptionTime(int selected_part)
@@ -471,38 +747,41 @@ private:
             sprintf(display_str, "00:00");
         }
 
-        lcd->clear();
-        lcd->setCursor(0, 0);
-        lcd->print("Ido: ");
-        lcd->setCursor(0, 1);
-        lcd->print(display_str);
+        frameBuffer.clear();
+        frameBuffer.setCursor(0, 0);
+        frameBuffer.print("Ido: ");
+        frameBuffer.setCursor(0, 1);
+        frameBuffer.print(display_str);
     }
 
     void displayList(int selected_item)
     {
         if ((*authList).size() < 1)
         {
-            lcd->clear();
-            lcd->setCursor(0, 0);
-            lcd->print("Ures lista");
+            frameBuffer.clear();
+            frameBuffer.setCursor(0, 0);
+            frameBuffer.print("Ures lista");
             return;
         }
+        char display_str[17];
+        sprintf(display_str, "Lista %d/%d", selectedItem + 1, (*authList).size());
+
         const AuthenticateData *item = (*authList)[selected_item];
-        lcd->clear();
-        lcd->setCursor(0, 0);
-        lcd->print("Lista elem:");
-        lcd->setCursor(0, 1);
-        lcd->print(item->getName());
+        frameBuffer.clear();
+        frameBuffer.setCursor(0, 0);
+        frameBuffer.print(display_str);
+        frameBuffer.setCursor(0, 1);
+        frameBuffer.print(item->getName());
     }
 
     void displayName(int selected_item)
     {
         const AuthenticateData *item = (*authList)[selected_item];
-        lcd->clear();
-        lcd->setCursor(0, 0);
-        lcd->print("Nev: ");
-        lcd->setCursor(0, 1);
-        lcd->print(item->getName());
+        frameBuffer.clear();
+        frameBuffer.setCursor(0, 0);
+        frameBuffer.print("Nev: ");
+        frameBuffer.setCursor(0, 1);
+        frameBuffer.print(item->getName());
     }
 
     void displayUid(int selected_item)
@@ -515,45 +794,43 @@ private:
         sprintf(display_str0, "UID: 0x%02X%02X %02X%02X", uid[0], uid[1], uid[2], uid[3]);
         sprintf(display_str1, "  %02X%02X %02X%02X %02X%02X", uid[4], uid[5], uid[6], uid[7], uid[8], uid[9]);
 
-        lcd->clear();
-        lcd->setCursor(0, 0);
-        lcd->print(display_str0);
-        lcd->setCursor(0, 1);
-        lcd->print(display_str1);
+        frameBuffer.clear();
+        frameBuffer.setCursor(0, 0);
+        frameBuffer.print(display_str0);
+        frameBuffer.setCursor(0, 1);
+        frameBuffer.print(display_str1);
     }
 
     void displayIntervalStart(int selected_item)
     {
-        const AuthenticateData *item = (*authList)[selected_item];
-        uint32_t interval_start = item->getIntervalStart();
+        uint32_t interval_start = authList->getIntervalStart(selected_item);
         uint32_t hour = interval_start % (60 * 60 * 24) / (60 * 60);
         uint32_t minute = interval_start % (60 * 60) / 60;
 
         char display_str[17];
         sprintf(display_str, "%02d:%02d", hour, minute);
 
-        lcd->clear();
-        lcd->setCursor(0, 0);
-        lcd->print("Kezdete: ");
-        lcd->setCursor(0, 1);
-        lcd->print(display_str);
+        frameBuffer.clear();
+        frameBuffer.setCursor(0, 0);
+        frameBuffer.print("Kezdete: ");
+        frameBuffer.setCursor(0, 1);
+        frameBuffer.print(display_str);
     }
 
     void displayIntervalEnd(int selected_item)
     {
-        const AuthenticateData *item = (*authList)[selected_item];
-        uint32_t interval_end = item->getIntervalEnd();
+        uint32_t interval_end = authList->getIntervalEnd(selected_item);
         uint32_t hour = interval_end % (60 * 60 * 24) / (60 * 60);
         uint32_t minute = interval_end % (60 * 60) / 60;
 
         char display_str[17];
         sprintf(display_str, "%02d:%02d", hour, minute);
 
-        lcd->clear();
-        lcd->setCursor(0, 0);
-        lcd->print("Vege: ");
-        lcd->setCursor(0, 1);
-        lcd->print(display_str);
+        frameBuffer.clear();
+        frameBuffer.setCursor(0, 0);
+        frameBuffer.print("Vege: ");
+        frameBuffer.setCursor(0, 1);
+        frameBuffer.print(display_str);
     }
 
     void displayEditIntervalStart(int selected_item, int selected_part)
@@ -572,11 +849,16 @@ private:
             sprintf(display_str, "00:00");
         }
 
-        lcd->clear();
-        lcd->setCursor(0, 0);
-        lcd->print("Kezdete: ");
-        lcd->setCursor(0, 1);
-        lcd->print(display_str);
+        frameBuffer.clear();
+        frameBuffer.setCursor(0, 0);
+        frameBuffer.print("Kezdete: ");
+        frameBuffer.setCursor(0, 1);
+        frameBuffer.print(display_str);
+        if (editRejected)
+        {
+            frameBuffer.setCursor(9, 1);
+            frameBuffer.print("Foglalt");
+        }
     }
 
     void displayEditIntervalEnd(int selected_item, int selected_part)
@@ -595,10 +877,15 @@ private:
             sprintf(display_str, "00:00");
         }
 
-        lcd->clear();
-        lcd->setCursor(0, 0);
-        lcd->print("Vege: ");
-        lcd->setCursor(0, 1);
-        lcd->print(display_str);
+        frameBuffer.clear();
+        frameBuffer.setCursor(0, 0);
+        frameBuffer.print("Vege: ");
+        frameBuffer.setCursor(0, 1);
+        frameBuffer.print(display_str);
+        if (editRejected)
+        {
+            frameBuffer.setCursor(9, 1);
+            frameBuffer.print("Foglalt");
+        }
     }
 }; /* class UiStateMachine */
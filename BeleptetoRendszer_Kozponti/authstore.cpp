@@ -0,0 +1,565 @@
+/**
+ ***************************************************************************************************
+ * @file authstore.cpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Implementation of authstore.h.
+ *
+ * The slots are probed linearly from the home slot of the UID hash. RAM keeps a fingerprint byte
+ * of every slot, so only the slots whose fingerprint matches the UID are read from the EEPROM: a
+ * stored user is found with one slot read (plus one for each fingerprint collision, 1/254 per
+ * probe), and an unknown UID is usually rejected without reading anything. Adding, changing or
+ * removing a user writes a single slot.
+ *
+ * The slots of a cleared store are not erased, every slot is marked with the generation of the
+ * store, and clearing starts a new generation.
+ *
+ * A removed user leaves a deleted slot, so the probe sequences passing it do not end there. The
+ * deleted slots right before an empty one end no probe sequence, they are made empty again in
+ * RAM after a removal and by the boot scan. Their flags stay deleted in the EEPROM, the boot scan
+ * reclaims them again.
+ ***************************************************************************************************
+ */
+
+#include "authstore.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+
+#if AUTH_STORE_ENABLED
+
+/**
+ * @brief Marks the header of the store.
+ */
+#define AUTH_STORE_MAGIC 0x5553
+
+/**
+ * @defgroup auth_store_flags Flags of the slots
+ * @brief First byte of a slot. A slot flagged with the generation of the store is in use.
+ * @{
+ */
+#define AUTH_STORE_FLAG_DELETED 0x00
+#define AUTH_STORE_FLAG_ERASED 0xFF
+/** @} */
+
+/**
+ * @defgroup auth_store_fingerprints Fingerprints of the slots in RAM
+ * @brief Values of the fingerprint of a slot that is not in use, the used ones are 2-255.
+ * @{
+ */
+#define AUTH_STORE_FINGERPRINT_EMPTY 0
+#define AUTH_STORE_FINGERPRINT_DELETED 1
+/** @} */
+
+/**
+ * @brief Marks a free entry of the cache.
+ */
+#define AUTH_STORE_NO_SLOT 0xFFFF
+
+/**
+ * @brief A cached user.
+ */
+typedef struct _auth_store_cache_entry
+{
+    auth_store_record_t record;
+    uint16_t slot;
+    uint32_t lastUsed;
+} auth_store_cache_entry_t;
+
+/** @brief The external EEPROM. */
+static StorageBackend *store = nullptr;
+
+/** @brief Fingerprints of the slots, see auth_store_fingerprints. */
+static uint8_t fingerprints[AUTH_STORE_SLOT_COUNT];
+
+/** @brief The recently found users. */
+static auth_store_cache_entry_t cache[AUTH_STORE_CACHE_SIZE];
+
+/** @brief Incremented on every use of the cache, orders its entries by the last use. */
+static uint32_t cacheClock = 0;
+
+/** @brief Generation of the store, 1-254. */
+static uint8_t generation = 1;
+
+/** @brief Counters of the store. */
+static auth_store_stats_t stats;
+
+/** @brief The time of the last write in milliseconds. */
+static unsigned long lastWriteMillis = 0;
+
+/**
+ * @brief Wait until the write cycle of the last write has surely finished.
+ */
+static void waitForWrite(void)
+{
+    unsigned long elapsed = millis() - lastWriteMillis;
+    if (elapsed <= store->getWriteDelayMs())
+    {
+        delay(store->getWriteDelayMs() + 1 - elapsed);
+    }
+}
+
+/**
+ * @brief Get the EEPROM address of a slot.
+ * @param slot Index of the slot.
+ * @return Address of the slot.
+ */
+static uint16_t addressOf(uint16_t slot)
+{
+    return (slot + 1) * AUTH_STORE_SLOT_SIZE;
+}
+
+/**
+ * @brief Hash a UID.
+ * @param uid UID of an RFID tag.
+ * @return FNV-1a hash of the UID.
+ */
+static uint32_t hashUid(const uint8_t *uid)
+{
+    uint32_t hash = 2166136261UL;
+    for (int i = 0; i < 10; i++)
+    {
+        hash ^= uid[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Get the fingerprint of a hash.
+ * @param hash Hash of a UID.
+ * @return Fingerprint, 2-255.
+ */
+static uint8_t fingerprintOf(uint32_t hash)
+{
+    return 2 + (hash % 254);
+}
+
+/**
+ * @brief Read a slot.
+ * @param slot Index of the slot.
+ * @param record The user in the slot.
+ * @note Format: FLAG{1} + FINGERPRINT{1} + UID{10} + NAME{16} + BEGIN_HOUR{1} + BEGIN_MINUTE{1} +
+ *       END_HOUR{1} + END_MINUTE{1} = 32
+ */
+static void readSlot(uint16_t slot, auth_store_record_t *record)
+{
+    uint8_t buffer[AUTH_STORE_SLOT_SIZE];
+
+    waitForWrite();
+    store->read(addressOf(slot), buffer, AUTH_STORE_SLOT_SIZE);
+    stats.slotReads++;
+
+    memcpy(record->uid, &(buffer[2]), 10);
+    memcpy(record->name, &(buffer[12]), 16);
+    record->name[16] = '\0';
+    record->intervalStart = (buffer[28] * 60 + buffer[29]) * 60;
+    record->intervalEnd = (buffer[30] * 60 + buffer[31]) * 60;
+}
+
+/**
+ * @brief Write a user into a slot.
+ * @param slot Index of the slot.
+ * @param record The user.
+ * @param fingerprint Fingerprint of the UID of the user.
+ */
+static void writeSlot(uint16_t slot, const auth_store_record_t *record, uint8_t fingerprint)
+{
+    uint8_t buffer[AUTH_STORE_SLOT_SIZE];
+
+    buffer[0] = generation;
+    buffer[1] = fingerprint;
+    memcpy(&(buffer[2]), record->uid, 10);
+    strncpy((char *)&(buffer[12]), record->name, 16);
+    buffer[28] = record->intervalStart % (60 * 60 * 24) / (60 * 60);
+    buffer[29] = record->intervalStart % (60 * 60) / 60;
+    buffer[30] = record->intervalEnd % (60 * 60 * 24) / (60 * 60);
+    buffer[31] = record->intervalEnd % (60 * 60) / 60;
+
+    waitForWrite();
+    store->write(addressOf(slot), buffer, AUTH_STORE_SLOT_SIZE);
+    lastWriteMillis = millis();
+}
+
+/**
+ * @brief Write the flag of a slot.
+ * @param slot Index of the slot.
+ * @param flag The flag, see auth_store_flags.
+ */
+static void writeFlag(uint16_t slot, uint8_t flag)
+{
+    waitForWrite();
+    store->write(addressOf(slot), &flag, 1);
+    lastWriteMillis = millis();
+}
+
+/**
+ * @brief Write the header of the store.
+ * @note Format: MAGIC{2} + GENERATION{1}
+ */
+static void writeHeader(void)
+{
+    uint8_t header[3] = {AUTH_STORE_MAGIC >> 8, AUTH_STORE_MAGIC & 0xFF, generation};
+
+    waitForWrite();
+    store->write(0, header, sizeof(header));
+    lastWriteMillis = millis();
+}
+
+/**
+ * @brief Find the slot of a user.
+ * @param uid UID of an RFID tag.
+ * @param record The user if found.
+ * @param freeSlot The first slot a new user with the UID can be written into, -1 if the table is
+ *                 full. nullptr if not needed.
+ * @return Index of the slot, -1 if not found.
+ */
+static int findSlot(const uint8_t *uid, auth_store_record_t *record, int *freeSlot)
+{
+    uint32_t hash = hashUid(uid);
+    uint8_t fingerprint = fingerprintOf(hash);
+    uint16_t slot = (hash >> 8) % AUTH_STORE_SLOT_COUNT;
+    int firstFree = -1;
+
+    for (uint16_t probe = 0; probe < AUTH_STORE_SLOT_COUNT; probe++)
+    {
+        if (fingerprints[slot] == AUTH_STORE_FINGERPRINT_EMPTY)
+        {
+            // The end of the probe sequence
+            if (firstFree == -1)
+            {
+                firstFree = slot;
+            }
+            break;
+        }
+        if ((fingerprints[slot] == AUTH_STORE_FINGERPRINT_DELETED) && (firstFree == -1))
+        {
+            firstFree = slot;
+        }
+        if (fingerprints[slot] == fingerprint)
+        {
+            readSlot(slot, record);
+            if (memcmp(record->uid, uid, 10) == 0)
+            {
+                return slot;
+            }
+        }
+        slot = (slot + 1) % AUTH_STORE_SLOT_COUNT;
+    }
+
+    if (freeSlot != nullptr)
+    {
+        *freeSlot = firstFree;
+    }
+    return -1;
+}
+
+/**
+ * @brief Make the deleted slots before an empty slot empty.
+ * @param slot Index of an empty slot.
+ * @note No probe sequence passes an empty slot, so the deleted slots before it only make the
+ *       sequences reaching them longer.
+ */
+static void reclaimDeleted(uint16_t slot)
+{
+    for (uint16_t i = 0; i < AUTH_STORE_SLOT_COUNT; i++)
+    {
+        slot = (slot + AUTH_STORE_SLOT_COUNT - 1) % AUTH_STORE_SLOT_COUNT;
+        if (fingerprints[slot] != AUTH_STORE_FINGERPRINT_DELETED)
+        {
+            break;
+        }
+        fingerprints[slot] = AUTH_STORE_FINGERPRINT_EMPTY;
+        stats.deleted--;
+    }
+}
+
+/**
+ * @brief Find a user in the cache.
+ * @param uid UID of an RFID tag.
+ * @return The cache entry, nullptr if not cached.
+ */
+static auth_store_cache_entry_t *findInCache(const uint8_t *uid)
+{
+    for (int i = 0; i < AUTH_STORE_CACHE_SIZE; i++)
+    {
+        if ((cache[i].slot != AUTH_STORE_NO_SLOT) && (memcmp(cache[i].record.uid, uid, 10) == 0))
+        {
+            return &(cache[i]);
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Put a user into the cache, in place of the least recently used one.
+ * @param slot Index of the slot of the user.
+ * @param record The user.
+ */
+static void putIntoCache(uint16_t slot, const auth_store_record_t *record)
+{
+    auth_store_cache_entry_t *victim = &(cache[0]);
+    for (int i = 0; i < AUTH_STORE_CACHE_SIZE; i++)
+    {
+        if (cache[i].slot == AUTH_STORE_NO_SLOT)
+        {
+            victim = &(cache[i]);
+            break;
+        }
+        if (cache[i].lastUsed < victim->lastUsed)
+        {
+            victim = &(cache[i]);
+        }
+    }
+
+    victim->record = *record;
+    victim->slot = slot;
+    victim->lastUsed = ++cacheClock;
+}
+
+/**
+ * @brief Empty the cache.
+ */
+static void clearCache(void)
+{
+    for (int i = 0; i < AUTH_STORE_CACHE_SIZE; i++)
+    {
+        cache[i].slot = AUTH_STORE_NO_SLOT;
+    }
+}
+
+#endif /* AUTH_STORE_ENABLED */
+
+/**
+ * @brief Initialize the store, build the fingerprints from the EEPROM.
+ * @param storage The external EEPROM, at least AUTH_STORE_SIZE bytes.
+ * @note Must be called after the I2C initialization. Reading the fingerprints takes about 1 second,
+ *       a new EEPROM is erased first, which takes about 13 seconds.
+ */
+void AUTHSTORE_Init(StorageBackend *storage)
+{
+#if AUTH_STORE_ENABLED
+    store = storage;
+    clearCache();
+    memset(&stats, 0, sizeof(stats));
+
+    uint8_t header[3];
+    waitForWrite();
+    store->read(0, header, sizeof(header));
+    if (((((uint16_t)header[0] << 8) | header[1]) != AUTH_STORE_MAGIC) ||
+        (header[2] == AUTH_STORE_FLAG_DELETED) || (header[2] == AUTH_STORE_FLAG_ERASED))
+    {
+        // Not a store yet, the flags may be anything
+        for (uint16_t slot = 0; slot < AUTH_STORE_SLOT_COUNT; slot++)
+        {
+            writeFlag(slot, AUTH_STORE_FLAG_ERASED);
+        }
+        generation = 1;
+        writeHeader();
+        memset(fingerprints, AUTH_STORE_FINGERPRINT_EMPTY, sizeof(fingerprints));
+        return;
+    }
+
+    generation = header[2];
+    for (uint16_t slot = 0; slot < AUTH_STORE_SLOT_COUNT; slot++)
+    {
+        uint8_t flags[2];
+        store->read(addressOf(slot), flags, sizeof(flags));
+        if (flags[0] == generation)
+        {
+            fingerprints[slot] = flags[1];
+            stats.count++;
+        }
+        else if (flags[0] == AUTH_STORE_FLAG_DELETED)
+        {
+            fingerprints[slot] = AUTH_STORE_FINGERPRINT_DELETED;
+            stats.deleted++;
+        }
+        else
+        {
+            fingerprints[slot] = AUTH_STORE_FINGERPRINT_EMPTY;
+        }
+    }
+
+    for (uint16_t slot = 0; slot < AUTH_STORE_SLOT_COUNT; slot++)
+    {
+        if (fingerprints[slot] == AUTH_STORE_FINGERPRINT_EMPTY)
+        {
+            reclaimDeleted(slot);
+        }
+    }
+#endif /* AUTH_STORE_ENABLED */
+}
+
+/**
+ * @brief Find a user.
+ * @param uid UID of an RFID tag.
+ * @param record The user if found.
+ * @return True if found, false if not or the store is disabled.
+ */
+bool AUTHSTORE_Find(const uint8_t *uid, auth_store_record_t *record)
+{
+#if AUTH_STORE_ENABLED
+    auth_store_cache_entry_t *entry = findInCache(uid);
+    if (entry != nullptr)
+    {
+        entry->lastUsed = ++cacheClock;
+        *record = entry->record;
+        stats.hits++;
+        return true;
+    }
+
+    unsigned long startMicros = micros();
+    int slot = findSlot(uid, record, nullptr);
+    uint32_t elapsedMicros = micros() - startMicros;
+
+    stats.misses++;
+    stats.missMicrosTotal += elapsedMicros;
+    if (elapsedMicros > stats.missMicrosMax)
+    {
+        stats.missMicrosMax = elapsedMicros;
+    }
+
+    if (slot == -1)
+    {
+        return false;
+    }
+    putIntoCache(slot, record);
+    return true;
+#else
+    return false;
+#endif /* AUTH_STORE_ENABLED */
+}
+
+/**
+ * @brief Add a user, or change the user with the same UID.
+ * @param record The user.
+ * @return True if stored, false if the store is full or disabled.
+ */
+bool AUTHSTORE_Put(const auth_store_record_t *record)
+{
+#if AUTH_STORE_ENABLED
+    auth_store_record_t existing;
+    int freeSlot = -1;
+    int slot = findSlot(record->uid, &existing, &freeSlot);
+    if (slot == -1)
+    {
+        if ((stats.count >= AUTH_STORE_MAX_USERS) || (freeSlot == -1))
+        {
+            return false;
+        }
+        slot = freeSlot;
+        stats.count++;
+        if (fingerprints[slot] == AUTH_STORE_FINGERPRINT_DELETED)
+        {
+            stats.deleted--;
+        }
+    }
+
+    uint8_t fingerprint = fingerprintOf(hashUid(record->uid));
+    writeSlot(slot, record, fingerprint);
+    fingerprints[slot] = fingerprint;
+
+    auth_store_cache_entry_t *entry = findInCache(record->uid);
+    if (entry != nullptr)
+    {
+        entry->record = *record;
+        entry->record.name[16] = '\0';
+    }
+    return true;
+#else
+    return false;
+#endif /* AUTH_STORE_ENABLED */
+}
+
+/**
+ * @brief Remove a user.
+ * @param uid UID of an RFID tag.
+ * @return True if removed, false if not found or the store is disabled.
+ */
+bool AUTHSTORE_Remove(const uint8_t *uid)
+{
+#if AUTH_STORE_ENABLED
+    auth_store_record_t existing;
+    int slot = findSlot(uid, &existing, nullptr);
+    if (slot == -1)
+    {
+        return false;
+    }
+
+    writeFlag(slot, AUTH_STORE_FLAG_DELETED);
+    fingerprints[slot] = AUTH_STORE_FINGERPRINT_DELETED;
+    stats.count--;
+    stats.deleted++;
+
+    uint16_t next = (slot + 1) % AUTH_STORE_SLOT_COUNT;
+    if (fingerprints[next] == AUTH_STORE_FINGERPRINT_EMPTY)
+    {
+        reclaimDeleted(next);
+    }
+
+    auth_store_cache_entry_t *entry = findInCache(uid);
+    if (entry != nullptr)
+    {
+        entry->slot = AUTH_STORE_NO_SLOT;
+    }
+    return true;
+#else
+    return false;
+#endif /* AUTH_STORE_ENABLED */
+}
+
+/**
+ * @brief Remove all users.
+ * @note Starts a new generation, only the header is written. Every 254th clear erases the flags of
+ *       all slots, as the generations wrap around.
+ */
+void AUTHSTORE_Clear(void)
+{
+#if AUTH_STORE_ENABLED
+    generation++;
+    if (generation == AUTH_STORE_FLAG_ERASED)
+    {
+        for (uint16_t slot = 0; slot < AUTH_STORE_SLOT_COUNT; slot++)
+        {
+            writeFlag(slot, AUTH_STORE_FLAG_ERASED);
+        }
+        generation = 1;
+    }
+    writeHeader();
+
+    memset(fingerprints, AUTH_STORE_FINGERPRINT_EMPTY, sizeof(fingerprints));
+    clearCache();
+    stats.count = 0;
+    stats.deleted = 0;
+#endif /* AUTH_STORE_ENABLED */
+}
+
+/**
+ * @brief Get the counters of the store.
+ * @param out The counters, all zero if the store is disabled.
+ */
+void AUTHSTORE_GetStats(auth_store_stats_t *out)
+{
+#if AUTH_STORE_ENABLED
+    *out = stats;
+#else
+    memset(out, 0, sizeof(auth_store_stats_t));
+#endif /* AUTH_STORE_ENABLED */
+}
+
+/**
+ * @brief Reset the lookup counters of the store.
+ */
+void AUTHSTORE_ResetStats(void)
+{
+#if AUTH_STORE_ENABLED
+    uint16_t count = stats.count;
+    uint16_t deleted = stats.deleted;
+    memset(&stats, 0, sizeof(stats));
+    stats.count = count;
+    stats.deleted = deleted;
+#endif /* AUTH_STORE_ENABLED */
+}
@@ -0,0 +1,100 @@
+/**
+ ***************************************************************************************************
+ * @file authstore.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Header file for the user store in an external I2C EEPROM.
+ *
+ * The store holds far more users than the auth list, which has to fit in RAM. The users are kept
+ * in a hash table in the external EEPROM, RAM only holds a fingerprint byte per slot and a small
+ * LRU cache of the recently found users.
+ ***************************************************************************************************
+ */
+
+#ifndef AUTHSTORE_H
+#define AUTHSTORE_H
+
+#include <stdint.h>
+
+#include "StorageBackend.hpp"
+
+/**
+ * @brief Enables the user store. Set to 1 if the external EEPROM is fitted.
+ */
+#ifndef AUTH_STORE_ENABLED
+#define AUTH_STORE_ENABLED 0
+#endif /* AUTH_STORE_ENABLED */
+
+/**
+ * @brief The lower 3 bits of the device address of the external EEPROM (24LC512, 64 KB).
+ */
+#define AUTH_STORE_ADDRESS_LOWER_3_BITS 0b000
+
+/**
+ * @brief Size of the external EEPROM in bytes.
+ */
+#define AUTH_STORE_SIZE 65536UL
+
+/**
+ * @brief Size of a slot in bytes, a slot never crosses a page of the EEPROM.
+ */
+#define AUTH_STORE_SLOT_SIZE 32
+
+/**
+ * @brief Number of user slots, the first slot of the EEPROM holds the header.
+ */
+#define AUTH_STORE_SLOT_COUNT (AUTH_STORE_SIZE / AUTH_STORE_SLOT_SIZE - 1)
+
+/**
+ * @brief Maximum number of users, the table is kept below 80% full for short probe sequences.
+ */
+#define AUTH_STORE_MAX_USERS 1600
+
+/**
+ * @brief Number of users in the LRU cache.
+ */
+#ifndef AUTH_STORE_CACHE_SIZE
+#define AUTH_STORE_CACHE_SIZE 32
+#endif /* AUTH_STORE_CACHE_SIZE */
+
+/**
+ * @brief A user of the store.
+ */
+typedef struct _auth_store_record
+{
+    uint8_t uid[10];        /**< UID of the RFID tag */
+    char name[16 + 1];      /**< Name of the RFID tag owner */
+    uint32_t intervalStart; /**< Start of the authentication interval, seconds from midnight */
+    uint32_t intervalEnd;   /**< End of the authentication interval, seconds from midnight */
+} auth_store_record_t;
+
+/**
+ * @brief Counters of the store.
+ */
+typedef struct _auth_store_stats
+{
+    uint16_t count;           /**< Number of users */
+    uint16_t deleted;         /**< Deleted slots that still lengthen the probe sequences */
+    uint32_t hits;            /**< Lookups answered by the cache */
+    uint32_t misses;          /**< Lookups that went to the EEPROM */
+    uint32_t slotReads;       /**< Slots read from the EEPROM */
+    uint32_t missMicrosMax;   /**< Longest lookup that went to the EEPROM */
+    uint64_t missMicrosTotal; /**< Total time of the lookups that went to the EEPROM */
+} auth_store_stats_t;
+
+void AUTHSTORE_Init(StorageBackend *storage);
+
+bool AUTHSTORE_Find(const uint8_t *uid, auth_store_record_t *record);
+
+bool AUTHSTORE_Put(const auth_store_record_t *record);
+
+bool AUTHSTORE_Remove(const uint8_t *uid);
+
+void AUTHSTORE_Clear(void);
+
+void AUTHSTORE_GetStats(auth_store_stats_t *out);
+
+void AUTHSTORE_ResetStats(void);
+
+#endif /* AUTHSTORE_H */
@@ -0,0 +1,186 @@
+/**
+ ***************************************************************************************************
+ * @file button.cpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Implementation of button.h.
+ *
+ * The edges of the buttons are captured by pin change interrupts. The first edge that changes
+ * the state of a button is accepted and timestamped, the following edges are ignored for
+ * BUTTON_DEBOUNCE_MS. BUTTON_Poll() samples the pins without interrupt capability (GPIO16) and
+ * catches a release that happened within the debounce time of a press.
+ *
+ * The events are passed in a single consumer ring buffer: the interrupts and BUTTON_Poll()
+ * (with interrupts disabled) push, the loop pops without locking.
+ ***************************************************************************************************
+ */
+
+#include "button.h"
+
+#include <Arduino.h>
+
+#include "BeleptetoRendszer_Kozponti.h"
+
+/** @brief Compiler barrier, keeps the event write before the publishing of the head index. */
+#define COMPILER_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+/** @brief Pins of the buttons, indexed by the button IDs. */
+static const uint8_t buttonPins[BUTTON_COUNT] = {BUTTON_1_PIN, BUTTON_2_PIN, BUTTON_3_PIN, BUTTON_E_PIN};
+
+/** @brief Debounced state of the buttons. */
+static volatile bool buttonPressed[BUTTON_COUNT];
+
+/** @brief Time of the last accepted edge of the buttons. */
+static volatile uint32_t buttonEdgeMillis[BUTTON_COUNT];
+
+/** @brief Event queue. */
+static button_event_t eventQueue[BUTTON_QUEUE_SIZE];
+
+/** @brief Index of the next event to be written, written by the producers only. */
+static volatile uint8_t eventQueueHead = 0;
+
+/** @brief Index of the next event to be read, written by the consumer only. */
+static volatile uint8_t eventQueueTail = 0;
+
+/** @brief Number of events lost because the queue was full. */
+static volatile uint32_t droppedEvents = 0;
+
+/**
+ * @brief Sample a button and queue an event if its debounced state changed.
+ * @param button ID of the button.
+ * @note Must be called from an interrupt or with interrupts disabled.
+ */
+static void IRAM_ATTR sampleButton(uint8_t button)
+{
+    uint32_t currentMillis = millis();
+    bool pressed = (digitalRead(buttonPins[button]) == BUTTON_PRESSED);
+
+    if (pressed == buttonPressed[button])
+    {
+        return;
+    }
+    if ((currentMillis - buttonEdgeMillis[button]) < BUTTON_DEBOUNCE_MS)
+    {
+        // Bounce, the state is checked again by BUTTON_Poll() after the debounce time
+        return;
+    }
+
+    buttonPressed[button] = pressed;
+    buttonEdgeMillis[button] = currentMillis;
+
+    uint8_t head = eventQueueHead;
+    uint8_t next = (head + 1) & (BUTTON_QUEUE_SIZE - 1);
+    if (next == eventQueueTail)
+    {
+        droppedEvents++;
+        return;
+    }
+
+    eventQueue[head].button = button;
+    eventQueue[head].pressed = pressed;
+    eventQueue[head].timeMillis = currentMillis;
+    COMPILER_BARRIER();
+    eventQueueHead = next;
+}
+
+static void IRAM_ATTR button1Isr(void)
+{
+    sampleButton(BUTTON_ID_1);
+}
+
+static void IRAM_ATTR button2Isr(void)
+{
+    sampleButton(BUTTON_ID_2);
+}
+
+static void IRAM_ATTR button3Isr(void)
+{
+    sampleButton(BUTTON_ID_3);
+}
+
+static void IRAM_ATTR buttonEIsr(void)
+{
+    sampleButton(BUTTON_ID_E);
+}
+
+/** @brief Interrupt handlers of the buttons, indexed by the button IDs. */
+static void (*const buttonIsrs[BUTTON_COUNT])(void) = {button1Isr, button2Isr, button3Isr, buttonEIsr};
+
+/**
+ * @brief Initialize the button pins and interrupts.
+ */
+void BUTTON_Init(void)
+{
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+    {
+        pinMode(buttonPins[i], INPUT);
+        buttonPressed[i] = (digitalRead(buttonPins[i]) == BUTTON_PRESSED);
+        buttonEdgeMillis[i] = millis();
+
+        int interrupt = digitalPinToInterrupt(buttonPins[i]);
+        if (interrupt != NOT_AN_INTERRUPT)
+        {
+            attachInterrupt(interrupt, buttonIsrs[i], CHANGE);
+        }
+    }
+}
+
+/**
+ * @brief Sample the buttons from the loop.
+ * @note Needed for the pins without interrupt capability and to settle bounces, call it in
+ *       every pass.
+ */
+void BUTTON_Poll(void)
+{
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+    {
+        noInterrupts();
+        sampleButton(i);
+        interrupts();
+    }
+}
+
+/**
+ * @brief Get the next button event.
+ * @param event Event to be filled.
+ * @return True if there was an event, false if the queue is empty.
+ */
+bool BUTTON_GetEvent(button_event_t *event)
+{
+    uint8_t tail = eventQueueTail;
+    if (tail == eventQueueHead)
+    {
+        return false;
+    }
+    COMPILER_BARRIER();
+
+    *event = eventQueue[tail];
+    COMPILER_BARRIER();
+    eventQueueTail = (tail + 1) & (BUTTON_QUEUE_SIZE - 1);
+    return true;
+}
+
+/**
+ * @brief Get the debounced state of a button.
+ * @param button ID of the button.
+ * @return True if the button is pressed, false otherwise.
+ */
+bool BUTTON_IsPressed(uint8_t button)
+{
+    if (button >= BUTTON_COUNT)
+    {
+        return false;
+    }
+
+    return buttonPressed[button];
+}
+
+/**
+ * @brief Get the number of events lost because the queue was full.
+ * @return Number of dropped events.
+ */
+uint32_t BUTTON_GetDroppedEvents(void)
+{
+    return droppedEvents;
+}
@@ -0,0 +1,58 @@
+/**
+ ***************************************************************************************************
+ * @file button.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Header file for the interrupt driven button handling.
+ ***************************************************************************************************
+ */
+
+#ifndef BUTTON_H
+#define BUTTON_H
+
+#include <stdint.h>
+
+/**
+ * @defgroup button_ids Button IDs
+ * @brief IDs of the buttons in the events.
+ * @{
+ */
+#define BUTTON_ID_1 0
+#define BUTTON_ID_2 1
+#define BUTTON_ID_3 2
+#define BUTTON_ID_E 3
+#define BUTTON_COUNT 4
+/** @} */
+
+/**
+ * @brief Edges closer than this to the previous accepted edge of a button are bounces.
+ */
+#define BUTTON_DEBOUNCE_MS 20
+
+/**
+ * @brief Size of the event queue, must be a power of 2.
+ */
+#define BUTTON_QUEUE_SIZE 16
+
+/**
+ * @brief A button event.
+ */
+typedef struct _button_event
+{
+    uint8_t button;
+    bool pressed;
+    uint32_t timeMillis;
+} button_event_t;
+
+void BUTTON_Init(void);
+
+void BUTTON_Poll(void);
+
+bool BUTTON_GetEvent(button_event_t *event);
+
+bool BUTTON_IsPressed(uint8_t button);
+
+uint32_t BUTTON_GetDroppedEvents(void);
+
+#endif /* BUTTON_H */
@@ -0,0 +1,194 @@
+/**
+ ***************************************************************************************************
+ * @file capture.cpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Implementation of capture.h.
+ *
+ * The records go through the serial transmit buffer like the replies, so they keep their order
+ * with them. They are unsolicited output: while a dump is being sent they are held back until its
+ * end marker, and do not split its lines. A memory image upload is recorded as 16 KB of hex,
+ * sending it stalls the loop for about 1.5 seconds at 115200 baud, so only record the uploads
+ * when they are needed.
+ ***************************************************************************************************
+ */
+
+#include "capture.h"
+
+#include <Arduino.h>
+
+#include "frame.h"
+#include "serialtx.h"
+
+#if CAPTURE_ENABLED
+
+/** @brief Stores if recording is in progress. */
+static bool capturing = false;
+
+/**
+ * @brief Print the beginning of a record.
+ * @param out The serial output.
+ * @param kind Kind of the event.
+ */
+static void beginRecord(Print &out, char kind)
+{
+    out.print("<Y ");
+    out.print(millis());
+    out.print(' ');
+    out.print(kind);
+}
+
+/**
+ * @brief Print bytes in hex.
+ * @param out The serial output.
+ * @param data The bytes.
+ * @param length Number of bytes.
+ */
+static void printHex(Print &out, const uint8_t *data, int length)
+{
+    static const char digits[] = "0123456789ABCDEF";
+    char buffer[32];
+    int used = 0;
+
+    for (int i = 0; i < length; i++)
+    {
+        buffer[used++] = digits[data[i] >> 4];
+        buffer[used++] = digits[data[i] & 0x0F];
+        if (used == sizeof(buffer))
+        {
+            out.write((const uint8_t *)buffer, used);
+            used = 0;
+        }
+    }
+    out.write((const uint8_t *)buffer, used);
+}
+
+#endif /* CAPTURE_ENABLED */
+
+/**
+ * @brief Start or stop recording.
+ * @param recording True to start, false to stop.
+ * @return True if done, false if the recording is compiled out.
+ */
+bool CAPTURE_SetRecording(bool recording)
+{
+#if CAPTURE_ENABLED
+    capturing = recording;
+    return true;
+#else
+    return false;
+#endif /* CAPTURE_ENABLED */
+}
+
+/**
+ * @brief Check if recording is in progress.
+ * @return True if recording.
+ */
+bool CAPTURE_IsRecording(void)
+{
+#if CAPTURE_ENABLED
+    return capturing;
+#else
+    return false;
+#endif /* CAPTURE_ENABLED */
+}
+
+/**
+ * @brief Record a received text message.
+ * @param message The message, without the markers.
+ */
+void CAPTURE_SerialMessage(const char *message)
+{
+#if CAPTURE_ENABLED
+    if (!capturing)
+    {
+        return;
+    }
+    Print &out = SERIALTX_GetEventPrint();
+    beginRecord(out, 'S');
+    out.print(' ');
+    out.print(message);
+    out.print(">\n");
+#endif /* CAPTURE_ENABLED */
+}
+
+/**
+ * @brief Record a received binary frame.
+ * @param frame The encoded frame, without the delimiters.
+ * @param length Length of the frame, may be more than FRAME_MAX_ENCODED.
+ * @note Only the length of an overlong frame is recorded, its bytes were not kept.
+ */
+void CAPTURE_SerialFrame(const uint8_t *frame, int length)
+{
+#if CAPTURE_ENABLED
+    if (!capturing)
+    {
+        return;
+    }
+    Print &out = SERIALTX_GetEventPrint();
+    if (length > FRAME_MAX_ENCODED)
+    {
+        beginRecord(out, 'O');
+        out.print(' ');
+        out.print(length);
+        out.print(">\n");
+        return;
+    }
+    beginRecord(out, 'F');
+    out.print(' ');
+    printHex(out, frame, length);
+    out.print(">\n");
+#endif /* CAPTURE_ENABLED */
+}
+
+/**
+ * @brief Record a request of a reader.
+ * @param address IP address of the reader.
+ * @param type Type of the request.
+ * @param size Size field of the request.
+ * @param payload The payload after the size, as read by the central.
+ * @param length Length of the payload.
+ */
+void CAPTURE_WifiRequest(uint32_t address, char type, int size, const uint8_t *payload, int length)
+{
+#if CAPTURE_ENABLED
+    if (!capturing)
+    {
+        return;
+    }
+    Print &out = SERIALTX_GetEventPrint();
+    beginRecord(out, 'W');
+    out.print(' ');
+    out.print((unsigned long)address);
+    out.print(' ');
+    out.print(type);
+    out.print(' ');
+    out.print(size);
+    out.print(' ');
+    printHex(out, payload, length);
+    out.print(">\n");
+#endif /* CAPTURE_ENABLED */
+}
+
+/**
+ * @brief Record a button event.
+ * @param button ID of the button.
+ * @param pressed True if pressed, false if released.
+ */
+void CAPTURE_Button(uint8_t button, bool pressed)
+{
+#if CAPTURE_ENABLED
+    if (!capturing)
+    {
+        return;
+    }
+    Print &out = SERIALTX_GetEventPrint();
+    beginRecord(out, 'B');
+    out.print(' ');
+    out.print((int)button);
+    out.print(' ');
+    out.print(pressed ? 1 : 0);
+    out.print(">\n");
+#endif /* CAPTURE_ENABLED */
+}
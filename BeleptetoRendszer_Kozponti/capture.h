@@ -0,0 +1,45 @@
+/**
+ ***************************************************************************************************
+ * @file capture.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Header file for recording the inbound traffic, for replaying it on the host.
+ *
+ * While recording, every inbound event is sent on the serial port as a line:
+ * "<Y MILLIS KIND DATA>", where KIND and DATA are:
+ * - S TEXT: a text message, without the markers
+ * - F HEX: a binary frame, COBS encoded, without the delimiters
+ * - O LENGTH: a binary frame longer than FRAME_MAX_ENCODED, LENGTH is its encoded length
+ * - W IP TYPE SIZE HEX: a WiFi request of a reader, HEX is its payload after the size
+ * - B BUTTON PRESSED: a debounced button event, BUTTON is the button ID
+ * The lines of a serial log can be fed to the replay tool of the host build as they are.
+ ***************************************************************************************************
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+
+/**
+ * @brief Enables the recording. Set to 1 to compile the instrumentation in, then "Y 1" starts and
+ *        "Y 0" stops recording.
+ */
+#ifndef CAPTURE_ENABLED
+#define CAPTURE_ENABLED 0
+#endif /* CAPTURE_ENABLED */
+
+bool CAPTURE_SetRecording(bool recording);
+
+bool CAPTURE_IsRecording(void);
+
+void CAPTURE_SerialMessage(const char *message);
+
+void CAPTURE_SerialFrame(const uint8_t *frame, int length);
+
+void CAPTURE_WifiRequest(uint32_t address, char type, int size, const uint8_t *payload, int length);
+
+void CAPTURE_Button(uint8_t button, bool pressed);
+
+#endif /* CAPTURE_H */
@@ -10,33 +10,45 @@
 
 #include "eeprom.h"
 
-#include "EEPROM_24LC64.h"
+#include <Arduino.h>
 
 /**
- * @brief The lower 3 bits of the EEPROM device address.
+ * @brief The memory the image is stored in.
  */
-#define EEPROM_ADDRESS_LOWER_3_BITS 0b111
+static StorageBackend *backend = nullptr;
 
 /**
- * @brief Object for the EEPROM.
+ * @brief The memory image of the EEPROM.
  */
-EEPROM_24LC64 eeprom(Wire, EEPROM_ADDRESS_LOWER_3_BITS);
+static uint8_t memoryImage[EEPROM_SIZE];
 
 /**
- * @brief The memory image of the EEPROM.
+ * @brief The updated pages of the EEPROM.
  */
-static uint8_t memoryImage[EEPROM_24LC64_SIZE];
+static bool updatedPage[EEPROM_SIZE_IN_PAGES];
 
 /**
- * @brief The updated pages of the EEPROM.
+ * @brief The number of updated pages of the EEPROM.
+ */
+static uint16_t updatedPageCount = 0;
+
+/**
+ * @brief The page where the next incremental commit step starts searching for updated pages.
  */
-static bool updatedPage[EEPROM_24LC64_SIZE_IN_PAGES];
+static uint16_t commitStepPage = 0;
+
+/**
+ * @brief The time of the last page write in milliseconds.
+ */
+static unsigned long lastPageWriteMillis = 0;
 
 /**
  * @brief Initialize the EEPROM.
+ * @param storage The memory the image is stored in, at least EEPROM_SIZE bytes.
  */
-void EEPROM_Init()
+void EEPROM_Init(StorageBackend *storage)
 {
+    backend = storage;
     EEPROM_MemoryImage_Update();
 }
 
@@ -46,7 +58,7 @@ void EEPROM_Init()
  */
 uint16_t EEPROM_GetSize(void)
 {
-    return EEPROM_24LC64_SIZE;
+    return EEPROM_SIZE;
 }
 
 /**
@@ -67,7 +79,7 @@ const uint8_t *EEPROM_GetMemoryImage(void)
  */
 void EEPROM_Write(uint16_t address, const uint8_t *data, uint16_t length)
 {
-    if (address + length > EEPROM_24LC64_SIZE)
+    if (address + length > EEPROM_SIZE)
     {
         // Trying to write outside of the EEPROM
         return;
@@ -81,7 +93,11 @@ void EEPROM_Write(uint16_t address, const uint8_t *data, uint16_t length)
             continue;
         }
         memoryImage[address + i] = data[i];
-        updatedPage[(address + i) / EEPROM_24LC64_PAGE_SIZE] = true;
+        if (!updatedPage[(address + i) / EEPROM_PAGE_SIZE])
+        {
+            updatedPage[(address + i) / EEPROM_PAGE_SIZE] = true;
+            updatedPageCount++;
+        }
     }
 }
 
@@ -94,7 +110,7 @@ void EEPROM_Write(uint16_t address, const uint8_t *data, uint16_t length)
  */
 void EEPROM_Read(uint16_t address, uint8_t *data, uint16_t length)
 {
-    if (address + length > EEPROM_24LC64_SIZE)
+    if (address + length > EEPROM_SIZE)
     {
         // Trying to read outside of the EEPROM
         return;
@@ -112,11 +128,11 @@ void EEPROM_Read(uint16_t address, uint8_t *data, uint16_t length)
 void EEPROM_MemoryImage_Update(void)
 {
     // Read the whole EEPROM in page size chunks
-    for (uint16_t i = 0; i < EEPROM_24LC64_SIZE_IN_PAGES; i++)
+    for (uint16_t i = 0; i < EEPROM_SIZE_IN_PAGES; i++)
     {
-        eeprom.readMultiBytes(i * EEPROM_24LC64_PAGE_SIZE,
-                              &(memoryImage[i * EEPROM_24LC64_PAGE_SIZE]),
-                              EEPROM_24LC64_PAGE_SIZE);
+        backend->read(i * EEPROM_PAGE_SIZE,
+                      &(memoryImage[i * EEPROM_PAGE_SIZE]),
+                      EEPROM_PAGE_SIZE);
     }
 }
 
@@ -129,10 +145,10 @@ void EEPROM_MemoryImage_Commit(void)
     // address. Therefore, it is most efficient to write data in page size chunks.
 
     // Make sure the EEPROM is not busy
-    delay(EEPROM_24LC64_WRITE_DELAY_MS);
+    delay(backend->getWriteDelayMs());
 
     // Write all updated pages to the EEPROM
-    for (uint16_t i = 0; i < EEPROM_24LC64_SIZE_IN_PAGES; i++)
+    for (uint16_t i = 0; i < EEPROM_SIZE_IN_PAGES; i++)
     {
         if (!updatedPage[i])
         {
@@ -140,9 +156,45 @@ void EEPROM_MemoryImage_Commit(void)
             continue;
         }
         updatedPage[i] = false;
-        eeprom.writePage(i * EEPROM_24LC64_PAGE_SIZE,
-                         &(memoryImage[i * EEPROM_24LC64_PAGE_SIZE]),
-                         EEPROM_24LC64_PAGE_SIZE);
-        delay(EEPROM_24LC64_WRITE_DELAY_MS);
+        backend->write(i * EEPROM_PAGE_SIZE,
+                       &(memoryImage[i * EEPROM_PAGE_SIZE]),
+                       EEPROM_PAGE_SIZE);
+        delay(backend->getWriteDelayMs());
     }
+    updatedPageCount = 0;
+    lastPageWriteMillis = millis();
+}
+
+/**
+ * @brief Commit at most one updated page of the EEPROM memory image.
+ * @return True if all pages are committed, false if there are updated pages left.
+ * @note Non-blocking alternative of EEPROM_MemoryImage_Commit(). A page is only written when the
+ *       write cycle of the previous one has surely finished, so call it frequently.
+ */
+bool EEPROM_MemoryImage_CommitStep(void)
+{
+    if (updatedPageCount == 0)
+    {
+        return true;
+    }
+
+    if ((millis() - lastPageWriteMillis) <= backend->getWriteDelayMs())
+    {
+        // The EEPROM is still busy with the previous write
+        return false;
+    }
+
+    while (!updatedPage[commitStepPage])
+    {
+        commitStepPage = (commitStepPage + 1) % EEPROM_SIZE_IN_PAGES;
+    }
+
+    updatedPage[commitStepPage] = false;
+    updatedPageCount--;
+    backend->write(commitStepPage * EEPROM_PAGE_SIZE,
+                   &(memoryImage[commitStepPage * EEPROM_PAGE_SIZE]),
+                   EEPROM_PAGE_SIZE);
+    lastPageWriteMillis = millis();
+
+    return (updatedPageCount == 0);
 }
@@ -13,12 +13,25 @@
 
 #include <stdint.h>
 
+#include "StorageBackend.hpp"
+
 /**
  * @brief Size of the EEPROM in bytes.
  */
 #define EEPROM_SIZE 8192
 
-void EEPROM_Init(void);
+/**
+ * @brief Size of the chunks the memory image is committed in, the page size of the storage must be
+ *        a multiple of it.
+ */
+#define EEPROM_PAGE_SIZE 32
+
+/**
+ * @brief Number of chunks of the memory image.
+ */
+#define EEPROM_SIZE_IN_PAGES (EEPROM_SIZE / EEPROM_PAGE_SIZE)
+
+void EEPROM_Init(StorageBackend *storage);
 
 uint16_t EEPROM_GetSize(void);
 
@@ -32,4 +45,6 @@ void EEPROM_MemoryImage_Update(void);
 
 void EEPROM_MemoryImage_Commit(void);
 
+bool EEPROM_MemoryImage_CommitStep(void);
+
 #endif /* EEPROM_H */
@@ -0,0 +1,162 @@
+/**
+ ***************************************************************************************************
+ * @file frame.cpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Implementation of frame.h.
+ *
+ * COBS replaces every zero byte with the distance to the next one: the encoded data is a sequence
+ * of blocks, each starting with a code byte N followed by N - 1 data bytes. A block with a code
+ * below 0xFF is followed by a zero in the decoded data (except the last block), so the overhead is
+ * one byte per 254 bytes.
+ ***************************************************************************************************
+ */
+
+#include "frame.h"
+
+/**
+ * @brief Compute the CRC16 of data (CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF).
+ * @param data Data.
+ * @param length Length of the data.
+ * @return CRC of the data.
+ */
+uint16_t FRAME_Crc16(const uint8_t *data, uint16_t length)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+/**
+ * @brief Append the CRC to a payload and COBS encode it.
+ * @param payload Payload, at most FRAME_MAX_PAYLOAD bytes.
+ * @param length Length of the payload.
+ * @param frame Buffer of the encoded frame, at least FRAME_MAX_ENCODED bytes.
+ * @return Length of the encoded frame, 0 if the payload is too long.
+ */
+uint16_t FRAME_Encode(const uint8_t *payload, uint16_t length, uint8_t *frame)
+{
+    if (length > FRAME_MAX_PAYLOAD)
+    {
+        return 0;
+    }
+
+    uint16_t crc = FRAME_Crc16(payload, length);
+    uint16_t codeIndex = 0;
+    uint16_t frameIndex = 1;
+    uint8_t code = 1;
+
+    for (uint16_t i = 0; i < length + 2; i++)
+    {
+        uint8_t c;
+        if (i < length)
+        {
+            c = payload[i];
+        }
+        else
+        {
+            c = (i == length) ? (crc >> 8) : (crc & 0xFF);
+        }
+
+        if (c == 0)
+        {
+            frame[codeIndex] = code;
+            codeIndex = frameIndex++;
+            code = 1;
+        }
+        else
+        {
+            frame[frameIndex++] = c;
+            code++;
+            if (code == 0xFF)
+            {
+                frame[codeIndex] = code;
+                codeIndex = frameIndex++;
+                code = 1;
+            }
+        }
+    }
+    frame[codeIndex] = code;
+
+    return frameIndex;
+}
+
+/**
+ * @brief Decode a COBS encoded frame and check its CRC.
+ * @param frame Encoded frame without the delimiters.
+ * @param length Length of the encoded frame.
+ * @param payload Buffer of the payload, at least length bytes.
+ * @return Length of the payload without the CRC, or a negative error code (see frame_errors).
+ */
+int FRAME_Decode(const uint8_t *frame, uint16_t length, uint8_t *payload)
+{
+    uint16_t frameIndex = 0;
+    uint16_t payloadIndex = 0;
+
+    while (frameIndex < length)
+    {
+        uint8_t code = frame[frameIndex++];
+        if ((code == 0) || (frameIndex + code - 1 > length))
+        {
+            return FRAME_ERROR_COBS;
+        }
+
+        for (uint8_t i = 1; i < code; i++)
+        {
+            if (frame[frameIndex] == 0)
+            {
+                return FRAME_ERROR_COBS;
+            }
+            payload[payloadIndex++] = frame[frameIndex++];
+        }
+
+        if ((code < 0xFF) && (frameIndex < length))
+        {
+            payload[payloadIndex++] = 0;
+        }
+    }
+
+    if (payloadIndex < 2)
+    {
+        return FRAME_ERROR_CRC;
+    }
+
+    payloadIndex -= 2;
+    uint16_t crc = ((uint16_t)payload[payloadIndex] << 8) | payload[payloadIndex + 1];
+    if (crc != FRAME_Crc16(payload, payloadIndex))
+    {
+        return FRAME_ERROR_CRC;
+    }
+
+    return payloadIndex;
+}
+
+/**
+ * @brief Send a payload in a frame.
+ * @param out Output stream.
+ * @param payload Payload, at most FRAME_MAX_PAYLOAD bytes.
+ * @param length Length of the payload.
+ */
+void FRAME_Send(Print &out, const uint8_t *payload, uint16_t length)
+{
+    uint8_t frame[FRAME_MAX_ENCODED];
+    uint16_t frameLength = FRAME_Encode(payload, length, frame);
+    if (frameLength == 0)
+    {
+        return;
+    }
+
+    out.write((uint8_t)FRAME_DELIMITER);
+    out.write(frame, frameLength);
+    out.write((uint8_t)FRAME_DELIMITER);
+}
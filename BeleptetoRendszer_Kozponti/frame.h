@@ -0,0 +1,53 @@
+/**
+ ***************************************************************************************************
+ * @file frame.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Header file for the binary frames of the serial protocol.
+ *
+ * A frame is the payload followed by its CRC16 (big endian), COBS encoded, between two delimiter
+ * bytes. The encoded frame has no delimiter byte inside, so the receiver can always find the start
+ * of the next frame after an error.
+ ***************************************************************************************************
+ */
+
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+#include <Print.h>
+
+/**
+ * @brief Delimiter of the frames.
+ */
+#define FRAME_DELIMITER 0x00
+
+/**
+ * @brief Maximum size of the payload of a frame.
+ */
+#define FRAME_MAX_PAYLOAD 250
+
+/**
+ * @brief Maximum size of an encoded frame without the delimiters (payload + CRC + COBS overhead).
+ */
+#define FRAME_MAX_ENCODED (FRAME_MAX_PAYLOAD + 2 + 2)
+
+/**
+ * @defgroup frame_errors Frame decoding errors
+ * @brief Return values of FRAME_Decode() on error.
+ * @{
+ */
+#define FRAME_ERROR_COBS -1
+#define FRAME_ERROR_CRC -2
+/** @} */
+
+uint16_t FRAME_Crc16(const uint8_t *data, uint16_t length);
+
+uint16_t FRAME_Encode(const uint8_t *payload, uint16_t length, uint8_t *frame);
+
+int FRAME_Decode(const uint8_t *frame, uint16_t length, uint8_t *payload);
+
+void FRAME_Send(Print &out, const uint8_t *payload, uint16_t length);
+
+#endif /* FRAME_H */
@@ -0,0 +1,280 @@
+/**
+ ***************************************************************************************************
+ * @file logpack.cpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Implementation of logpack.h.
+ *
+ * Most logs are of known UIDs and follow the previous log within minutes, so they take 24 bits
+ * instead of the 120 bits of the legacy record. The references are only valid with the auth list
+ * they were made with, the list and the logs are saved in the same EEPROM image, and the hash of
+ * the list in the header catches a list that was changed by a partly written image.
+ ***************************************************************************************************
+ */
+
+#include "logpack.h"
+
+/**
+ * @brief Bits of the time classes.
+ */
+static const uint8_t timeClassBits[4] = {6, 12, 20, 32};
+
+/**
+ * @brief A bit stream in a buffer.
+ */
+typedef struct _bit_stream
+{
+    uint8_t *data;     /**< Buffer of the stream */
+    uint16_t position; /**< Position of the next bit */
+    uint16_t capacity; /**< Size of the buffer in bits */
+    bool overrun;      /**< Set if a read ran past the end */
+} bit_stream_t;
+
+/**
+ * @brief Write bits into a stream, MSB first.
+ * @param stream The stream, must have space for the bits.
+ * @param value Value to write.
+ * @param bits Number of bits, at most 32.
+ */
+static void writeBits(bit_stream_t *stream, uint32_t value, uint8_t bits)
+{
+    while (bits > 0)
+    {
+        bits--;
+        uint8_t mask = 0x80 >> (stream->position & 7);
+        if ((value >> bits) & 1)
+        {
+            stream->data[stream->position >> 3] |= mask;
+        }
+        else
+        {
+            stream->data[stream->position >> 3] &= ~mask;
+        }
+        stream->position++;
+    }
+}
+
+/**
+ * @brief Read bits from a stream, MSB first.
+ * @param stream The stream, overrun is set if it has fewer bits left.
+ * @param bits Number of bits, at most 32.
+ * @return The value read, 0 on overrun.
+ */
+static uint32_t readBits(bit_stream_t *stream, uint8_t bits)
+{
+    if (stream->position + bits > stream->capacity)
+    {
+        stream->overrun = true;
+        return 0;
+    }
+
+    uint32_t value = 0;
+    while (bits > 0)
+    {
+        bits--;
+        value = (value << 1) | ((stream->data[stream->position >> 3] >> (7 - (stream->position & 7))) & 1);
+        stream->position++;
+    }
+    return value;
+}
+
+/**
+ * @brief Write a log into a block.
+ * @param stream Bit stream of the block.
+ * @param log The log.
+ * @param authList The auth list the references point into.
+ * @param previous Timestamp of the previous log of the block, updated.
+ * @return True if the log was written, false if it did not fit (nothing was written).
+ */
+static bool writeLog(bit_stream_t *stream, const LogData *log, const AuthenticateList *authList, uint32_t *previous)
+{
+    uint32_t time = log->getTimestamp();
+    int ref = authList->findByUid(log->getUid());
+    if (ref > 0xFF)
+    {
+        ref = -1;
+    }
+
+    int32_t delta = (int32_t)(time - *previous);
+    uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+    uint8_t timeClass = 0;
+    while ((timeClass < 3) && (zigzag >= (1UL << timeClassBits[timeClass])))
+    {
+        timeClass++;
+    }
+
+    uint16_t bits = 2 + ((ref < 0) ? 80 : 8) + 2 + timeClassBits[timeClass];
+    if (stream->position + bits > stream->capacity)
+    {
+        return false;
+    }
+
+    writeBits(stream, (log->getAuthentication() != 0) ? 1 : 0, 1);
+    if (ref < 0)
+    {
+        writeBits(stream, 1, 1);
+        const uint8_t *uid = log->getUid();
+        for (int i = 0; i < 10; i++)
+        {
+            writeBits(stream, uid[i], 8);
+        }
+    }
+    else
+    {
+        writeBits(stream, 0, 1);
+        writeBits(stream, ref, 8);
+    }
+    writeBits(stream, timeClass, 2);
+    writeBits(stream, (timeClass == 3) ? time : zigzag, timeClassBits[timeClass]);
+
+    *previous = time;
+    return true;
+}
+
+/**
+ * @brief Pack the logs of a list, the oldest first.
+ * @param logList The logs.
+ * @param authList The auth list the UIDs are referenced in, saved with the logs.
+ * @param buffer Buffer of the packed log area.
+ * @param size Size of the buffer.
+ * @param count Number of logs packed, fewer than the size of the list if the buffer is full.
+ * @return Number of bytes used.
+ */
+uint16_t LOGPACK_Encode(const LogList *logList, const AuthenticateList *authList,
+                        uint8_t *buffer, uint16_t size, uint16_t *count)
+{
+    uint16_t encoded = 0;
+    uint16_t length = LOGPACK_HEADER_SIZE;
+
+    while ((encoded < logList->size()) && (size - length >= 2))
+    {
+        // A block is at most 255 bytes, 16 logs with full UIDs and timestamps take 232
+        uint16_t available = size - length - 1;
+        bit_stream_t stream = {&(buffer[length + 1]), 0, (uint16_t)(((available < 0xFF) ? available : 0xFF) * 8), false};
+        uint32_t previous = 0;
+        int blockCount = 0;
+
+        while ((blockCount < LOGPACK_BLOCK_SIZE) && (encoded < logList->size()) &&
+               writeLog(&stream, logList->get(encoded), authList, &previous))
+        {
+            blockCount++;
+            encoded++;
+        }
+        if (blockCount == 0)
+        {
+            break;
+        }
+
+        uint8_t blockLength = (stream.position + 7) / 8;
+        buffer[length] = blockLength;
+        length += 1 + blockLength;
+
+        if (blockCount < LOGPACK_BLOCK_SIZE)
+        {
+            // Only the last block may be short
+            break;
+        }
+    }
+
+    uint32_t authHash = authList->hashUids();
+    buffer[0] = LOGPACK_MAGIC >> 8;
+    buffer[1] = LOGPACK_MAGIC & 0xFF;
+    buffer[2] = encoded >> 8;
+    buffer[3] = encoded & 0xFF;
+    buffer[4] = (length - LOGPACK_HEADER_SIZE) >> 8;
+    buffer[5] = (length - LOGPACK_HEADER_SIZE) & 0xFF;
+    buffer[6] = authHash >> 24;
+    buffer[7] = (authHash >> 16) & 0xFF;
+    buffer[8] = (authHash >> 8) & 0xFF;
+    buffer[9] = authHash & 0xFF;
+
+    *count = encoded;
+    return length;
+}
+
+/**
+ * @brief Unpack the logs of a packed log area and add them to a list.
+ * @param buffer Buffer of the packed log area.
+ * @param size Size of the buffer.
+ * @param authList The auth list saved with the logs.
+ * @param logList The list the logs are added to.
+ * @return Number of logs added, -1 if the buffer is not a packed log area.
+ * @note The logs referencing the auth list are dropped if the list is not the one they were
+ *       packed with. Unpacking stops at the first damaged block.
+ */
+int LOGPACK_Decode(const uint8_t *buffer, uint16_t size, const AuthenticateList *authList, LogList *logList)
+{
+    if ((size < LOGPACK_HEADER_SIZE) || ((((uint16_t)buffer[0] << 8) | buffer[1]) != LOGPACK_MAGIC))
+    {
+        return -1;
+    }
+
+    uint16_t count = ((uint16_t)buffer[2] << 8) | buffer[3];
+    uint16_t end = LOGPACK_HEADER_SIZE + (((uint16_t)buffer[4] << 8) | buffer[5]);
+    uint32_t authHash = ((uint32_t)buffer[6] << 24) | ((uint32_t)buffer[7] << 16) |
+                        ((uint32_t)buffer[8] << 8) | buffer[9];
+    if (end > size)
+    {
+        return -1;
+    }
+
+    bool refsValid = (authHash == authList->hashUids());
+    uint16_t decoded = 0;
+    uint16_t offset = LOGPACK_HEADER_SIZE;
+    int added = 0;
+
+    while ((decoded < count) && (offset < end))
+    {
+        uint8_t blockLength = buffer[offset];
+        if (offset + 1 + blockLength > end)
+        {
+            break;
+        }
+
+        bit_stream_t stream = {(uint8_t *)&(buffer[offset + 1]), 0, (uint16_t)(blockLength * 8), false};
+        uint32_t previous = 0;
+        for (int i = 0; (i < LOGPACK_BLOCK_SIZE) && (decoded < count); i++)
+        {
+            uint8_t auth = readBits(&stream, 1);
+            uint8_t uid[10];
+            int ref = -1;
+            if (readBits(&stream, 1))
+            {
+                for (int j = 0; j < 10; j++)
+                {
+                    uid[j] = readBits(&stream, 8);
+                }
+            }
+            else
+            {
+                ref = readBits(&stream, 8);
+            }
+            uint8_t timeClass = readBits(&stream, 2);
+            uint32_t value = readBits(&stream, timeClassBits[timeClass]);
+            if (stream.overrun)
+            {
+                return added;
+            }
+
+            uint32_t time = (timeClass == 3) ? value : (previous + (uint32_t)((value >> 1) ^ (0 - (value & 1))));
+            previous = time;
+            decoded++;
+
+            if (ref >= 0)
+            {
+                if (!refsValid || (ref >= authList->size()))
+                {
+                    continue;
+                }
+                memcpy(uid, authList->get(ref)->getUid(), 10);
+            }
+            logList->add(uid, time, auth);
+            added++;
+        }
+
+        offset += 1 + blockLength;
+    }
+
+    return added;
+}
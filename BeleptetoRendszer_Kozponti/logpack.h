@@ -0,0 +1,53 @@
+/**
+ ***************************************************************************************************
+ * @file logpack.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Header file for the packed encoding of the logs in the EEPROM.
+ *
+ * Format: MAGIC{2} + COUNT{2} + LENGTH{2} + AUTH_HASH{4} + blocks, big endian. LENGTH is the
+ * number of bytes of the blocks, AUTH_HASH is the hash of the UIDs of the auth list the references
+ * point into. A block holds LOGPACK_BLOCK_SIZE logs (the last one may hold fewer) and is
+ * BLOCK_LENGTH{1} + a bit stream padded to whole bytes. A log in the bit stream, MSB first:
+ * - AUTH{1}: 1 if the authentication was successful
+ * - ESCAPE{1}: 0 if REF{8}, the index of the UID in the auth list, follows, 1 if UID{80} follows
+ * - TIME_CLASS{2} + TIME: 0, 1, 2: the zigzag coded difference from the previous timestamp of the
+ *   block in 6, 12 or 20 bits, 3: the timestamp in 32 bits. The first log of a block is coded as
+ *   the difference from 0.
+ *
+ * The usual traffic packs into 3-7 bytes per log, so the area holds more logs than the RAM list
+ * (LOG_LIST_MAX_SIZE - 1), and the whole list is saved. Only unknown cards with random times need
+ * about as many bytes as the legacy records.
+ ***************************************************************************************************
+ */
+
+#ifndef LOGPACK_H
+#define LOGPACK_H
+
+#include <stdint.h>
+
+#include "AuthenticateList.hpp"
+#include "LogList.hpp"
+
+/**
+ * @brief Marks a packed log area.
+ */
+#define LOGPACK_MAGIC 0x4C50
+
+/**
+ * @brief Size of the header of a packed log area.
+ */
+#define LOGPACK_HEADER_SIZE 10
+
+/**
+ * @brief Number of logs in a block, the timestamps are delta coded within a block.
+ */
+#define LOGPACK_BLOCK_SIZE 16
+
+uint16_t LOGPACK_Encode(const LogList *logList, const AuthenticateList *authList,
+                        uint8_t *buffer, uint16_t size, uint16_t *count);
+
+int LOGPACK_Decode(const uint8_t *buffer, uint16_t size, const AuthenticateList *authList, LogList *logList);
+
+#endif /* LOGPACK_H */
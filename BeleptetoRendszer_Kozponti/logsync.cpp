@@ -0,0 +1,149 @@
+/**
+ ***************************************************************************************************
+ * @file logsync.cpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Implementation of logsync.h.
+ *
+ * A reader numbers its logs and pushes the ones the central has not acknowledged yet. The
+ * central keeps the high-water mark of every reader, the sequence number after the last log it
+ * has, and answers every push with it. The reader drops the logs below the mark, so a push only
+ * carries new logs. If the answer is lost, the reader pushes the same logs again, and the ones
+ * below the mark are skipped here.
+ *
+ * The sequence numbers are only comparable within a boot epoch of the reader, a random number it
+ * picks when it starts numbering its logs. A push with another epoch than the tracked one comes
+ * from a restarted reader, or from another reader that got the IP address, and its sequence
+ * numbers start over: it is taken as it is, and its sequence numbers give the new mark.
+ *
+ * The marks are kept in RAM only. After a restart of the central, or when a reader was replaced
+ * in the table, the first push of the reader is taken as it is.
+ ***************************************************************************************************
+ */
+
+#include "logsync.h"
+
+#include <Arduino.h>
+
+/**
+ * @brief Log push state of one reader module.
+ */
+typedef struct _logsync_reader
+{
+    bool used;
+    uint32_t address;
+    uint32_t epoch;
+    unsigned long lastSeenMillis;
+    uint32_t nextSequence;
+} logsync_reader_t;
+
+/**
+ * @brief The tracked reader modules.
+ */
+static logsync_reader_t readers[LOGSYNC_MAX_READERS];
+
+/**
+ * @brief Find the state of a reader.
+ * @param readerAddress Address of the reader (IP address).
+ * @param create If true, a new entry is created when the reader is not tracked yet.
+ * @return Pointer to the state of the reader, nullptr if not found.
+ * @note If the table is full, the least recently seen reader is replaced.
+ */
+static logsync_reader_t *findReader(uint32_t readerAddress, bool create)
+{
+    logsync_reader_t *unused = nullptr;
+    logsync_reader_t *oldest = nullptr;
+    unsigned long currentMillis = millis();
+
+    for (int i = 0; i < LOGSYNC_MAX_READERS; i++)
+    {
+        logsync_reader_t *reader = &(readers[i]);
+        if (!reader->used)
+        {
+            if (unused == nullptr)
+            {
+                unused = reader;
+            }
+            continue;
+        }
+        if (reader->address == readerAddress)
+        {
+            return reader;
+        }
+        if ((oldest == nullptr) ||
+            ((currentMillis - reader->lastSeenMillis) > (currentMillis - oldest->lastSeenMillis)))
+        {
+            oldest = reader;
+        }
+    }
+
+    if (!create)
+    {
+        return nullptr;
+    }
+
+    logsync_reader_t *reader = (unused != nullptr) ? unused : oldest;
+    memset(reader, 0, sizeof(logsync_reader_t));
+    reader->used = true;
+    reader->address = readerAddress;
+    return reader;
+}
+
+/**
+ * @brief Get the number of logs of a push the central already has.
+ * @param readerAddress Address of the reader (IP address).
+ * @param epoch Boot epoch of the reader, the sequence numbers are counted in it.
+ * @param firstSequence Sequence number of the first log of the push.
+ * @param count Number of logs in the push.
+ * @return Number of logs to skip at the start of the push.
+ * @note A push that starts above the mark is taken, the logs in the gap were lost by the reader.
+ *       A push of a new epoch is taken whole.
+ */
+uint32_t LOGSYNC_GetSkipCount(uint32_t readerAddress, uint32_t epoch, uint32_t firstSequence, uint32_t count)
+{
+    logsync_reader_t *reader = findReader(readerAddress, false);
+    if ((reader == nullptr) || (reader->epoch != epoch))
+    {
+        return 0;
+    }
+
+    // The sequence numbers wrap around
+    int32_t known = (int32_t)(reader->nextSequence - firstSequence);
+    if (known <= 0)
+    {
+        return 0;
+    }
+    return ((uint32_t)known < count) ? (uint32_t)known : count;
+}
+
+/**
+ * @brief Move the high-water mark of a reader after its logs were stored.
+ * @param readerAddress Address of the reader (IP address).
+ * @param epoch Boot epoch of the reader, the sequence numbers are counted in it.
+ * @param nextSequence Sequence number after the last stored log.
+ * @return The high-water mark to answer, it never moves back within an epoch of a tracked reader.
+ */
+uint32_t LOGSYNC_Acknowledge(uint32_t readerAddress, uint32_t epoch, uint32_t nextSequence)
+{
+    logsync_reader_t *reader = findReader(readerAddress, false);
+    if (reader == nullptr)
+    {
+        reader = findReader(readerAddress, true);
+        reader->epoch = epoch;
+        reader->nextSequence = nextSequence;
+    }
+    else if (reader->epoch != epoch)
+    {
+        // The reader numbers its logs again, the old mark means nothing
+        reader->epoch = epoch;
+        reader->nextSequence = nextSequence;
+    }
+    else if ((int32_t)(nextSequence - reader->nextSequence) > 0)
+    {
+        reader->nextSequence = nextSequence;
+    }
+
+    reader->lastSeenMillis = millis();
+    return reader->nextSequence;
+}
@@ -0,0 +1,30 @@
+/**
+ ***************************************************************************************************
+ * @file logsync.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Header file for the tracking of the logs pushed by the reader modules.
+ ***************************************************************************************************
+ */
+
+#ifndef LOGSYNC_H
+#define LOGSYNC_H
+
+#include <stdint.h>
+
+/**
+ * @brief Maximum number of reader modules whose pushed logs are tracked.
+ */
+#define LOGSYNC_MAX_READERS 4
+
+/**
+ * @brief Maximum number of logs in a push, the reader sends more logs in several pushes.
+ */
+#define LOGSYNC_MAX_PUSH_LOGS 256
+
+uint32_t LOGSYNC_GetSkipCount(uint32_t readerAddress, uint32_t epoch, uint32_t firstSequence, uint32_t count);
+
+uint32_t LOGSYNC_Acknowledge(uint32_t readerAddress, uint32_t epoch, uint32_t nextSequence);
+
+#endif /* LOGSYNC_H */
@@ -0,0 +1,251 @@
+/**
+ ***************************************************************************************************
+ * @file profiler.cpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Implementation of profiler.h.
+ *
+ * Every section keeps a log2 histogram of its durations, so recording a sample costs a few
+ * additions and a count-leading-zeros, and the percentiles are estimated from the buckets
+ * (upper bound of the bucket the percentile falls into).
+ ***************************************************************************************************
+ */
+
+#include "profiler.h"
+
+#include <Arduino.h>
+
+#if PROFILER_ENABLED
+
+/**
+ * @brief Statistics of a profiled section.
+ */
+typedef struct _profiler_section
+{
+    const char *name;
+    uint32_t count;
+    uint64_t totalMicros;
+    uint32_t minMicros;
+    uint32_t maxMicros;
+    uint32_t histogram[PROFILER_BUCKET_COUNT];
+} profiler_section_t;
+
+/**
+ * @brief A section run within a loop iteration.
+ */
+typedef struct _profiler_trace_entry
+{
+    uint8_t section;
+    uint32_t offsetMicros;
+    uint32_t elapsedMicros;
+} profiler_trace_entry_t;
+
+/**
+ * @brief Trace of a loop iteration.
+ */
+typedef struct _profiler_trace
+{
+    uint32_t elapsedMicros;
+    uint8_t length;
+    profiler_trace_entry_t entries[PROFILER_MAX_TRACE];
+} profiler_trace_t;
+
+/** @brief The profiled sections, the first one is the whole loop iteration. */
+static profiler_section_t sections[PROFILER_MAX_SECTIONS] = {{"loop", 0, 0, 0, 0, {0}}};
+
+/** @brief Number of sections. */
+static int sectionCount = 1;
+
+/** @brief Start of the current loop iteration. */
+static uint32_t iterationStartMicros = 0;
+
+/** @brief Trace of the current loop iteration. */
+static profiler_trace_t currentTrace;
+
+/** @brief Trace of the slowest loop iteration. */
+static profiler_trace_t worstTrace;
+
+/**
+ * @brief Get the histogram bucket of a duration.
+ * @param elapsedMicros Duration in microseconds.
+ * @return Index of the bucket.
+ */
+static uint8_t bucketOf(uint32_t elapsedMicros)
+{
+    uint8_t bucket = (elapsedMicros == 0) ? 0 : (32 - __builtin_clz(elapsedMicros));
+    return (bucket < PROFILER_BUCKET_COUNT) ? bucket : (PROFILER_BUCKET_COUNT - 1);
+}
+
+/**
+ * @brief Add a sample to the statistics of a section.
+ * @param section Section to update.
+ * @param elapsedMicros Duration in microseconds.
+ */
+static void addSample(profiler_section_t *section, uint32_t elapsedMicros)
+{
+    if ((section->count == 0) || (elapsedMicros < section->minMicros))
+    {
+        section->minMicros = elapsedMicros;
+    }
+    if (elapsedMicros > section->maxMicros)
+    {
+        section->maxMicros = elapsedMicros;
+    }
+    section->count++;
+    section->totalMicros += elapsedMicros;
+    section->histogram[bucketOf(elapsedMicros)]++;
+}
+
+/**
+ * @brief Estimate a percentile of a section from its histogram.
+ * @param section Section to evaluate.
+ * @param percent Percentile, 0-100.
+ * @return Upper bound of the bucket that contains the percentile, clamped to the maximum.
+ */
+static uint32_t percentile(const profiler_section_t *section, uint8_t percent)
+{
+    uint32_t threshold = (uint32_t)(((uint64_t)section->count * percent + 99) / 100);
+    uint32_t cumulative = 0;
+
+    for (uint8_t i = 0; i < PROFILER_BUCKET_COUNT; i++)
+    {
+        cumulative += section->histogram[i];
+        if (cumulative >= threshold)
+        {
+            uint32_t upperBound = (i == 0) ? 0 : ((1UL << i) - 1);
+            return (upperBound < section->maxMicros) ? upperBound : section->maxMicros;
+        }
+    }
+
+    return section->maxMicros;
+}
+
+#endif /* PROFILER_ENABLED */
+
+/**
+ * @brief Add a section to the profiler.
+ * @param name Name of the section.
+ * @return ID of the section, -1 if there is no free slot or the profiler is disabled.
+ */
+int PROFILER_AddSection(const char *name)
+{
+#if PROFILER_ENABLED
+    if (sectionCount >= PROFILER_MAX_SECTIONS)
+    {
+        return -1;
+    }
+
+    sections[sectionCount].name = name;
+    return sectionCount++;
+#else
+    return -1;
+#endif /* PROFILER_ENABLED */
+}
+
+/**
+ * @brief Mark the beginning of a loop iteration.
+ */
+void PROFILER_BeginIteration(void)
+{
+#if PROFILER_ENABLED
+    iterationStartMicros = micros();
+    currentTrace.length = 0;
+#endif /* PROFILER_ENABLED */
+}
+
+/**
+ * @brief Mark the end of a loop iteration.
+ * @note The iteration is kept as the worst one if it was the slowest so far.
+ */
+void PROFILER_EndIteration(void)
+{
+#if PROFILER_ENABLED
+    uint32_t elapsedMicros = micros() - iterationStartMicros;
+    addSample(&(sections[0]), elapsedMicros);
+
+    if (elapsedMicros > worstTrace.elapsedMicros)
+    {
+        currentTrace.elapsedMicros = elapsedMicros;
+        worstTrace = currentTrace;
+    }
+#endif /* PROFILER_ENABLED */
+}
+
+/**
+ * @brief Record the duration of a section.
+ * @param section ID of the section.
+ * @param startMicros Start of the section, micros().
+ * @param elapsedMicros Duration of the section in microseconds.
+ */
+void PROFILER_Record(int section, uint32_t startMicros, uint32_t elapsedMicros)
+{
+#if PROFILER_ENABLED
+    if ((section < 1) || (section >= sectionCount))
+    {
+        return;
+    }
+
+    addSample(&(sections[section]), elapsedMicros);
+
+    if (currentTrace.length < PROFILER_MAX_TRACE)
+    {
+        profiler_trace_entry_t *entry = &(currentTrace.entries[currentTrace.length++]);
+        entry->section = section;
+        entry->offsetMicros = startMicros - iterationStartMicros;
+        entry->elapsedMicros = elapsedMicros;
+    }
+#endif /* PROFILER_ENABLED */
+}
+
+/**
+ * @brief Reset the statistics and the worst iteration trace.
+ */
+void PROFILER_Reset(void)
+{
+#if PROFILER_ENABLED
+    for (int i = 0; i < sectionCount; i++)
+    {
+        const char *name = sections[i].name;
+        memset(&(sections[i]), 0, sizeof(profiler_section_t));
+        sections[i].name = name;
+    }
+    memset(&worstTrace, 0, sizeof(profiler_trace_t));
+#endif /* PROFILER_ENABLED */
+}
+
+/**
+ * @brief Print the statistics and the worst iteration trace.
+ * @param out Output to print to.
+ * @note Format: "SECTION_COUNT\n" + "NAME COUNT MIN AVG P99 MAX\n" for each section +
+ *       "W ELAPSED\n" + "NAME OFFSET ELAPSED\n" for each section of the worst iteration. Times are
+ *       in microseconds. The caller adds the message markers.
+ */
+void PROFILER_Print(Print &out)
+{
+#if PROFILER_ENABLED
+    char buffer[64 + 1];
+
+    sprintf(buffer, "%d\n", sectionCount);
+    out.print(buffer);
+    for (int i = 0; i < sectionCount; i++)
+    {
+        const profiler_section_t *section = &(sections[i]);
+        uint32_t average = (section->count == 0) ? 0 : (uint32_t)(section->totalMicros / section->count);
+        sprintf(buffer, "%s %u %u %u %u %u\n", section->name, section->count, section->minMicros,
+                average, percentile(section, 99), section->maxMicros);
+        out.print(buffer);
+    }
+
+    sprintf(buffer, "W %u\n", worstTrace.elapsedMicros);
+    out.print(buffer);
+    for (uint8_t i = 0; i < worstTrace.length; i++)
+    {
+        const profiler_trace_entry_t *entry = &(worstTrace.entries[i]);
+        sprintf(buffer, "%s %u %u\n", sections[entry->section].name, entry->offsetMicros, entry->elapsedMicros);
+        out.print(buffer);
+    }
+#else
+    out.print("0\n");
+#endif /* PROFILER_ENABLED */
+}
@@ -0,0 +1,52 @@
+/**
+ ***************************************************************************************************
+ * @file profiler.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Header file for the loop time profiler.
+ ***************************************************************************************************
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <Print.h>
+
+/**
+ * @brief Enables the profiler. Set to 0 to compile the instrumentation out.
+ */
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif /* PROFILER_ENABLED */
+
+/**
+ * @brief Maximum number of profiled sections.
+ */
+#define PROFILER_MAX_SECTIONS 16
+
+/**
+ * @brief Number of histogram buckets. Bucket i counts durations below 2^i microseconds, the last
+ *        one everything above.
+ */
+#define PROFILER_BUCKET_COUNT 22
+
+/**
+ * @brief Maximum number of sections kept in the trace of the worst loop iteration.
+ */
+#define PROFILER_MAX_TRACE 16
+
+int PROFILER_AddSection(const char *name);
+
+void PROFILER_BeginIteration(void);
+
+void PROFILER_EndIteration(void);
+
+void PROFILER_Record(int section, uint32_t startMicros, uint32_t elapsedMicros);
+
+void PROFILER_Reset(void);
+
+void PROFILER_Print(Print &out);
+
+#endif /* PROFILER_H */
@@ -5,6 +5,10 @@
  * @date 2023. 05. 08.
  ***************************************************************************************************
  * @brief Implementation of realtime.h.
+ *
+ * The time is carried as whole seconds plus the milliseconds within the second, both advanced
+ * incrementally from millis(). This way reading the time needs no 64-bit division, and
+ * the millisecond time only needs a multiplication.
  ***************************************************************************************************
  */
 
@@ -12,42 +16,204 @@
 
 #include <Arduino.h>
 
-static uint64_t realtimeMillis = 0;
+/** @brief Number of seconds in a day. */
+#define SECONDS_PER_DAY (60UL * 60UL * 24UL)
+
+/** @brief Whole seconds of the time (UNIX time). */
+static uint32_t realtimeSeconds = 0;
+
+/** @brief Milliseconds within the current second, 0-999. */
+static uint32_t realtimeSubMillis = 0;
 
 static bool isRealtimeSet = false;
 
 static unsigned long lastMillis = 0;
 
+/** @brief Number of millis() rollovers, the upper 32 bits of the monotonic time. */
+static uint32_t millisRollovers = 0;
+
+/** @brief Correction still to be slewed into the time in milliseconds. */
+static int32_t slewRemainingMillis = 0;
+
+/** @brief Elapsed milliseconds not yet accounted for by the slewing. */
+static uint32_t slewElapsedMillis = 0;
+
+/**
+ * @brief Advance the time by the milliseconds elapsed since the last call.
+ * @note The unsigned subtraction handles the rollover of millis().
+ */
+static void advance(void)
+{
+    unsigned long currentMillis = millis();
+    uint32_t elapsedMillis = currentMillis - lastMillis;
+    if (currentMillis < lastMillis)
+    {
+        millisRollovers++;
+    }
+    lastMillis = currentMillis;
+
+    if (!isRealtimeSet)
+    {
+        return;
+    }
+
+    if (slewRemainingMillis != 0)
+    {
+        // Correct by at most 1 ms every REALTIME_SLEW_INTERVAL_MS, never run the time backwards
+        slewElapsedMillis += elapsedMillis;
+        uint32_t steps = 0;
+        if (slewElapsedMillis >= REALTIME_SLEW_INTERVAL_MS)
+        {
+            uint32_t slewRemainingAbs = (slewRemainingMillis > 0) ? slewRemainingMillis : -slewRemainingMillis;
+            steps = slewElapsedMillis / REALTIME_SLEW_INTERVAL_MS;
+            if (steps > slewRemainingAbs)
+            {
+                steps = slewRemainingAbs;
+            }
+            if ((slewRemainingMillis < 0) && (steps > elapsedMillis))
+            {
+                // The time can not go back, the rest of the interval is slewed later
+                steps = elapsedMillis;
+            }
+            slewElapsedMillis -= steps * REALTIME_SLEW_INTERVAL_MS;
+        }
+
+        if (slewRemainingMillis > 0)
+        {
+            elapsedMillis += steps;
+            slewRemainingMillis -= steps;
+        }
+        else
+        {
+            elapsedMillis -= steps;
+            slewRemainingMillis += steps;
+        }
+
+        if (slewRemainingMillis == 0)
+        {
+            slewElapsedMillis = 0;
+        }
+    }
+
+    realtimeSubMillis += elapsedMillis;
+    if (realtimeSubMillis >= 2000)
+    {
+        // Only after a long pause, e.g. a blocking EEPROM commit
+        realtimeSeconds += realtimeSubMillis / 1000;
+        realtimeSubMillis %= 1000;
+    }
+    else if (realtimeSubMillis >= 1000)
+    {
+        realtimeSeconds++;
+        realtimeSubMillis -= 1000;
+    }
+}
+
 /**
  * @brief Set the time in seconds.
  * @param time Time in seconds (UNIX time).
+ * @note The time is stepped, a pending slew correction is dropped.
  */
 void REALTIME_Set(uint32_t time)
 {
-    lastMillis = millis();
-    realtimeMillis = (uint64_t)time * 1000;
+    advance();
+
+    realtimeSeconds = time;
+    realtimeSubMillis = 0;
+    slewRemainingMillis = 0;
+    slewElapsedMillis = 0;
 
     isRealtimeSet = true;
 }
 
+/**
+ * @brief Set the time of day, keeping the date.
+ * @param secondsOfDay Seconds since midnight.
+ */
+void REALTIME_SetTimeOfDay(uint32_t secondsOfDay)
+{
+    advance();
+
+    uint32_t date = realtimeSeconds - (realtimeSeconds % SECONDS_PER_DAY);
+    REALTIME_Set(date + (secondsOfDay % SECONDS_PER_DAY));
+}
+
+/**
+ * @brief Correct the time by the given offset.
+ * @param offsetMillis Correction in milliseconds, positive if the clock is behind.
+ * @note Offsets up to REALTIME_SLEW_LIMIT_MS are slewed, larger ones are stepped. If the time is
+ *       not set, the call is ignored.
+ */
+void REALTIME_Adjust(int32_t offsetMillis)
+{
+    if (!isRealtimeSet)
+    {
+        return;
+    }
+
+    advance();
+
+    if ((offsetMillis > REALTIME_SLEW_LIMIT_MS) || (offsetMillis < -REALTIME_SLEW_LIMIT_MS))
+    {
+        int64_t timeMillis = (int64_t)realtimeSeconds * 1000 + realtimeSubMillis + offsetMillis;
+        if (timeMillis < 0)
+        {
+            timeMillis = 0;
+        }
+        realtimeSeconds = (uint32_t)(timeMillis / 1000);
+        realtimeSubMillis = (uint32_t)(timeMillis % 1000);
+        slewRemainingMillis = 0;
+        slewElapsedMillis = 0;
+        return;
+    }
+
+    slewRemainingMillis = offsetMillis;
+    slewElapsedMillis = 0;
+}
+
 /**
  * @brief Get the time in seconds.
  * @return Time in seconds (UNIX time).
  */
 uint32_t REALTIME_Get(void)
 {
+    advance();
+
     if (!isRealtimeSet)
     {
         return 0;
     }
 
-    unsigned long currentMillis = millis();
-    unsigned long elapsedMillis = currentMillis - lastMillis;
-    lastMillis = currentMillis;
+    return realtimeSeconds;
+}
+
+/**
+ * @brief Get the time in milliseconds.
+ * @return Time in milliseconds (UNIX time * 1000).
+ */
+uint64_t REALTIME_GetMillis(void)
+{
+    advance();
+
+    if (!isRealtimeSet)
+    {
+        return 0;
+    }
+
+    return (uint64_t)realtimeSeconds * 1000 + realtimeSubMillis;
+}
 
-    realtimeMillis += elapsedMillis;
+/**
+ * @brief Get the monotonic time in milliseconds.
+ * @return Milliseconds since startup, extended over the rollover of millis().
+ * @note Not affected by setting or adjusting the time. Must be called at least once every
+ *       49 days (any call of this module counts) to detect the rollover.
+ */
+uint64_t REALTIME_GetMonotonicMillis(void)
+{
+    advance();
 
-    return (uint32_t)(realtimeMillis / 1000);
+    return ((uint64_t)millisRollovers << 32) | lastMillis;
 }
 
 /**
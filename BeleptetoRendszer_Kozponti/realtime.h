@@ -13,10 +13,28 @@
 
 #include <stdint.h>
 
+/**
+ * @brief Largest correction in milliseconds that is slewed instead of stepped.
+ */
+#define REALTIME_SLEW_LIMIT_MS 2000
+
+/**
+ * @brief The time is corrected by 1 ms every this many milliseconds while slewing (1%).
+ */
+#define REALTIME_SLEW_INTERVAL_MS 100
+
 void REALTIME_Set(uint32_t time);
 
+void REALTIME_SetTimeOfDay(uint32_t secondsOfDay);
+
+void REALTIME_Adjust(int32_t offsetMillis);
+
 uint32_t REALTIME_Get(void);
 
+uint64_t REALTIME_GetMillis(void);
+
+uint64_t REALTIME_GetMonotonicMillis(void);
+
 bool REALTIME_IsSet(void);
 
 #endif /* REALTIME_H */
@@ -0,0 +1,250 @@
+/**
+ ***************************************************************************************************
+ * @file scheduler.cpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Implementation of scheduler.h.
+ ***************************************************************************************************
+ */
+
+#include "scheduler.h"
+
+#include <Arduino.h>
+
+#include "profiler.h"
+
+/**
+ * @brief State of a task.
+ */
+typedef struct _scheduler_entry
+{
+    const char *name;
+    scheduler_task_t task;
+    uint32_t periodMillis;
+    uint8_t priority;
+    uint32_t budgetMicros;
+    bool oneShot;
+    bool active;
+    unsigned long nextRunMillis;
+    uint8_t deferredPasses;
+    int profilerSection;
+    scheduler_stats_t stats;
+} scheduler_entry_t;
+
+/**
+ * @brief The tasks, ordered by priority.
+ */
+static scheduler_entry_t tasks[SCHEDULER_MAX_TASKS];
+
+/**
+ * @brief Maps the task IDs to the indices of the tasks array.
+ */
+static uint8_t taskIndex[SCHEDULER_MAX_TASKS];
+
+/**
+ * @brief Number of tasks.
+ */
+static int taskCount = 0;
+
+/**
+ * @brief Add a task to the scheduler.
+ * @return ID of the task, -1 if there is no free slot.
+ */
+static int addTask(const char *name, scheduler_task_t task, uint32_t periodMillis, uint32_t delayMillis,
+                   uint8_t priority, uint32_t budgetMicros, bool oneShot)
+{
+    if (taskCount >= SCHEDULER_MAX_TASKS)
+    {
+        return -1;
+    }
+
+    // Insert after the tasks of the same or higher priority to keep the array ordered
+    int position = taskCount;
+    while ((position > 0) && (tasks[position - 1].priority > priority))
+    {
+        tasks[position] = tasks[position - 1];
+        position--;
+    }
+    for (int id = 0; id < taskCount; id++)
+    {
+        if (taskIndex[id] >= position)
+        {
+            taskIndex[id]++;
+        }
+    }
+
+    scheduler_entry_t *entry = &(tasks[position]);
+    memset(entry, 0, sizeof(scheduler_entry_t));
+    entry->name = name;
+    entry->task = task;
+    entry->periodMillis = periodMillis;
+    entry->priority = priority;
+    entry->budgetMicros = budgetMicros;
+    entry->oneShot = oneShot;
+    entry->active = true;
+    entry->nextRunMillis = millis() + delayMillis;
+#if PROFILER_ENABLED
+    entry->profilerSection = PROFILER_AddSection(name);
+#endif /* PROFILER_ENABLED */
+
+    taskIndex[taskCount] = position;
+    return taskCount++;
+}
+
+/**
+ * @brief Add a periodic task.
+ * @param name Name of the task.
+ * @param task Task function.
+ * @param periodMillis Period in milliseconds, 0 to run in every pass.
+ * @param priority Priority of the task, lower value is higher priority.
+ * @param budgetMicros Expected maximum runtime, longer runs are counted as overruns.
+ * @return ID of the task, -1 if there is no free slot.
+ */
+int SCHEDULER_AddPeriodic(const char *name, scheduler_task_t task, uint32_t periodMillis,
+                          uint8_t priority, uint32_t budgetMicros)
+{
+    return addTask(name, task, periodMillis, periodMillis, priority, budgetMicros, false);
+}
+
+/**
+ * @brief Add a one-shot task.
+ * @param name Name of the task.
+ * @param task Task function.
+ * @param delayMillis Delay in milliseconds before the task runs.
+ * @param priority Priority of the task, lower value is higher priority.
+ * @param budgetMicros Expected maximum runtime, longer runs are counted as overruns.
+ * @return ID of the task, -1 if there is no free slot.
+ * @note The task is kept after it ran and can be started again with SCHEDULER_Trigger().
+ */
+int SCHEDULER_AddOneShot(const char *name, scheduler_task_t task, uint32_t delayMillis,
+                         uint8_t priority, uint32_t budgetMicros)
+{
+    return addTask(name, task, 0, delayMillis, priority, budgetMicros, true);
+}
+
+/**
+ * @brief Make a task due in the next pass.
+ * @param taskId ID of the task.
+ */
+void SCHEDULER_Trigger(int taskId)
+{
+    if ((taskId < 0) || (taskId >= taskCount))
+    {
+        return;
+    }
+
+    scheduler_entry_t *entry = &(tasks[taskIndex[taskId]]);
+    entry->active = true;
+    entry->nextRunMillis = millis();
+}
+
+/**
+ * @brief Run the due tasks in priority order.
+ * @note Must be called from loop(). When the pass runs over SCHEDULER_PASS_BUDGET_US, the
+ *       remaining due tasks are deferred, unless they were deferred too many times already.
+ */
+void SCHEDULER_Run(void)
+{
+    unsigned long passStartMicros = micros();
+#if PROFILER_ENABLED
+    PROFILER_BeginIteration();
+#endif /* PROFILER_ENABLED */
+
+    for (int i = 0; i < taskCount; i++)
+    {
+        scheduler_entry_t *entry = &(tasks[i]);
+        unsigned long currentMillis = millis();
+
+        if (!entry->active || ((long)(currentMillis - entry->nextRunMillis) < 0))
+        {
+            continue;
+        }
+
+        if (((micros() - passStartMicros) > SCHEDULER_PASS_BUDGET_US) &&
+            (entry->deferredPasses < SCHEDULER_MAX_DEFERRALS))
+        {
+            entry->deferredPasses++;
+            entry->stats.deferrals++;
+            continue;
+        }
+        entry->deferredPasses = 0;
+
+        if (entry->oneShot)
+        {
+            entry->active = false;
+        }
+        else if ((currentMillis - entry->nextRunMillis) >= entry->periodMillis)
+        {
+            // Fell behind by more than a period, do not try to catch up
+            entry->nextRunMillis = currentMillis + entry->periodMillis;
+        }
+        else
+        {
+            entry->nextRunMillis += entry->periodMillis;
+        }
+
+        unsigned long taskStartMicros = micros();
+        entry->task();
+        uint32_t elapsedMicros = micros() - taskStartMicros;
+
+        entry->stats.runs++;
+        entry->stats.lastMicros = elapsedMicros;
+        if (elapsedMicros > entry->stats.maxMicros)
+        {
+            entry->stats.maxMicros = elapsedMicros;
+        }
+        if (elapsedMicros > entry->budgetMicros)
+        {
+            entry->stats.overruns++;
+        }
+#if PROFILER_ENABLED
+        PROFILER_Record(entry->profilerSection, taskStartMicros, elapsedMicros);
+#endif /* PROFILER_ENABLED */
+    }
+
+#if PROFILER_ENABLED
+    PROFILER_EndIteration();
+#endif /* PROFILER_ENABLED */
+}
+
+/**
+ * @brief Get the number of tasks.
+ * @return Number of tasks, the task IDs are 0 to count - 1.
+ */
+int SCHEDULER_GetTaskCount(void)
+{
+    return taskCount;
+}
+
+/**
+ * @brief Get the name of a task.
+ * @param taskId ID of the task.
+ * @return Name of the task, nullptr if the ID is invalid.
+ */
+const char *SCHEDULER_GetName(int taskId)
+{
+    if ((taskId < 0) || (taskId >= taskCount))
+    {
+        return nullptr;
+    }
+
+    return tasks[taskIndex[taskId]].name;
+}
+
+/**
+ * @brief Get the runtime statistics of a task.
+ * @param taskId ID of the task.
+ * @param stats Statistics to be filled.
+ * @return True if the ID is valid, false otherwise.
+ */
+bool SCHEDULER_GetStats(int taskId, scheduler_stats_t *stats)
+{
+    if ((taskId < 0) || (taskId >= taskCount))
+    {
+        return false;
+    }
+
+    *stats = tasks[taskIndex[taskId]].stats;
+    return true;
+}
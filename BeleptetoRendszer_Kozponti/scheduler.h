@@ -0,0 +1,75 @@
+/**
+ ***************************************************************************************************
+ * @file scheduler.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Header file for the cooperative task scheduler.
+ ***************************************************************************************************
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Maximum number of tasks.
+ */
+#define SCHEDULER_MAX_TASKS 12
+
+/**
+ * @brief Time budget of one scheduler pass in microseconds.
+ * @note When a pass runs over its budget, the remaining due tasks are deferred to the next pass.
+ */
+#define SCHEDULER_PASS_BUDGET_US 20000
+
+/**
+ * @brief A task is run regardless of the pass budget after being deferred this many times.
+ */
+#define SCHEDULER_MAX_DEFERRALS 4
+
+/**
+ * @defgroup scheduler_priorities Scheduler priorities
+ * @brief Priorities of the tasks, lower value is higher priority.
+ * @{
+ */
+#define SCHEDULER_PRIORITY_HIGH 0
+#define SCHEDULER_PRIORITY_NORMAL 1
+#define SCHEDULER_PRIORITY_LOW 2
+/** @} */
+
+/**
+ * @brief Task function.
+ */
+typedef void (*scheduler_task_t)(void);
+
+/**
+ * @brief Runtime statistics of a task.
+ */
+typedef struct _scheduler_stats
+{
+    uint32_t runs;
+    uint32_t overruns;
+    uint32_t deferrals;
+    uint32_t lastMicros;
+    uint32_t maxMicros;
+} scheduler_stats_t;
+
+int SCHEDULER_AddPeriodic(const char *name, scheduler_task_t task, uint32_t periodMillis,
+                          uint8_t priority, uint32_t budgetMicros);
+
+int SCHEDULER_AddOneShot(const char *name, scheduler_task_t task, uint32_t delayMillis,
+                         uint8_t priority, uint32_t budgetMicros);
+
+void SCHEDULER_Trigger(int taskId);
+
+void SCHEDULER_Run(void);
+
+int SCHEDULER_GetTaskCount(void);
+
+const char *SCHEDULER_GetName(int taskId);
+
+bool SCHEDULER_GetStats(int taskId, scheduler_stats_t *stats);
+
+#endif /* SCHEDULER_H */
@@ -0,0 +1,258 @@
+/**
+ ***************************************************************************************************
+ * @file serialtx.cpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Implementation of serialtx.h.
+ *
+ * The data to send is staged in a linear buffer: the records are formatted directly into the free
+ * space after the pending data, and SERIALTX_Flush() passes the pending data to the UART in one
+ * write, as much as its FIFO can take without blocking. The pending data is moved to the start of
+ * the buffer when the free space at the end runs out.
+ *
+ * A dump is sent as a block: its lines are produced over several passes, between its header and
+ * its end marker. The output the host did not ask for (status lines, capture records) goes
+ * through the event print, which holds it back while a block is open and sends it after the
+ * block, so it never lands inside a dump. If the held output does not fit in SERIALTX_HOLD_SIZE,
+ * the rest of the block is sent at once, blocking, as the dumps were sent before the staging.
+ ***************************************************************************************************
+ */
+
+#include "serialtx.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+/** @brief Staging buffer. */
+static uint8_t txBuffer[SERIALTX_BUFFER_SIZE];
+
+/** @brief Start of the pending data. */
+static uint16_t txStart = 0;
+
+/** @brief End of the pending data. */
+static uint16_t txEnd = 0;
+
+/** @brief Produces the lines of the open block, nullptr if no block is open. */
+static void (*blockProducer)(void) = nullptr;
+
+/** @brief Unsolicited output held back during the block. */
+static uint8_t holdBuffer[SERIALTX_HOLD_SIZE];
+
+/** @brief Length of the held output. */
+static uint16_t holdLength = 0;
+
+/**
+ * @brief Send the pending data to the UART, blocking until it takes all of it.
+ */
+static void sendPending(void)
+{
+    Serial.write(&(txBuffer[txStart]), txEnd - txStart);
+    txStart = 0;
+    txEnd = 0;
+}
+
+/**
+ * @brief Print interface of the staging buffer.
+ * @note Blocks until the buffer is sent if the data does not fit, use it for the short replies.
+ */
+class SerialTxPrint : public Print
+{
+public:
+    size_t write(uint8_t c) override
+    {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override
+    {
+        if ((blockProducer == nullptr) && (holdLength > 0))
+        {
+            // The held output goes before the new data
+            uint16_t held = holdLength;
+            holdLength = 0;
+            write(holdBuffer, held);
+        }
+
+        size_t written = 0;
+        while (written < size)
+        {
+            uint16_t length = ((size - written) < SERIALTX_BUFFER_SIZE) ? (size - written) : SERIALTX_BUFFER_SIZE;
+            char *space = SERIALTX_Reserve(length);
+            if (space == nullptr)
+            {
+                // Keep the order of the data, send the pending data first
+                sendPending();
+                continue;
+            }
+            memcpy(space, &(buffer[written]), length);
+            SERIALTX_Commit(length);
+            written += length;
+        }
+        return written;
+    }
+};
+
+/** @brief Print interface object. */
+static SerialTxPrint txPrint;
+
+/**
+ * @brief Print interface of the unsolicited output.
+ * @note Held back while a block is open, see SERIALTX_BeginBlock().
+ */
+class SerialTxEventPrint : public Print
+{
+public:
+    size_t write(uint8_t c) override
+    {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override
+    {
+        if ((blockProducer != nullptr) || (holdLength > 0))
+        {
+            if (size <= (size_t)(SERIALTX_HOLD_SIZE - holdLength))
+            {
+                memcpy(&(holdBuffer[holdLength]), buffer, size);
+                holdLength += size;
+                return size;
+            }
+            // The held output and the new data are sent after the rest of the block
+            SERIALTX_FinishBlock();
+        }
+        return txPrint.write(buffer, size);
+    }
+};
+
+/** @brief Print interface object of the unsolicited output. */
+static SerialTxEventPrint txEventPrint;
+
+/**
+ * @brief Reserve contiguous space in the staging buffer.
+ * @param length Length of the space.
+ * @return Pointer to the space, nullptr if there is not enough free space.
+ * @note The reserved data is sent after SERIALTX_Commit().
+ */
+char *SERIALTX_Reserve(uint16_t length)
+{
+    if ((SERIALTX_BUFFER_SIZE - txEnd) < length)
+    {
+        if (txStart > 0)
+        {
+            memmove(txBuffer, &(txBuffer[txStart]), txEnd - txStart);
+            txEnd -= txStart;
+            txStart = 0;
+        }
+        if ((SERIALTX_BUFFER_SIZE - txEnd) < length)
+        {
+            return nullptr;
+        }
+    }
+
+    return (char *)&(txBuffer[txEnd]);
+}
+
+/**
+ * @brief Queue the data written into the reserved space.
+ * @param length Length of the data, at most the reserved length.
+ */
+void SERIALTX_Commit(uint16_t length)
+{
+    txEnd += length;
+}
+
+/**
+ * @brief Pass the pending data to the UART as far as its FIFO can take it.
+ * @note This function is non-blocking, call it in every pass.
+ */
+void SERIALTX_Flush(void)
+{
+    if ((blockProducer == nullptr) && (holdLength > 0))
+    {
+        // The block is closed, the held output follows it
+        char *space = SERIALTX_Reserve(holdLength);
+        if (space != nullptr)
+        {
+            memcpy(space, holdBuffer, holdLength);
+            SERIALTX_Commit(holdLength);
+            holdLength = 0;
+        }
+    }
+
+    int length = txEnd - txStart;
+    int space = Serial.availableForWrite();
+    if (length > space)
+    {
+        length = space;
+    }
+
+    if (length > 0)
+    {
+        Serial.write(&(txBuffer[txStart]), length);
+        txStart += length;
+    }
+
+    if (txStart == txEnd)
+    {
+        txStart = 0;
+        txEnd = 0;
+    }
+}
+
+/**
+ * @brief Check if all data was passed to the UART.
+ * @return True if the staging buffer and the held output are empty, false otherwise.
+ */
+bool SERIALTX_IsEmpty(void)
+{
+    return (txStart == txEnd) && (holdLength == 0);
+}
+
+/**
+ * @brief Get the Print interface of the staging buffer.
+ * @return Print object, the data printed to it is sent after the data already staged.
+ */
+Print &SERIALTX_GetPrint(void)
+{
+    return txPrint;
+}
+
+/**
+ * @brief Open a block, the unsolicited output is held back until it is closed.
+ * @param produce Formats the next lines of the block into the staging buffer as they fit, and
+ *                closes the block with SERIALTX_EndBlock() after its last line.
+ */
+void SERIALTX_BeginBlock(void (*produce)(void))
+{
+    blockProducer = produce;
+}
+
+/**
+ * @brief Close the block, after its last data was committed.
+ */
+void SERIALTX_EndBlock(void)
+{
+    blockProducer = nullptr;
+}
+
+/**
+ * @brief Send the rest of the open block, blocking until its last line is passed to the UART.
+ */
+void SERIALTX_FinishBlock(void)
+{
+    while (blockProducer != nullptr)
+    {
+        sendPending();
+        blockProducer();
+    }
+}
+
+/**
+ * @brief Get the Print interface of the unsolicited output.
+ * @return Print object, the data printed to it is sent after the open block, if any.
+ */
+Print &SERIALTX_GetEventPrint(void)
+{
+    return txEventPrint;
+}
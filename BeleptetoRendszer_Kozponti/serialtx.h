@@ -0,0 +1,45 @@
+/**
+ ***************************************************************************************************
+ * @file serialtx.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Header file for the buffered serial transmit path.
+ ***************************************************************************************************
+ */
+
+#ifndef SERIALTX_H
+#define SERIALTX_H
+
+#include <stdint.h>
+#include <Print.h>
+
+/**
+ * @brief Size of the transmit staging buffer.
+ */
+#define SERIALTX_BUFFER_SIZE 512
+
+/**
+ * @brief Size of the buffer of the unsolicited output held back while a block is being sent.
+ */
+#define SERIALTX_HOLD_SIZE 512
+
+char *SERIALTX_Reserve(uint16_t length);
+
+void SERIALTX_Commit(uint16_t length);
+
+void SERIALTX_Flush(void);
+
+bool SERIALTX_IsEmpty(void);
+
+Print &SERIALTX_GetPrint(void);
+
+void SERIALTX_BeginBlock(void (*produce)(void));
+
+void SERIALTX_EndBlock(void);
+
+void SERIALTX_FinishBlock(void);
+
+Print &SERIALTX_GetEventPrint(void);
+
+#endif /* SERIALTX_H */
@@ -0,0 +1,275 @@
+/**
+ ***************************************************************************************************
+ * @file timesync.cpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Implementation of timesync.h.
+ *
+ * The exchange follows NTP: the reader sends its transmit time t1, the central answers with t1,
+ * its receive time t2 and its transmit time t3, and the reader notes the arrival time t4.
+ * The reader reports t4 together with its next request, so the central can compute the
+ * round-trip delay and the clock offset of the reader without waiting on the connection:
+ *
+ *     delay  = (t4 - t1) - (t3 - t2)
+ *     offset = ((t2 - t1) + (t3 - t4)) / 2
+ *
+ * The offset is the time of the central minus the time of the reader. Of the last
+ * TIMESYNC_SAMPLE_COUNT samples the one with the smallest delay is used, because it is the
+ * least affected by asymmetric queuing (e.g. an EEPROM commit stalling the central).
+ *
+ * A memory image upload carries all logs of the reader, also the ones it uploaded before. The
+ * current offset is only applied to the logs recorded since the last upload, the older ones get
+ * the offset they got when they were first taken, so a log keeps its timestamp when the offset is
+ * corrected between two uploads. The offsets are kept as segments of the reader time, the logs up
+ * to the end of a segment got its offset. Only TIMESYNC_LOG_SEGMENTS of them are kept, the oldest
+ * segment covers the logs before it too. The segments are lost with the state of the reader.
+ ***************************************************************************************************
+ */
+
+#include "timesync.h"
+
+#include <Arduino.h>
+
+/**
+ * @brief Clock synchronisation state of one reader module.
+ */
+typedef struct _timesync_reader
+{
+    bool used;
+    uint32_t address;
+    unsigned long lastSeenMillis;
+
+    bool pending;
+    int64_t pendingT1;
+    int64_t pendingT2;
+    int64_t pendingT3;
+
+    uint8_t sampleCount;
+    uint8_t nextSample;
+    int32_t offsetMillis[TIMESYNC_SAMPLE_COUNT];
+    uint32_t delayMillis[TIMESYNC_SAMPLE_COUNT];
+
+    uint8_t segmentCount;
+    uint32_t segmentUntil[TIMESYNC_LOG_SEGMENTS];
+    int32_t segmentOffset[TIMESYNC_LOG_SEGMENTS];
+} timesync_reader_t;
+
+/**
+ * @brief The tracked reader modules.
+ */
+static timesync_reader_t readers[TIMESYNC_MAX_READERS];
+
+/**
+ * @brief Find the state of a reader.
+ * @param readerAddress Address of the reader (IP address).
+ * @param create If true, a new entry is created when the reader is not tracked yet.
+ * @return Pointer to the state of the reader, nullptr if not found.
+ * @note If the table is full, the least recently seen reader is replaced.
+ */
+static timesync_reader_t *findReader(uint32_t readerAddress, bool create)
+{
+    timesync_reader_t *unused = nullptr;
+    timesync_reader_t *oldest = nullptr;
+    unsigned long currentMillis = millis();
+
+    for (int i = 0; i < TIMESYNC_MAX_READERS; i++)
+    {
+        timesync_reader_t *reader = &(readers[i]);
+        if (!reader->used)
+        {
+            if (unused == nullptr)
+            {
+                unused = reader;
+            }
+            continue;
+        }
+        if (reader->address == readerAddress)
+        {
+            return reader;
+        }
+        if ((oldest == nullptr) ||
+            ((currentMillis - reader->lastSeenMillis) > (currentMillis - oldest->lastSeenMillis)))
+        {
+            oldest = reader;
+        }
+    }
+
+    if (!create)
+    {
+        return nullptr;
+    }
+
+    timesync_reader_t *reader = (unused != nullptr) ? unused : oldest;
+    memset(reader, 0, sizeof(timesync_reader_t));
+    reader->used = true;
+    reader->address = readerAddress;
+    return reader;
+}
+
+/**
+ * @brief Register the answered half of a synchronisation exchange.
+ * @param readerAddress Address of the reader (IP address).
+ * @param t1 Transmit time of the request in milliseconds, reader clock.
+ * @param t2 Receive time of the request in milliseconds, central clock.
+ * @param t3 Transmit time of the response in milliseconds, central clock.
+ */
+void TIMESYNC_Request(uint32_t readerAddress, int64_t t1, int64_t t2, int64_t t3)
+{
+    timesync_reader_t *reader = findReader(readerAddress, true);
+
+    reader->lastSeenMillis = millis();
+    reader->pending = true;
+    reader->pendingT1 = t1;
+    reader->pendingT2 = t2;
+    reader->pendingT3 = t3;
+}
+
+/**
+ * @brief Complete a previous synchronisation exchange with its arrival time.
+ * @param readerAddress Address of the reader (IP address).
+ * @param t1 Transmit time of the completed request in milliseconds, reader clock.
+ * @param t4 Receive time of the response in milliseconds, reader clock.
+ * @return True if the exchange was known and produced a valid sample, false otherwise.
+ */
+bool TIMESYNC_Complete(uint32_t readerAddress, int64_t t1, int64_t t4)
+{
+    timesync_reader_t *reader = findReader(readerAddress, false);
+    if ((reader == nullptr) || !reader->pending || (reader->pendingT1 != t1))
+    {
+        return false;
+    }
+    reader->pending = false;
+
+    int64_t delay = (t4 - t1) - (reader->pendingT3 - reader->pendingT2);
+    int64_t offset = ((reader->pendingT2 - t1) + (reader->pendingT3 - t4)) / 2;
+
+    if ((delay < 0) || (delay > UINT32_MAX) || (offset > INT32_MAX) || (offset < INT32_MIN))
+    {
+        // Reader clock stepped during the exchange
+        return false;
+    }
+
+    reader->offsetMillis[reader->nextSample] = (int32_t)offset;
+    reader->delayMillis[reader->nextSample] = (uint32_t)delay;
+    reader->nextSample = (reader->nextSample + 1) % TIMESYNC_SAMPLE_COUNT;
+    if (reader->sampleCount < TIMESYNC_SAMPLE_COUNT)
+    {
+        reader->sampleCount++;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the clock offset of a reader.
+ * @param readerAddress Address of the reader (IP address).
+ * @param offsetMillis Offset in milliseconds (central time minus reader time).
+ * @param delayMillis Round-trip delay of the sample the offset was taken from.
+ * @return True if the offset is known, false otherwise.
+ */
+bool TIMESYNC_GetOffset(uint32_t readerAddress, int32_t *offsetMillis, uint32_t *delayMillis)
+{
+    timesync_reader_t *reader = findReader(readerAddress, false);
+    if ((reader == nullptr) || (reader->sampleCount == 0))
+    {
+        return false;
+    }
+
+    uint8_t best = 0;
+    for (uint8_t i = 1; i < reader->sampleCount; i++)
+    {
+        if (reader->delayMillis[i] < reader->delayMillis[best])
+        {
+            best = i;
+        }
+    }
+
+    *offsetMillis = reader->offsetMillis[best];
+    *delayMillis = reader->delayMillis[best];
+    return true;
+}
+
+/**
+ * @brief Get the clock offset of a reader rounded to seconds.
+ * @param readerAddress Address of the reader (IP address).
+ * @return Offset in seconds (central time minus reader time), 0 if unknown.
+ * @note Used to correct the timestamps of the logs uploaded by the reader.
+ */
+int32_t TIMESYNC_GetOffsetSeconds(uint32_t readerAddress)
+{
+    int32_t offsetMillis;
+    uint32_t delayMillis;
+    if (!TIMESYNC_GetOffset(readerAddress, &offsetMillis, &delayMillis))
+    {
+        return 0;
+    }
+
+    if (offsetMillis >= 0)
+    {
+        return (offsetMillis + 500) / 1000;
+    }
+    return -((-offsetMillis + 500) / 1000);
+}
+
+/**
+ * @brief Get the offset to add to the timestamp of a log uploaded by a reader.
+ * @param readerAddress Address of the reader (IP address).
+ * @param logTime Timestamp of the log, reader clock.
+ * @return Offset in seconds: the one the log got at its first upload, the current offset for a
+ *         new log, 0 if unknown.
+ */
+int32_t TIMESYNC_GetLogOffsetSeconds(uint32_t readerAddress, uint32_t logTime)
+{
+    timesync_reader_t *reader = findReader(readerAddress, false);
+    if (reader == nullptr)
+    {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < reader->segmentCount; i++)
+    {
+        if (logTime <= reader->segmentUntil[i])
+        {
+            return reader->segmentOffset[i];
+        }
+    }
+    return TIMESYNC_GetOffsetSeconds(readerAddress);
+}
+
+/**
+ * @brief Note that the logs of a reader were taken up to a timestamp.
+ * @param readerAddress Address of the reader (IP address).
+ * @param newestLogTime Timestamp of the newest taken log, reader clock.
+ * @note The logs up to it keep the current offset. Nothing is noted for a reader without a
+ *       synchronisation state, its logs got no offset.
+ */
+void TIMESYNC_LogsTaken(uint32_t readerAddress, uint32_t newestLogTime)
+{
+    timesync_reader_t *reader = findReader(readerAddress, false);
+    if ((reader == nullptr) ||
+        ((reader->segmentCount > 0) && (newestLogTime <= reader->segmentUntil[reader->segmentCount - 1])))
+    {
+        return;
+    }
+
+    int32_t offset = TIMESYNC_GetOffsetSeconds(readerAddress);
+    if ((reader->segmentCount > 0) && (reader->segmentOffset[reader->segmentCount - 1] == offset))
+    {
+        reader->segmentUntil[reader->segmentCount - 1] = newestLogTime;
+        return;
+    }
+
+    if (reader->segmentCount == TIMESYNC_LOG_SEGMENTS)
+    {
+        // The oldest segment is merged into the next one
+        memmove(&(reader->segmentUntil[0]), &(reader->segmentUntil[1]),
+                (TIMESYNC_LOG_SEGMENTS - 1) * sizeof(uint32_t));
+        memmove(&(reader->segmentOffset[0]), &(reader->segmentOffset[1]),
+                (TIMESYNC_LOG_SEGMENTS - 1) * sizeof(int32_t));
+        reader->segmentCount--;
+    }
+    reader->segmentUntil[reader->segmentCount] = newestLogTime;
+    reader->segmentOffset[reader->segmentCount] = offset;
+    reader->segmentCount++;
+}
@@ -0,0 +1,44 @@
+/**
+ ***************************************************************************************************
+ * @file timesync.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Header file for the time synchronisation of the reader modules.
+ ***************************************************************************************************
+ */
+
+#ifndef TIMESYNC_H
+#define TIMESYNC_H
+
+#include <stdint.h>
+
+/**
+ * @brief Maximum number of reader modules whose clock offset is tracked.
+ */
+#define TIMESYNC_MAX_READERS 4
+
+/**
+ * @brief Number of exchanges kept per reader for the minimum delay filter.
+ */
+#define TIMESYNC_SAMPLE_COUNT 8
+
+/**
+ * @brief Number of offsets kept per reader for the logs it already uploaded, see
+ *        TIMESYNC_GetLogOffsetSeconds().
+ */
+#define TIMESYNC_LOG_SEGMENTS 4
+
+void TIMESYNC_Request(uint32_t readerAddress, int64_t t1, int64_t t2, int64_t t3);
+
+bool TIMESYNC_Complete(uint32_t readerAddress, int64_t t1, int64_t t4);
+
+bool TIMESYNC_GetOffset(uint32_t readerAddress, int32_t *offsetMillis, uint32_t *delayMillis);
+
+int32_t TIMESYNC_GetOffsetSeconds(uint32_t readerAddress);
+
+int32_t TIMESYNC_GetLogOffsetSeconds(uint32_t readerAddress, uint32_t logTime);
+
+void TIMESYNC_LogsTaken(uint32_t readerAddress, uint32_t newestLogTime);
+
+#endif /* TIMESYNC_H */
@@ -11,8 +11,14 @@
 #include "wifi.h"
 
 #include <Arduino.h>
+#include <string.h>
 #include "eeprom.h"
 #include "realtime.h"
+#include "timesync.h"
+#include "serialtx.h"
+#include "authstore.h"
+#include "capture.h"
+#include "logsync.h"
 
 #include "DataListManager.hpp"
 
@@ -55,7 +61,10 @@ WiFiServer server(80);
 
 void sendMemory(WiFiClient &client, int size);
 void sendTime(WiFiClient &client, int size);
+void sendTimeSync(WiFiClient &client, int size, uint64_t receiveMillis);
 void receiveMemory(WiFiClient &client, int size);
+void sendUserLookup(WiFiClient &client, int size);
+void receiveEvents(WiFiClient &client, int size);
 void processRemoteData(WiFiClient &client);
 
 /**
@@ -108,23 +117,23 @@ void sendMemory(WiFiClient &client, int size)
         return;
     }
 
-    Serial.println("Start sending memory image...");
+    SERIALTX_GetEventPrint().println("Start sending memory image...");
 
     const uint8_t *data = EEPROM_GetMemoryImage();
     size_t s = client.write(data, size);
-    Serial.println(s);
+    SERIALTX_GetEventPrint().println(s);
     if (s != size)
     {
-        Serial.println("Error sending memory image.");
+        SERIALTX_GetEventPrint().println("Error sending memory image.");
         return;
     }
 
-    Serial.println("Memory image sent.");
+    SERIALTX_GetEventPrint().println("Memory image sent.");
 }
 
 void sendTime(WiFiClient &client, int size)
 {
-    Serial.println("Start sending time...");
+    SERIALTX_GetEventPrint().println("Start sending time...");
     if (!REALTIME_IsSet())
     {
         client.print("0\n");
@@ -134,7 +143,115 @@ void sendTime(WiFiClient &client, int size)
         client.print(REALTIME_Get());
         client.print('\n');
     }
-    Serial.println("Time sent.");
+    SERIALTX_GetEventPrint().println("Time sent.");
+}
+
+/**
+ * @brief Read an unsigned decimal number of up to 64 bits from the client.
+ * @param client The client to read from.
+ * @return The number read, 0 if there was no number.
+ * @note Leading non-digit characters are skipped, the terminating character is consumed.
+ */
+static uint64_t readUint64(WiFiClient &client)
+{
+    uint64_t value = 0;
+    int c = client.read();
+    while ((c != -1) && ((c < '0') || (c > '9')))
+    {
+        c = client.read();
+    }
+    while ((c >= '0') && (c <= '9'))
+    {
+        value = value * 10 + (c - '0');
+        c = client.read();
+    }
+    return value;
+}
+
+/**
+ * @brief Format an unsigned decimal number of up to 64 bits.
+ * @param value The number to format.
+ * @param buffer Buffer of at least 21 characters.
+ * @return The number, at the end of the buffer.
+ */
+static const char *formatUint64(uint64_t value, char *buffer)
+{
+    int i = 20;
+    buffer[i] = '\0';
+    do
+    {
+        buffer[--i] = '0' + (value % 10);
+        value /= 10;
+    } while (value > 0);
+    return &(buffer[i]);
+}
+
+/**
+ * @brief Print an unsigned decimal number of up to 64 bits to the client.
+ * @param client The client to print to.
+ * @param value The number to print.
+ */
+static void printUint64(WiFiClient &client, uint64_t value)
+{
+    char buffer[20 + 1];
+    client.print(formatUint64(value, buffer));
+}
+
+/**
+ * @brief Answer a time synchronisation request of a reader.
+ * @param client The client to use for communication.
+ * @param size Number of timestamps in the request: 1 (t1) or 3 (t1, previous t1, previous t4).
+ * @param receiveMillis Time of the central in milliseconds when the request was received (t2).
+ * @note Request: "S <size> <t1> [<previous t1> <previous t4>]", response: "<t1> <t2> <t3>\n".
+ *       All timestamps are UNIX time in milliseconds. The reader computes its own offset from
+ *       the response, and reports the arrival time t4 with its next request so the central can
+ *       track the offset of the reader as well.
+ */
+void sendTimeSync(WiFiClient &client, int size, uint64_t receiveMillis)
+{
+    uint32_t readerAddress = client.remoteIP();
+
+    uint64_t t1 = readUint64(client);
+    uint64_t previousT1 = 0;
+    uint64_t previousT4 = 0;
+    if (size >= 3)
+    {
+        previousT1 = readUint64(client);
+        previousT4 = readUint64(client);
+        TIMESYNC_Complete(readerAddress, previousT1, previousT4);
+    }
+
+    if (CAPTURE_IsRecording())
+    {
+        char payload[3 * (20 + 1)] = "";
+        char buffer[20 + 1];
+        strcat(payload, formatUint64(t1, buffer));
+        if (size >= 3)
+        {
+            strcat(payload, " ");
+            strcat(payload, formatUint64(previousT1, buffer));
+            strcat(payload, " ");
+            strcat(payload, formatUint64(previousT4, buffer));
+        }
+        CAPTURE_WifiRequest(readerAddress, 'S', size, (const uint8_t *)payload, strlen(payload));
+    }
+
+    if (!REALTIME_IsSet())
+    {
+        client.print("0\n");
+        return;
+    }
+
+    uint64_t transmitMillis = REALTIME_GetMillis();
+
+    printUint64(client, t1);
+    client.print(' ');
+    printUint64(client, receiveMillis);
+    client.print(' ');
+    printUint64(client, transmitMillis);
+    client.print('\n');
+
+    TIMESYNC_Request(readerAddress, t1, receiveMillis, transmitMillis);
 }
 
 void receiveMemory(WiFiClient &client, int size)
@@ -144,7 +261,7 @@ void receiveMemory(WiFiClient &client, int size)
         return;
     }
 
-    Serial.println("Start receiving memory image...");
+    SERIALTX_GetEventPrint().println("Start receiving memory image...");
 
     size_t i = 0;
     while (size > i)
@@ -154,15 +271,99 @@ void receiveMemory(WiFiClient &client, int size)
     }
     if (i != size)
     {
-        Serial.println("Error receiving memory image.");
+        SERIALTX_GetEventPrint().println("Error receiving memory image.");
         return;
     }
+    CAPTURE_WifiRequest(client.remoteIP(), 'M', size, memoryImageReceived, i);
 
-    Serial.println("Memory image received.");
+    SERIALTX_GetEventPrint().println("Memory image received.");
 
-    dataListManager.extractListFromEepromImage(memoryImageReceived, i);
+    // Logs are stamped with the clock of the reader, they are shifted onto the clock of the central
+    dataListManager.extractListFromEepromImage(memoryImageReceived, i, client.remoteIP());
 
-    Serial.println("Memory image processed.");
+    SERIALTX_GetEventPrint().println("Memory image processed.");
+}
+
+/**
+ * @brief Answer a user lookup of a reader, for the tags not in its own list.
+ * @param client The client to use for communication.
+ * @param size Size of the UID, 10.
+ * @note Request: "U 10 <UID{10}>", response: "1 <interval start> <interval end>\n" if the user is
+ *       in the user store, "0\n" otherwise.
+ */
+void sendUserLookup(WiFiClient &client, int size)
+{
+    uint8_t uid[10];
+    auth_store_record_t record;
+
+    if ((size != sizeof(uid)) || (client.readBytes(uid, sizeof(uid)) != sizeof(uid)))
+    {
+        client.print("0\n");
+        return;
+    }
+    CAPTURE_WifiRequest(client.remoteIP(), 'U', size, uid, sizeof(uid));
+
+    if (!AUTHSTORE_Find(uid, &record))
+    {
+        client.print("0\n");
+        return;
+    }
+
+    client.print("1 ");
+    client.print(record.intervalStart);
+    client.print(' ');
+    client.print(record.intervalEnd);
+    client.print('\n');
+}
+
+/**
+ * @brief Append the new logs pushed by a reader, instead of taking its whole memory image.
+ * @param client The client to use for communication.
+ * @param size Number of logs in the request, at most LOGSYNC_MAX_PUSH_LOGS.
+ * @note Request: "E <count> <epoch> <first sequence> <logs{15 * count}>", response:
+ *       "<next sequence>\n". The logs are in the legacy format of the memory images and are
+ *       numbered by the reader from the first sequence. The epoch is a random number the reader
+ *       picks when it starts numbering, see logsync.cpp. The response is the high-water mark of
+ *       the reader: the reader drops its logs below it and pushes from it next time. The logs the
+ *       central already has are skipped, so a push can be repeated when its response was lost.
+ *       If the log list gets full, the mark stops at the first log that was not stored.
+ */
+void receiveEvents(WiFiClient &client, int size)
+{
+    uint32_t readerAddress = client.remoteIP();
+    uint32_t epoch = (uint32_t)readUint64(client);
+    uint32_t firstSequence = (uint32_t)readUint64(client);
+
+    // The epoch and the sequence number are kept in front of the logs for the capture, the
+    // request as read
+    char prefix[2 * (20 + 1) + 1] = "";
+    char buffer[20 + 1];
+    strcat(prefix, formatUint64(epoch, buffer));
+    strcat(prefix, " ");
+    strcat(prefix, formatUint64(firstSequence, buffer));
+    strcat(prefix, " ");
+    size_t prefixLength = strlen(prefix);
+    memcpy(memoryImageReceived, prefix, prefixLength);
+    uint8_t *logs = &(memoryImageReceived[prefixLength]);
+
+    uint16_t received = 0;
+    if ((size > 0) && (size <= LOGSYNC_MAX_PUSH_LOGS))
+    {
+        size_t length = client.readBytes(logs, size * DataListManager::LEGACY_LOG_SIZE);
+        received = length / DataListManager::LEGACY_LOG_SIZE;
+    }
+    CAPTURE_WifiRequest(readerAddress, 'E', size, memoryImageReceived,
+                        prefixLength + received * DataListManager::LEGACY_LOG_SIZE);
+
+    uint16_t skipped = LOGSYNC_GetSkipCount(readerAddress, epoch, firstSequence, received);
+    const uint8_t *newLogs = &(logs[skipped * DataListManager::LEGACY_LOG_SIZE]);
+    uint16_t stored = dataListManager.addReaderLogs(newLogs, received - skipped,
+                                                    TIMESYNC_GetOffsetSeconds(readerAddress));
+
+    // Only the stored logs are acknowledged, the reader sends the rest again
+    uint32_t nextSequence = firstSequence + skipped + stored;
+    client.print((unsigned long)LOGSYNC_Acknowledge(readerAddress, epoch, nextSequence));
+    client.print('\n');
 }
 
 void processRemoteData(WiFiClient &client)
@@ -180,26 +381,47 @@ void processRemoteData(WiFiClient &client)
         return;
     }
 
+    // Timestamp the request before anything else for the time synchronisation
+    uint64_t receiveMillis = REALTIME_GetMillis();
+
     char type = client.read();
     client.read(); // skip the whitespace
     int size = client.parseInt();
     client.read(); // skip the whitespace
 
+    if ((type != 'S') && (type != 'M') && (type != 'U') && (type != 'E'))
+    {
+        // No payload, the others are recorded after reading it
+        CAPTURE_WifiRequest(client.remoteIP(), type, size, nullptr, 0);
+    }
+
     if (type == 'N')
     {
-        Serial.println("Sending memory image...");
+        SERIALTX_GetEventPrint().println("Sending memory image...");
         sendMemory(client, size);
     }
     else if (type == 'T')
     {
-        Serial.println("Sending time...");
+        SERIALTX_GetEventPrint().println("Sending time...");
         sendTime(client, size);
     }
+    else if (type == 'S')
+    {
+        sendTimeSync(client, size, receiveMillis);
+    }
     else if (type == 'M')
     {
-        Serial.println("Receiving memory image...");
+        SERIALTX_GetEventPrint().println("Receiving memory image...");
         receiveMemory(client, size);
     }
+    else if (type == 'U')
+    {
+        sendUserLookup(client, size);
+    }
+    else if (type == 'E')
+    {
+        receiveEvents(client, size);
+    }
 }
 
 /**
@@ -0,0 +1,164 @@
+/**
+ ***************************************************************************************************
+ * @file MmapStorageBackend.hpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief This file contains the definition of the MmapStorageBackend class.
+ *
+ * Linux only, for running the persistence of the central module on the host. It is kept out of the
+ * sketch folder, because the Arduino IDE compiles every source file there.
+ ***************************************************************************************************
+ */
+
+#pragma once
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "StorageBackend.hpp"
+
+/**
+ * @brief A memory in a file mapped into RAM, so the content survives a restart like in an EEPROM.
+ * @note A new or shorter file is extended with 0xFF bytes, as an erased EEPROM reads. Check
+ *       isOpen() after the construction.
+ */
+class MmapStorageBackend : public StorageBackend
+{
+private:
+    int fd = -1;
+    uint8_t *memory = nullptr;
+    uint32_t size;
+    uint16_t page_size;
+    uint16_t write_delay_ms;
+
+    /**
+     * @brief Number of pages written since the construction.
+     */
+    uint32_t page_writes = 0;
+
+public:
+    /**
+     * @brief Constructor, open or create the file.
+     * @param path Path of the file.
+     * @param size Size of the memory in bytes.
+     * @param page_size Size of a page in bytes.
+     * @param write_delay_ms Simulated duration of the write cycle, 0 for none.
+     */
+    MmapStorageBackend(const char *path, uint32_t size, uint16_t page_size, uint16_t write_delay_ms = 0)
+        : size(size), page_size(page_size), write_delay_ms(write_delay_ms)
+    {
+        fd = open(path, O_RDWR | O_CREAT, 0644);
+        if (fd < 0)
+        {
+            return;
+        }
+
+        struct stat file_stat;
+        if ((fstat(fd, &file_stat) != 0) || (ftruncate(fd, size) != 0))
+        {
+            close();
+            return;
+        }
+
+        void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            close();
+            return;
+        }
+        memory = (uint8_t *)mapping;
+
+        if ((uint32_t)file_stat.st_size < size)
+        {
+            memset(&(memory[file_stat.st_size]), 0xFF, size - file_stat.st_size);
+        }
+    }
+
+    /**
+     * @brief Destructor, flush and close the file.
+     */
+    ~MmapStorageBackend(void) override
+    {
+        close();
+    }
+
+    MmapStorageBackend(const MmapStorageBackend &) = delete;
+    MmapStorageBackend &operator=(const MmapStorageBackend &) = delete;
+
+    /**
+     * @brief Check if the file is mapped.
+     * @return True if the memory is usable.
+     */
+    bool isOpen(void) const
+    {
+        return memory != nullptr;
+    }
+
+    /**
+     * @brief Flush the memory into the file and close it.
+     */
+    void close(void)
+    {
+        if (memory != nullptr)
+        {
+            msync(memory, size, MS_SYNC);
+            munmap(memory, size);
+            memory = nullptr;
+        }
+        if (fd >= 0)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    /**
+     * @brief Get the number of pages written.
+     * @return Number of writes since the construction.
+     */
+    uint32_t getPageWrites(void) const
+    {
+        return page_writes;
+    }
+
+    uint32_t getSize(void) const override
+    {
+        return size;
+    }
+
+    uint16_t getPageSize(void) const override
+    {
+        return page_size;
+    }
+
+    uint16_t getWriteDelayMs(void) const override
+    {
+        return write_delay_ms;
+    }
+
+    uint16_t read(uint32_t address, uint8_t *data, uint16_t length) override
+    {
+        if ((memory == nullptr) || (address + length > size))
+        {
+            return 0;
+        }
+        memcpy(data, &(memory[address]), length);
+        return length;
+    }
+
+    void write(uint32_t address, const uint8_t *data, uint16_t length) override
+    {
+        if ((memory == nullptr) || (length == 0) || (address + length > size) ||
+            (address / page_size != (address + length - 1) / page_size))
+        {
+            return;
+        }
+        memcpy(&(memory[address]), data, length);
+        page_writes++;
+    }
+}; // MmapStorageBackend
@@ -0,0 +1,1595 @@
+/**
+ ***************************************************************************************************
+ * @file bench.cpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Benchmarks of the central module on the host, with the lists at full capacity.
+ *
+ * Two times are reported for each operation: the CPU time on the host, which compares the
+ * algorithms, and the simulated time on the board, which is what the I2C transfers, the EEPROM
+ * write cycles and the UART cost. The runs are deterministic, the simulated times repeat exactly.
+ ***************************************************************************************************
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "authstore.h"
+#include "eeprom.h"
+#include "frame.h"
+#include "logpack.h"
+#include "MmapStorageBackend.hpp"
+#include "sim.h"
+#include "sketch.h"
+
+/**
+ * @brief Number of users of the user store benchmark.
+ */
+#define BENCH_STORE_USERS 1500
+
+/**
+ * @brief Number of measured swipes of a workload of the user store, after as many for warm up.
+ */
+#define BENCH_STORE_SWIPES 20000
+
+/**
+ * @brief Swipes of unknown tags per thousand in the workloads of the user store.
+ */
+#define BENCH_STORE_UNKNOWN_PERMIL 100
+
+/**
+ * @brief Number of users present in the working set workload of the user store.
+ */
+#define BENCH_STORE_PRESENT_USERS 40
+
+/**
+ * @brief Number of users removed and added by the churn check of the user store.
+ */
+#define BENCH_STORE_CHURN 20000
+
+/**
+ * @brief Number of logs and of users of the user store saved by the storage check.
+ */
+#define BENCH_STORAGE_LOGS 300
+#define BENCH_STORAGE_STORE_USERS 300
+
+/**
+ * @brief Number of random unknown UIDs of the UID filter check.
+ */
+#define BENCH_FILTER_PROBES 1000000
+
+/**
+ * @brief Number of random payloads of the frame round trip check.
+ */
+#define BENCH_FRAME_ROUND_TRIPS 200000
+
+/**
+ * @brief Records of the binary update frames, see the sketch.
+ * @{
+ */
+#define BENCH_ADD_RECORD_SIZE 34
+#define BENCH_REMOVE_RECORD_SIZE 10
+#define BENCH_ADDS_PER_FRAME 7
+#define BENCH_REMOVES_PER_FRAME 24
+
+/**
+ * @brief Number of blocks sent by the staging check, with random lines and status lines.
+ */
+#define BENCH_STAGING_ROUNDS 2000
+
+/**
+ * @brief Length of the lines of the blocks of the staging check, a log line is about as long.
+ */
+#define BENCH_STAGING_LINE_SIZE 40
+
+/**
+ * @brief Number of rounds of the log query check, 3 queries are checked in each.
+ */
+#define BENCH_QUERY_ROUNDS 26000
+
+/**
+ * @brief Number of distinct UIDs of the logs of the query check.
+ */
+#define BENCH_QUERY_UIDS 20
+
+/**
+ * @brief Number of random log lists packed and unpacked per scenario of the packing check.
+ */
+#define BENCH_PACK_LISTS 200
+
+/**
+ * @brief Size of the packed log area of the EEPROM, between the log base and the statistics.
+ */
+#define BENCH_LOG_AREA_SIZE (EEPROM_SIZE - EEPROM_SIZE / 2 - AccessStats::STORAGE_SIZE)
+/** @} */
+
+/**
+ * @brief Timer of a benchmark, on the host and in the simulation.
+ */
+typedef struct _bench_timer
+{
+    std::chrono::steady_clock::time_point hostStart;
+    uint64_t simStart;
+} bench_timer_t;
+
+/** @brief State of the pseudo random generator of the test data. */
+static uint32_t randomState = 1;
+
+/**
+ * @brief Get a pseudo random number, the same sequence on every run.
+ * @return The number.
+ */
+static uint32_t nextRandom(void)
+{
+    randomState = randomState * 1103515245UL + 12345UL;
+    return randomState >> 8;
+}
+
+/**
+ * @brief Make the UID of a test user.
+ * @param index Index of the user.
+ * @param uid The UID.
+ */
+static void makeUid(uint32_t index, uint8_t *uid)
+{
+    uint32_t hash = index * 2654435761UL;
+    for (int i = 0; i < 10; i++)
+    {
+        uid[i] = (hash >> ((i % 4) * 8)) ^ (i * 37) ^ (index >> 8);
+    }
+}
+
+/**
+ * @brief Make the add command of a test user.
+ * @param index Index of the user.
+ * @param message The command, without the markers.
+ */
+static void makeAddMessage(uint32_t index, char *message)
+{
+    uint8_t uid[10];
+    makeUid(index, uid);
+    sprintf(message, "A %02X%02X%02X%02X%02X%02X%02X%02X%02X%02X User %-11u %010u %010u",
+            uid[0], uid[1], uid[2], uid[3], uid[4], uid[5], uid[6], uid[7], uid[8], uid[9],
+            (unsigned int)index, (unsigned int)(6 * 3600 + (index % 8) * 1800),
+            (unsigned int)(18 * 3600 + (index % 4) * 3600));
+}
+
+static void startTimer(bench_timer_t *timer)
+{
+    timer->simStart = SIM_GetMicros();
+    timer->hostStart = std::chrono::steady_clock::now();
+}
+
+/**
+ * @brief Print the result of a benchmark.
+ * @param timer Timer started before the operations.
+ * @param name Name of the operation.
+ * @param count Number of operations.
+ */
+static void report(const bench_timer_t *timer, const char *name, uint32_t count)
+{
+    double hostNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - timer->hostStart).count();
+    double simMicros = (double)(SIM_GetMicros() - timer->simStart);
+    printf("%-32s %8u %14.1f %14.1f\n", name, (unsigned int)count, hostNanos / count, simMicros / count);
+}
+
+/**
+ * @brief Run the sketch until the received bytes are processed and the replies are sent.
+ * @note The UART delivers a byte every SIM_UART_BYTE_MICROS, the loop runs every 50 us.
+ */
+static void runUntilIdle(void)
+{
+    do
+    {
+        loop();
+        SIM_Advance(50);
+    } while ((SIM_SerialInputPending() > 0) || (dumpType != 0) || !SERIALTX_IsEmpty());
+    SIM_SerialOutputClear();
+}
+
+/**
+ * @brief Boot on new EEPROMs.
+ */
+static void benchBoot(void)
+{
+    bench_timer_t timer;
+    startTimer(&timer);
+    setup();
+    report(&timer, "boot (new EEPROMs)", 1);
+}
+
+/**
+ * @brief Fill the auth list with a batch update over the UART.
+ */
+static void benchSerialBatch(void)
+{
+    char message[80];
+    std::string input = "<B>";
+    for (int i = 0; i < AUTH_LIST_SIZE - 1; i++)
+    {
+        makeAddMessage(i, message);
+        input += "<";
+        input += message;
+        input += ">";
+    }
+    input += "<E>";
+
+    bench_timer_t timer;
+    startTimer(&timer);
+    SIM_SerialInput(input.c_str(), input.size());
+    runUntilIdle();
+    report(&timer, "serial batch fill, per message", AUTH_LIST_SIZE + 1);
+
+    if (dataListManager.getAuthList()->size() != AUTH_LIST_SIZE - 1)
+    {
+        printf("auth list not full: %d\n", dataListManager.getAuthList()->size());
+        exit(1);
+    }
+}
+
+/**
+ * @brief Look up UIDs in the full auth list.
+ */
+static void benchLookup(void)
+{
+    const uint32_t count = 1000000;
+    const AuthenticateList *authList = dataListManager.getAuthList();
+    uint8_t uid[10];
+    uint32_t found = 0;
+
+    bench_timer_t timer;
+    startTimer(&timer);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        makeUid(i % (AUTH_LIST_SIZE - 1), uid);
+        found += (authList->findByUid(uid) >= 0);
+    }
+    report(&timer, "lookup, known UID", count);
+
+    startTimer(&timer);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        makeUid(AUTH_LIST_SIZE + i, uid);
+        found += (authList->findByUid(uid) >= 0);
+    }
+    report(&timer, "lookup, unknown UID", count);
+
+    if (found < count)
+    {
+        printf("lookup failed: %u\n", (unsigned int)found);
+        exit(1);
+    }
+}
+
+/** @brief Auth list of the removal benchmark, apart from the one of the sketch. */
+static AuthenticateList removeList;
+
+/**
+ * @brief Measure the false positive rate of the UID filter of the full auth list, and remove all
+ *        users of a full list in a batch.
+ */
+static void checkUidFilter(void)
+{
+    BloomFilter<AUTH_LIST_FILTER_BITS, AUTH_LIST_FILTER_HASHES, 10> filter;
+    uint8_t uid[10];
+
+    // The low bits of the generator repeat quickly, the UID bytes are taken from the high ones
+
+    for (int i = 0; i < AUTH_LIST_SIZE; i++)
+    {
+        for (int j = 0; j < 10; j++)
+        {
+            uid[j] = (uint8_t)(nextRandom() >> 16);
+        }
+        filter.add(uid);
+    }
+
+    uint32_t passed = 0;
+    for (uint32_t i = 0; i < BENCH_FILTER_PROBES; i++)
+    {
+        for (int j = 0; j < 10; j++)
+        {
+            uid[j] = (uint8_t)(nextRandom() >> 16);
+        }
+        passed += filter.mayContain(uid);
+    }
+
+    double expected = pow(1.0 - exp(-(double)AUTH_LIST_FILTER_HASHES * AUTH_LIST_SIZE / AUTH_LIST_FILTER_BITS),
+                          AUTH_LIST_FILTER_HASHES);
+    printf("UID filter: %.3f%% of %u unknown UIDs pass at %d entries, %.3f%% expected\n",
+           100.0 * passed / BENCH_FILTER_PROBES, (unsigned int)BENCH_FILTER_PROBES, AUTH_LIST_SIZE,
+           100.0 * expected);
+
+    for (int i = 0; i < AUTH_LIST_SIZE; i++)
+    {
+        makeUid(i, uid);
+        removeList.add(uid, "User", 6 * 3600, 18 * 3600);
+    }
+    bench_timer_t timer;
+    startTimer(&timer);
+    for (int i = 0; i < AUTH_LIST_SIZE; i++)
+    {
+        makeUid(i, uid);
+        removeList.remove(uid);
+    }
+    removeList.refreshUidFilter();
+    report(&timer, "remove, full list in a batch", AUTH_LIST_SIZE);
+}
+
+/**
+ * @brief Replace users of the full auth list with single update commands.
+ */
+static void benchUpsert(void)
+{
+    const uint32_t count = 20000;
+    char message[80];
+
+    bench_timer_t timer;
+    startTimer(&timer);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        makeAddMessage(nextRandom() % (AUTH_LIST_SIZE - 1), message);
+        processMessage(message);
+    }
+    report(&timer, "upsert (A), full list", count);
+    runUntilIdle();
+}
+
+/**
+ * @brief Parse commands that only read the lists.
+ */
+static void benchParse(void)
+{
+    const uint32_t count = 20000;
+    char message[80];
+
+    bench_timer_t timer;
+    startTimer(&timer);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sprintf(message, "#%u K 0", (unsigned int)i);
+        processMessage(message);
+        SERIALTX_Flush();
+        SIM_SerialOutputClear();
+    }
+    report(&timer, "parse (#ID K 0)", count);
+
+    startTimer(&timer);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        processMessage("F 0 4294967295 * 1");
+        // Drop the dump, only the query is measured
+        startDump(0, 0, 0);
+        SERIALTX_Flush();
+        SIM_SerialOutputClear();
+    }
+    report(&timer, "parse + query (F), full log", count);
+}
+
+/**
+ * @brief Add logs to the full log list.
+ */
+static void benchLogAdd(void)
+{
+    const uint32_t count = 200000;
+    uint8_t uid[10];
+    uint32_t time = 1700000000UL;
+
+    bench_timer_t timer;
+    startTimer(&timer);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        makeUid(nextRandom() % AUTH_LIST_SIZE, uid);
+        time += nextRandom() % 120;
+        dataListManager.logList.add(uid, time, (uint8_t)(i % 8 != 0));
+    }
+    report(&timer, "log add, full list", count);
+}
+
+/** @brief Log list of the query check, apart from the one of the sketch. */
+static LogList queryList;
+
+/**
+ * @brief Check a log query against a filter of every log.
+ * @param query Filter of the query.
+ */
+static void checkQuery(const log_query_t *query)
+{
+    static uint16_t results[LOG_LIST_MAX_SIZE];
+    int count = queryList.query(query, results, LOG_LIST_MAX_SIZE);
+
+    std::vector<bool> expected(queryList.size(), false);
+    int expectedCount = 0;
+    for (int i = 0; i < queryList.size(); i++)
+    {
+        LogData *log = queryList.get(i);
+        if ((log->getTimestamp() >= query->from) && (log->getTimestamp() <= query->to) &&
+            ((query->auth < 0) || (log->getAuthentication() == query->auth)) &&
+            ((query->uid == nullptr) || (memcmp(log->getUid(), query->uid, log->getUidSize()) == 0)))
+        {
+            expected[i] = true;
+            expectedCount++;
+        }
+    }
+
+    bool ok = (count == expectedCount);
+    for (int i = 0; ok && (i < count); i++)
+    {
+        ok = (results[i] < queryList.size()) && expected[results[i]];
+        expected[results[i]] = false;
+        if (ok && (i > 0))
+        {
+            ok = queryList.get(results[i - 1])->getTimestamp() <= queryList.get(results[i])->getTimestamp();
+        }
+    }
+    if (!ok)
+    {
+        printf("log query differs: %d logs, %d expected\n", count, expectedCount);
+        exit(1);
+    }
+}
+
+/**
+ * @brief Check random log queries on a list kept near full, and the malformed F commands.
+ * @note Logs are added out of time order, acknowledged, removed from the middle and cleared
+ *       between the queries.
+ */
+static void checkLogQuery(void)
+{
+    uint8_t uids[BENCH_QUERY_UIDS + 1][10];
+    for (int i = 0; i <= BENCH_QUERY_UIDS; i++)
+    {
+        // The last one is never logged
+        makeUid(i * 7, uids[i]);
+    }
+
+    uint32_t time = 1700000000UL;
+    uint32_t matched = 0;
+    for (uint32_t round = 0; round < BENCH_QUERY_ROUNDS; round++)
+    {
+        uint32_t r = nextRandom() % 1000;
+        if (r < 960)
+        {
+            // Batches of the readers interleave, the timestamps go back by up to 10 minutes
+            time += nextRandom() % 60;
+            queryList.add(uids[nextRandom() % BENCH_QUERY_UIDS], time - nextRandom() % 600,
+                          (uint8_t)(nextRandom() % 2));
+        }
+        else if (r < 990)
+        {
+            queryList.acknowledge(queryList.getFirstSequence() + nextRandom() % 40);
+        }
+        else if (r < 999)
+        {
+            if (queryList.size() > 0)
+            {
+                queryList.remove((int)(nextRandom() % queryList.size()));
+            }
+        }
+        else
+        {
+            queryList.clear();
+        }
+
+        for (int i = 0; i < 3; i++)
+        {
+            log_query_t query;
+            query.from = time - nextRandom() % 20000;
+            query.to = query.from + nextRandom() % 20000;
+            int uid = nextRandom() % (BENCH_QUERY_UIDS + 3);
+            query.uid = (uid <= BENCH_QUERY_UIDS) ? uids[uid] : nullptr;
+            query.auth = (int)(nextRandom() % 3) - 1;
+            checkQuery(&query);
+            matched++;
+        }
+    }
+
+    // A malformed filter is refused, not taken as "any"
+    const char *malformed[] = {"F 0 4294967295 0102", "F 0 4294967295 zz02030405060708090A",
+                               "F 0 4294967295 0102030405060708090A0B", "F 0 4294967295 * 2",
+                               "F 0 4294967295 * x", "F 0"};
+    for (unsigned int i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++)
+    {
+        SIM_SerialOutputClear();
+        processMessage(malformed[i]);
+        while ((dumpType != 0) || !SERIALTX_IsEmpty())
+        {
+            taskSerialTransmit();
+            SIM_Advance(1000);
+        }
+        if (SIM_SerialOutput().find("<F ERR>") == std::string::npos)
+        {
+            printf("not refused: %s\n", malformed[i]);
+            exit(1);
+        }
+    }
+    printf("log query: %u queries match the filter of every log\n", (unsigned int)matched);
+}
+
+/** @brief Auth lists and statistics of the statistics check, apart from the ones of the sketch. */
+static AuthenticateList statsLists[2];
+static AccessStats stats;
+
+/**
+ * @brief Sum the counters of the UID table.
+ * @param grants Sum of the granted accesses.
+ * @param denies Sum of the denied accesses.
+ * @return Number of UIDs in the table.
+ */
+static int sumStats(uint32_t *grants, uint32_t *denies)
+{
+    int count = 0;
+    *grants = stats.getOverflowGrants();
+    *denies = stats.getOverflowDenies();
+    for (int i = 0; i < ACCESS_STATS_MAX_UIDS; i++)
+    {
+        const access_stats_entry_t *entry = stats.getEntry(i);
+        if (entry != nullptr)
+        {
+            *grants += entry->grants;
+            *denies += entry->denies;
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Check that only the UIDs of the auth list get an entry, and that the statistics survive
+ *        the saved copy and the change of the list.
+ */
+static void checkAccessStats(void)
+{
+    uint8_t uid[10];
+    for (int i = 0; i < AUTH_LIST_SIZE; i++)
+    {
+        makeUid(i, uid);
+        statsLists[0].add(uid, "User", 6 * 3600, 18 * 3600);
+    }
+    stats.setAuthList(&(statsLists[0]));
+    uint32_t listed = statsLists[0].size();
+
+    // Every listed card and many more unknown ones
+    const uint32_t count = 20000;
+    uint32_t time = 1800000000UL;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        time += nextRandom() % 30;
+        uint32_t card = ((i % 4) == 0) ? AUTH_LIST_SIZE + nextRandom() % 10000 : (i - i / 4) % listed;
+        makeUid(card, uid);
+        stats.add(uid, time, (uint8_t)(card < listed));
+    }
+
+    uint32_t grants;
+    uint32_t denies;
+    int uids = sumStats(&grants, &denies);
+    if ((uids != (int)listed) || (grants != count * 3 / 4) || (denies != count / 4) ||
+        (stats.getOverflowDenies() != count / 4))
+    {
+        printf("access stats: %d UIDs, %u grants, %u denies\n", uids, (unsigned int)grants, (unsigned int)denies);
+        exit(1);
+    }
+
+    // The saved copy is read back the same
+    static uint8_t saved[AccessStats::STORAGE_SIZE];
+    static uint8_t again[AccessStats::STORAGE_SIZE];
+    stats.serialize(saved);
+    stats.deserialize(saved);
+    stats.serialize(again);
+    if ((memcmp(saved, again, sizeof(saved)) != 0) || (sumStats(&grants, &denies) != (int)listed))
+    {
+        printf("access stats differ after the saved copy\n");
+        exit(1);
+    }
+
+    // A third of the users is removed, their accesses move to the overflow counters
+    statsLists[1] = statsLists[0];
+    for (uint32_t i = 0; i < listed; i += 3)
+    {
+        makeUid(i, uid);
+        statsLists[1].remove(uid);
+    }
+    stats.setAuthList(&(statsLists[1]));
+    uint32_t movedGrants;
+    uint32_t movedDenies;
+    uids = sumStats(&movedGrants, &movedDenies);
+    if ((uids != statsLists[1].size()) || (movedGrants != grants) || (movedDenies != denies))
+    {
+        printf("access stats lost on the list change: %d UIDs\n", uids);
+        exit(1);
+    }
+
+    // The kept UIDs are still found after the removed entries left their probe sequences
+    uint16_t overflow = stats.getOverflowGrants();
+    for (int i = 0; i < statsLists[1].size(); i++)
+    {
+        stats.add(statsLists[1].get(i)->getUid(), time, 1);
+    }
+    if (stats.getOverflowGrants() != overflow)
+    {
+        printf("access stats: %u kept UIDs not found after the list change\n",
+               (unsigned int)(stats.getOverflowGrants() - overflow));
+        exit(1);
+    }
+    printf("access stats: %d of %u swipes unknown, %d UIDs kept, %u B saved\n", (int)(count / 4),
+           (unsigned int)count, uids, (unsigned int)AccessStats::STORAGE_SIZE);
+}
+
+/**
+ * @brief Logs of a scenario of the packing check.
+ */
+typedef struct _bench_pack_scenario
+{
+    const char *name;     /**< Name of the scenario */
+    uint32_t gapMin;      /**< Shortest time between two logs in seconds */
+    uint32_t gapMax;      /**< Longest time between two logs in seconds */
+    uint32_t knownPermil; /**< Logs of the UIDs of the auth list per thousand */
+} bench_pack_scenario_t;
+
+/** @brief Log lists of the packing check. */
+static LogList packList;
+static LogList unpackList;
+
+/**
+ * @brief Check that the logs survive the packing, and measure how many fit in the EEPROM.
+ * @note The full log list is packed and unpacked, with the auth list it was packed with and with
+ *       another one. The capacity of the area is extrapolated from the bytes per log, the RAM list
+ *       holds only LOG_LIST_MAX_SIZE - 1 logs. Uses the auth lists of checkAccessStats().
+ */
+static void checkLogPack(void)
+{
+    static const bench_pack_scenario_t scenarios[] = {
+        {"badge bursts", 1, 30, 950},
+        {"workday", 60, 600, 900},
+        {"sparse", 3600, 4 * 3600, 700},
+        {"worst case", 0, 0, 0},
+    };
+    static uint8_t area[BENCH_LOG_AREA_SIZE];
+    const AuthenticateList *authList = &(statsLists[0]);
+    uint8_t uid[10];
+
+    for (unsigned int s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++)
+    {
+        const bench_pack_scenario_t *scenario = &(scenarios[s]);
+        uint64_t bytes = 0;
+        uint64_t logs = 0;
+        for (int list = 0; list < BENCH_PACK_LISTS; list++)
+        {
+            packList.clear();
+            uint32_t time = 1800000000UL + nextRandom() % 100000;
+            for (int i = 0; i < LOG_LIST_MAX_SIZE - 1; i++)
+            {
+                bool known = (nextRandom() % 1000) < scenario->knownPermil;
+                makeUid(known ? nextRandom() % authList->size() : AUTH_LIST_SIZE + nextRandom() % 100000, uid);
+                if (scenario->gapMax == 0)
+                {
+                    time = nextRandom();
+                }
+                else
+                {
+                    time += scenario->gapMin + nextRandom() % (scenario->gapMax - scenario->gapMin + 1);
+                }
+                packList.add(uid, time, (uint8_t)(nextRandom() % 2));
+            }
+
+            uint16_t count;
+            uint16_t length = LOGPACK_Encode(&packList, authList, area, sizeof(area), &count);
+            unpackList.clear();
+            int decoded = LOGPACK_Decode(area, sizeof(area), authList, &unpackList);
+            bool ok = (decoded == count) && (unpackList.size() == count);
+            for (int i = 0; ok && (i < count); i++)
+            {
+                const LogData *a = packList.get(i);
+                const LogData *b = unpackList.get(i);
+                ok = (memcmp(a->getUid(), b->getUid(), 10) == 0) && (a->getTimestamp() == b->getTimestamp()) &&
+                     (a->getAuthentication() == b->getAuthentication());
+            }
+
+            // With another auth list only the logs with a full UID are kept
+            unpackList.clear();
+            decoded = LOGPACK_Decode(area, sizeof(area), &(statsLists[1]), &unpackList);
+            for (int i = 0; ok && (i < unpackList.size()); i++)
+            {
+                ok = (authList->findByUid(unpackList.get(i)->getUid()) == -1);
+            }
+            if (!ok)
+            {
+                printf("log pack %s: logs differ after unpacking\n", scenario->name);
+                exit(1);
+            }
+            bytes += length - LOGPACK_HEADER_SIZE;
+            logs += count;
+        }
+
+        double perLog = (double)bytes / logs;
+        uint32_t fit = (uint32_t)((BENCH_LOG_AREA_SIZE - LOGPACK_HEADER_SIZE) / perLog);
+        uint32_t saved = (fit < LOG_LIST_MAX_SIZE - 1) ? fit : LOG_LIST_MAX_SIZE - 1;
+        printf("log pack %-14s %5.2f B/log, %4u fit in %u B, %3u of %u listed saved, %u as legacy records\n",
+               scenario->name, perLog, (unsigned int)fit, (unsigned int)BENCH_LOG_AREA_SIZE, (unsigned int)saved,
+               (unsigned int)(LOG_LIST_MAX_SIZE - 1),
+               (unsigned int)((saved < BENCH_LOG_AREA_SIZE / DataListManager::LEGACY_LOG_SIZE)
+                                  ? saved
+                                  : BENCH_LOG_AREA_SIZE / DataListManager::LEGACY_LOG_SIZE));
+    }
+}
+
+/**
+ * @brief Check that random payloads survive the framing and that bit errors are detected.
+ */
+static void checkFrameRoundTrip(void)
+{
+    uint8_t payload[FRAME_MAX_PAYLOAD];
+    uint8_t frame[FRAME_MAX_ENCODED];
+    uint8_t decoded[FRAME_MAX_ENCODED];
+
+    for (uint32_t i = 0; i < BENCH_FRAME_ROUND_TRIPS; i++)
+    {
+        uint16_t length = nextRandom() % (FRAME_MAX_PAYLOAD + 1);
+        for (uint16_t j = 0; j < length; j++)
+        {
+            // Many zeros, they are what COBS replaces
+            payload[j] = ((nextRandom() & 3) == 0) ? 0 : nextRandom();
+        }
+
+        uint16_t encoded = FRAME_Encode(payload, length, frame);
+        if ((encoded > FRAME_MAX_ENCODED) || (memchr(frame, FRAME_DELIMITER, encoded) != nullptr) ||
+            (FRAME_Decode(frame, encoded, decoded) != length) || (memcmp(payload, decoded, length) != 0))
+        {
+            printf("frame round trip failed at %u\n", (unsigned int)i);
+            exit(1);
+        }
+
+        uint32_t bit = nextRandom() % (encoded * 8);
+        frame[bit / 8] ^= 1 << (bit % 8);
+        if ((frame[bit / 8] != FRAME_DELIMITER) && (FRAME_Decode(frame, encoded, decoded) >= 0))
+        {
+            printf("bit error not detected at %u\n", (unsigned int)i);
+            exit(1);
+        }
+    }
+}
+
+/**
+ * @brief Make the binary add record of a test user.
+ * @param index Index of the user.
+ * @param record The record.
+ */
+static void makeAddRecord(uint32_t index, uint8_t *record)
+{
+    char name[16 + 1];
+    uint32_t intervalStart = 6 * 3600 + (index % 8) * 1800;
+    uint32_t intervalEnd = 18 * 3600 + (index % 4) * 3600;
+
+    makeUid(index, record);
+    snprintf(name, sizeof(name), "User %-11u", (unsigned int)index);
+    memcpy(&(record[10]), name, 16);
+    for (int i = 0; i < 4; i++)
+    {
+        record[26 + i] = intervalStart >> (24 - i * 8);
+        record[30 + i] = intervalEnd >> (24 - i * 8);
+    }
+}
+
+/**
+ * @brief Encode the binary update frames of all users.
+ * @param type 'A' or 'R'.
+ * @param frames The frames with their delimiters, appended.
+ * @return Number of frames.
+ */
+static uint32_t makeUpdateFrames(char type, std::vector<std::string> *frames)
+{
+    const int perFrame = (type == 'A') ? BENCH_ADDS_PER_FRAME : BENCH_REMOVES_PER_FRAME;
+    const int recordSize = (type == 'A') ? BENCH_ADD_RECORD_SIZE : BENCH_REMOVE_RECORD_SIZE;
+    uint8_t payload[FRAME_MAX_PAYLOAD];
+    uint8_t record[BENCH_ADD_RECORD_SIZE];
+    uint8_t frame[FRAME_MAX_ENCODED];
+
+    for (int first = 0; first < AUTH_LIST_SIZE - 1; first += perFrame)
+    {
+        int count = ((AUTH_LIST_SIZE - 1 - first) < perFrame) ? (AUTH_LIST_SIZE - 1 - first) : perFrame;
+        payload[0] = type;
+        payload[1] = count;
+        for (int i = 0; i < count; i++)
+        {
+            makeAddRecord(first + i, record);
+            memcpy(&(payload[2 + i * recordSize]), record, recordSize);
+        }
+        uint16_t length = FRAME_Encode(payload, 2 + count * recordSize, frame);
+        frames->push_back(std::string((const char *)frame, length));
+    }
+    return frames->size();
+}
+
+/**
+ * @brief Remove and add back all users of the full list in batches, with text and binary messages.
+ */
+static void benchFrames(void)
+{
+    const int rounds = 50;
+    const uint32_t users = AUTH_LIST_SIZE - 1;
+    char message[80];
+    std::vector<std::string> removeFrames;
+    std::vector<std::string> addFrames;
+    makeUpdateFrames('R', &removeFrames);
+    makeUpdateFrames('A', &addFrames);
+
+    checkFrameRoundTrip();
+
+    // Parse and apply, on the host
+    double nanos[4] = {0, 0, 0, 0};
+    for (int round = 0; round < rounds; round++)
+    {
+        for (int binary = 0; binary < 2; binary++)
+        {
+            for (int add = 0; add < 2; add++)
+            {
+                processMessage("B M");
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                if (binary)
+                {
+                    const std::vector<std::string> &frames = add ? addFrames : removeFrames;
+                    for (size_t i = 0; i < frames.size(); i++)
+                    {
+                        processBinaryMessage((const uint8_t *)frames[i].data(), frames[i].size());
+                    }
+                }
+                else
+                {
+                    for (uint32_t i = 0; i < users; i++)
+                    {
+                        makeAddMessage(i, message);
+                        if (!add)
+                        {
+                            // "R UID"
+                            message[0] = 'R';
+                            message[22] = '\0';
+                        }
+                        processMessage(message);
+                    }
+                }
+                nanos[binary * 2 + add] += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+                processMessage("E");
+                SERIALTX_Flush();
+                SIM_SerialOutputClear();
+                runUntilIdle();
+            }
+        }
+    }
+    const char *names[4] = {"parse + apply, text R", "parse + apply, text A", "parse + apply, frame R",
+                            "parse + apply, frame A"};
+    for (int i = 0; i < 4; i++)
+    {
+        printf("%-32s %8u %14.1f %14s\n", names[i], (unsigned int)(users * rounds), nanos[i] / (users * rounds), "-");
+    }
+
+    // Over the UART, on the board
+    const char *serialNames[4] = {"serial batch, text R", "serial batch, text A", "serial batch, frame R",
+                                  "serial batch, frame A"};
+    for (int binary = 0; binary < 2; binary++)
+    {
+        for (int add = 0; add < 2; add++)
+        {
+            std::string input = "<B M>";
+            if (binary)
+            {
+                const std::vector<std::string> &frames = add ? addFrames : removeFrames;
+                for (size_t i = 0; i < frames.size(); i++)
+                {
+                    input += (char)FRAME_DELIMITER;
+                    input += frames[i];
+                    input += (char)FRAME_DELIMITER;
+                }
+            }
+            else
+            {
+                for (uint32_t i = 0; i < users; i++)
+                {
+                    makeAddMessage(i, message);
+                    if (!add)
+                    {
+                        message[0] = 'R';
+                        message[22] = '\0';
+                    }
+                    input += "<";
+                    input += message;
+                    input += ">";
+                }
+            }
+            input += "<E>";
+
+            bench_timer_t timer;
+            startTimer(&timer);
+            SIM_SerialInput(input.c_str(), input.size());
+            runUntilIdle();
+            report(&timer, serialNames[binary * 2 + add], users);
+        }
+    }
+
+    if (dataListManager.getAuthList()->size() != AUTH_LIST_SIZE - 1)
+    {
+        printf("auth list not full after the updates: %d\n", dataListManager.getAuthList()->size());
+        exit(1);
+    }
+}
+
+/**
+ * @brief Flush the full lists into the memory image and commit it to the EEPROM.
+ */
+static void benchFlushCommit(void)
+{
+    const uint32_t count = 200;
+    uint8_t uid[10];
+    uint32_t time = 1800000000UL;
+    bench_timer_t timer;
+
+    double flushNanos = 0;
+    uint64_t commitMicros = 0;
+    uint32_t writes = SIM_EepromWrites();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        // A few new logs between two flushes, as at a busy door
+        for (int j = 0; j < 4; j++)
+        {
+            makeUid(nextRandom() % AUTH_LIST_SIZE, uid);
+            time += nextRandom() % 60;
+            dataListManager.logList.add(uid, time, 1);
+        }
+
+        startTimer(&timer);
+        dataListManager.updateEepromImageFromList();
+        flushNanos += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - timer.hostStart).count();
+
+        uint64_t start = SIM_GetMicros();
+        EEPROM_MemoryImage_Commit();
+        commitMicros += SIM_GetMicros() - start;
+    }
+    printf("%-32s %8u %14.1f %14.1f\n", "flush, full lists", (unsigned int)count, flushNanos / count, 0.0);
+    printf("%-32s %8u %14s %14.1f  (%.1f pages)\n", "commit after 4 logs", (unsigned int)count, "-",
+           (double)commitMicros / count, (double)(SIM_EepromWrites() - writes) / count);
+
+    // Every page changed, the worst case
+    uint8_t image[EEPROM_SIZE];
+    memcpy(image, EEPROM_GetMemoryImage(), EEPROM_SIZE);
+    for (int i = 0; i < EEPROM_SIZE; i++)
+    {
+        image[i] ^= 0x5A;
+    }
+    EEPROM_Write(0, image, EEPROM_SIZE);
+    startTimer(&timer);
+    EEPROM_MemoryImage_Commit();
+    report(&timer, "commit, whole image", 1);
+    for (int i = 0; i < EEPROM_SIZE; i++)
+    {
+        image[i] ^= 0x5A;
+    }
+    EEPROM_Write(0, image, EEPROM_SIZE);
+    EEPROM_MemoryImage_Commit();
+
+    if (SIM_EepromNacks() != 0)
+    {
+        printf("EEPROM transfers lost: %u\n", (unsigned int)SIM_EepromNacks());
+        exit(1);
+    }
+}
+
+/** @brief Number of lines of the block of the staging check. */
+static int stagingLines = 0;
+
+/** @brief Number of lines of the block already formatted. */
+static int stagingLine = 0;
+
+/** @brief Set while the block of the staging check is open. */
+static bool stagingBlockOpen = false;
+
+/**
+ * @brief Format the next lines of the block of the staging check, as continueDump() does.
+ */
+static void produceStagingBlock(void)
+{
+    while (stagingLine < stagingLines)
+    {
+        char *line = SERIALTX_Reserve(BENCH_STAGING_LINE_SIZE);
+        if (line == nullptr)
+        {
+            return;
+        }
+        memset(line, 'a' + (stagingLine % 26), BENCH_STAGING_LINE_SIZE - 1);
+        line[BENCH_STAGING_LINE_SIZE - 1] = '\n';
+        SERIALTX_Commit(BENCH_STAGING_LINE_SIZE);
+        stagingLine++;
+    }
+
+    char *end = SERIALTX_Reserve(1);
+    if (end != nullptr)
+    {
+        *end = '>';
+        SERIALTX_Commit(1);
+        SERIALTX_EndBlock();
+        stagingBlockOpen = false;
+    }
+}
+
+/**
+ * @brief Check that the output printed while a block is sent through the throttled UART FIFO
+ *        comes after the block, complete and in order.
+ * @note The status lines are random long, some of them do not fit in the hold buffer and finish
+ *       the block at once.
+ */
+static void checkSerialStaging(void)
+{
+    uint32_t finished = 0;
+    for (int round = 0; round < BENCH_STAGING_ROUNDS; round++)
+    {
+        SIM_SerialOutputClear();
+        std::string expected = "<D\n";
+        SERIALTX_GetPrint().print("<D\n");
+
+        stagingLines = 1 + nextRandom() % 60;
+        stagingLine = 0;
+        stagingBlockOpen = true;
+        SERIALTX_BeginBlock(produceStagingBlock);
+        produceStagingBlock();
+        for (int i = 0; i < stagingLines; i++)
+        {
+            expected += std::string(BENCH_STAGING_LINE_SIZE - 1, 'a' + (i % 26)) + "\n";
+        }
+        expected += ">";
+
+        std::string printed;
+        int events = nextRandom() % 12;
+        while ((events > 0) || stagingBlockOpen || !SERIALTX_IsEmpty())
+        {
+            if ((events > 0) && ((nextRandom() % 4) == 0))
+            {
+                // A status line or, outside the block, a reply
+                std::string text = std::to_string(round) + " " + std::to_string(events) + " " +
+                                   std::string(nextRandom() % 300, 'x');
+                bool open = stagingBlockOpen;
+                if (stagingBlockOpen || ((nextRandom() % 2) == 0))
+                {
+                    SERIALTX_GetEventPrint().println(text.c_str());
+                }
+                else
+                {
+                    SERIALTX_GetPrint().println(text.c_str());
+                }
+                if (open && !stagingBlockOpen)
+                {
+                    finished++;
+                }
+                printed += text + "\r\n";
+                events--;
+            }
+            SIM_Advance(nextRandom() % 3000);
+            if (stagingBlockOpen)
+            {
+                produceStagingBlock();
+            }
+            SERIALTX_Flush();
+        }
+        SIM_Advance(SIM_UART_FIFO_SIZE * SIM_UART_BYTE_MICROS);
+
+        expected += printed;
+        if (SIM_SerialOutput() != expected)
+        {
+            printf("staged output differs in round %d\n", round);
+            exit(1);
+        }
+    }
+    SIM_SerialOutputClear();
+    printf("staging: %d blocks in order, %u finished at once\n", BENCH_STAGING_ROUNDS, (unsigned int)finished);
+}
+
+/**
+ * @brief Send a dump while a reader requests the time, and measure the longest loop pass.
+ * @param command The dump request.
+ * @param blocking If true, the dump is sent at once as before the staging, in the same pass.
+ * @param name Name of the measurement.
+ */
+static void benchDump(const char *command, bool blocking, const char *name)
+{
+    std::shared_ptr<sim_connection_t> connection;
+    uint64_t worstPass = 0;
+
+    SIM_SerialOutputClear();
+    SIM_SerialInput(command, strlen(command));
+    uint64_t start = SIM_GetMicros();
+    do
+    {
+        uint64_t passStart = SIM_GetMicros();
+        loop();
+        if (blocking && (dumpType != 0))
+        {
+            SERIALTX_FinishBlock();
+        }
+        if ((SIM_GetMicros() - passStart) > worstPass)
+        {
+            worstPass = SIM_GetMicros() - passStart;
+        }
+        if ((connection == nullptr) && (SIM_SerialOutput().size() > 0))
+        {
+            // The reader asks for the time once the dump has started
+            connection = SIM_WifiConnect(0x0A000002, "T 0 ");
+        }
+        SIM_Advance(50);
+    } while ((SIM_SerialInputPending() > 0) || (dumpType != 0) || !SERIALTX_IsEmpty() ||
+             (connection == nullptr) || !connection->closed);
+    SIM_Advance(SIM_UART_FIFO_SIZE * SIM_UART_BYTE_MICROS);
+
+    const std::string &output = SIM_SerialOutput();
+    size_t lines = 0;
+    size_t end = output.find('>');
+    for (size_t i = 0; i < end; i++)
+    {
+        lines += (output[i] == '\n');
+    }
+    size_t status = output.find("Sending time...");
+    if ((end == std::string::npos) || (status == std::string::npos) || (status < end))
+    {
+        printf("%s: status line inside the dump\n", name);
+        exit(1);
+    }
+    printf("%-32s %8u %11.1f ms %11.1f ms  (worst loop pass)\n", name, (unsigned int)(lines - 1),
+           (SIM_GetMicros() - start) / 1000.0, worstPass / 1000.0);
+    SIM_SerialOutputClear();
+}
+
+/**
+ * @brief Stream tagged commands back to back behind a dump, and check that all are answered.
+ * @param count Number of commands after the dump request.
+ */
+static void checkPipeline(int count)
+{
+    std::string input = "<L>";
+    for (int i = 0; i < count; i++)
+    {
+        input += "<#" + std::to_string(i) + " K 0>";
+    }
+
+    uint32_t dropped = SIM_SerialInputDropped();
+    SIM_SerialOutputClear();
+    SIM_SerialInput(input.c_str(), input.size());
+    do
+    {
+        loop();
+        SIM_Advance(50);
+    } while ((SIM_SerialInputPending() > 0) || (dumpType != 0) || !SERIALTX_IsEmpty());
+
+    int replies = 0;
+    size_t position = 0;
+    while ((position = SIM_SerialOutput().find("<#", position)) != std::string::npos)
+    {
+        replies++;
+        position++;
+    }
+    printf("pipeline: %d of %d commands (%u bytes) behind a dump answered, %u bytes lost\n", replies,
+           count, (unsigned int)(input.size() - 3), (unsigned int)(SIM_SerialInputDropped() - dropped));
+    if (replies != count)
+    {
+        exit(1);
+    }
+    SIM_SerialOutputClear();
+}
+
+#if AUTH_STORE_ENABLED
+/**
+ * @brief Workloads of the user store.
+ */
+typedef enum _bench_store_workload
+{
+    BENCH_STORE_ZIPF,        /**< User k swipes with a probability of 1/k, Zipf(1) */
+    BENCH_STORE_WORKING_SET, /**< A few present users swipe */
+    BENCH_STORE_UNIFORM      /**< Every user swipes as often */
+} bench_store_workload_t;
+
+/**
+ * @brief Lookup counters of the known or of the unknown tags.
+ */
+typedef struct _bench_store_counters
+{
+    uint32_t lookups;
+    uint32_t hits;
+    uint32_t slotReads;
+    uint64_t missMicros;
+    uint64_t missMicrosMax;
+} bench_store_counters_t;
+
+/**
+ * @brief Look a tag up in the user store and count it.
+ * @param uid UID of the tag.
+ * @param known True if the tag is stored.
+ * @param counters Counters of the known or of the unknown tags.
+ */
+static void storeLookup(const uint8_t *uid, bool known, bench_store_counters_t *counters)
+{
+    auth_store_record_t record;
+    auth_store_stats_t before;
+    auth_store_stats_t after;
+
+    AUTHSTORE_GetStats(&before);
+    uint64_t start = SIM_GetMicros();
+    if (AUTHSTORE_Find(uid, &record) != known)
+    {
+        printf("user store lookup wrong\n");
+        exit(1);
+    }
+    uint64_t elapsed = SIM_GetMicros() - start;
+    AUTHSTORE_GetStats(&after);
+
+    counters->lookups++;
+    if (after.hits != before.hits)
+    {
+        counters->hits++;
+        return;
+    }
+    counters->slotReads += after.slotReads - before.slotReads;
+    counters->missMicros += elapsed;
+    if (elapsed > counters->missMicrosMax)
+    {
+        counters->missMicrosMax = elapsed;
+    }
+}
+
+/**
+ * @brief Print the lookup counters of the known or of the unknown tags.
+ * @param name Name of the tags.
+ * @param counters The counters.
+ */
+static void printStoreCounters(const char *name, const bench_store_counters_t *counters)
+{
+    uint32_t misses = counters->lookups - counters->hits;
+    printf("  %-8s %6u lookups, %5.1f%% cache hits, %.2f slot reads/miss, %.2f ms/miss, worst %.2f ms\n", name,
+           (unsigned int)counters->lookups, 100.0 * counters->hits / counters->lookups,
+           (misses == 0) ? 0.0 : (double)counters->slotReads / misses,
+           (misses == 0) ? 0.0 : counters->missMicros / 1000.0 / misses, counters->missMicrosMax / 1000.0);
+}
+
+/**
+ * @brief Swipe the tags of a workload, with BENCH_STORE_UNKNOWN_PERMIL unknown ones.
+ * @param name Name of the workload.
+ * @param workload The workload.
+ * @note The users 0 to BENCH_STORE_USERS - 1 are stored. The counters of the known and of the
+ *       unknown tags are printed apart, as an unknown tag is never cached.
+ */
+static void benchStoreWorkload(const char *name, bench_store_workload_t workload)
+{
+    static double zipf[BENCH_STORE_USERS];
+    double sum = 0;
+    for (int i = 0; i < BENCH_STORE_USERS; i++)
+    {
+        sum += 1.0 / (i + 1);
+        zipf[i] = sum;
+    }
+    uint32_t workingSet[BENCH_STORE_PRESENT_USERS];
+    for (int i = 0; i < BENCH_STORE_PRESENT_USERS; i++)
+    {
+        workingSet[i] = nextRandom() % BENCH_STORE_USERS;
+    }
+
+    bench_store_counters_t known;
+    bench_store_counters_t unknown;
+    uint8_t uid[10];
+    for (int phase = 0; phase < 2; phase++)
+    {
+        // The first phase warms the cache up
+        memset(&known, 0, sizeof(known));
+        memset(&unknown, 0, sizeof(unknown));
+        for (uint32_t i = 0; i < BENCH_STORE_SWIPES; i++)
+        {
+            if ((nextRandom() % 1000) < BENCH_STORE_UNKNOWN_PERMIL)
+            {
+                makeUid(BENCH_STORE_USERS + BENCH_STORE_CHURN + nextRandom() % 1000000, uid);
+                storeLookup(uid, false, &unknown);
+                continue;
+            }
+
+            uint32_t user;
+            if (workload == BENCH_STORE_ZIPF)
+            {
+                double r = sum * (nextRandom() % 1000000) / 1000000.0;
+                user = std::lower_bound(zipf, zipf + BENCH_STORE_USERS, r) - zipf;
+            }
+            else if (workload == BENCH_STORE_WORKING_SET)
+            {
+                user = workingSet[nextRandom() % BENCH_STORE_PRESENT_USERS];
+            }
+            else
+            {
+                user = nextRandom() % BENCH_STORE_USERS;
+            }
+            makeUid(user, uid);
+            storeLookup(uid, true, &known);
+        }
+    }
+
+    printf("user store, %s, cache of %d:\n", name, AUTH_STORE_CACHE_SIZE);
+    printStoreCounters("known", &known);
+    printStoreCounters("unknown", &unknown);
+}
+
+/**
+ * @brief Print the number of users and deleted slots of the user store.
+ * @param name Name of the phase.
+ */
+static void printStoreDeleted(const char *name)
+{
+    auth_store_stats_t stats;
+    AUTHSTORE_GetStats(&stats);
+    printf("  after %s: %u users, %u deleted slots in the probe sequences\n", name,
+           (unsigned int)stats.count, (unsigned int)stats.deleted);
+}
+
+/**
+ * @brief Remove users and add new ones, then measure the lookups of unknown tags.
+ * @note The removed users leave deleted slots. Without reclaiming them the empty slots run out, and
+ *       a lookup of an unknown tag walks a long probe sequence in RAM.
+ */
+static void benchStoreChurn(void)
+{
+    auth_store_record_t record;
+    bench_timer_t timer;
+    uint32_t next = BENCH_STORE_USERS;
+
+    for (uint32_t i = 0; i < BENCH_STORE_CHURN; i++)
+    {
+        // Keep the users 0 to BENCH_STORE_USERS - 1 for the workloads, churn the others
+        if (next > BENCH_STORE_USERS + 50)
+        {
+            makeUid(BENCH_STORE_USERS + (nextRandom() % (next - BENCH_STORE_USERS)), record.uid);
+            AUTHSTORE_Remove(record.uid);
+        }
+        makeUid(next++, record.uid);
+        snprintf(record.name, sizeof(record.name), "Guest");
+        record.intervalStart = 8 * 3600;
+        record.intervalEnd = 16 * 3600;
+        AUTHSTORE_Put(&record);
+    }
+
+    const uint32_t count = 20000;
+    startTimer(&timer);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        makeUid(BENCH_STORE_USERS + BENCH_STORE_CHURN + 1000000 + i, record.uid);
+        AUTHSTORE_Find(record.uid, &record);
+    }
+    report(&timer, "user store find, after churn", count);
+    printStoreDeleted("churn");
+
+    AUTHSTORE_Init(&authStoreStorage);
+    startTimer(&timer);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        makeUid(BENCH_STORE_USERS + BENCH_STORE_CHURN + 2000000 + i, record.uid);
+        AUTHSTORE_Find(record.uid, &record);
+    }
+    report(&timer, "user store find, after reboot", count);
+    printStoreDeleted("reboot");
+}
+#endif /* AUTH_STORE_ENABLED */
+
+/**
+ * @brief Add users to the user store and look them up.
+ */
+static void benchAuthStore(void)
+{
+#if AUTH_STORE_ENABLED
+    auth_store_record_t record;
+    bench_timer_t timer;
+
+    AUTHSTORE_Clear();
+    startTimer(&timer);
+    for (uint32_t i = 0; i < BENCH_STORE_USERS; i++)
+    {
+        makeUid(i, record.uid);
+        snprintf(record.name, sizeof(record.name), "User %u", (unsigned int)i);
+        record.intervalStart = 6 * 3600;
+        record.intervalEnd = 18 * 3600;
+        if (!AUTHSTORE_Put(&record))
+        {
+            printf("user store full at %u\n", (unsigned int)i);
+            exit(1);
+        }
+    }
+    report(&timer, "user store put", BENCH_STORE_USERS);
+
+    const uint32_t count = 20000;
+    startTimer(&timer);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        makeUid(BENCH_STORE_USERS + BENCH_STORE_CHURN + i, record.uid);
+        AUTHSTORE_Find(record.uid, &record);
+    }
+    report(&timer, "user store find, unknown", count);
+
+    benchStoreChurn();
+    benchStoreWorkload("Zipf(1)", BENCH_STORE_ZIPF);
+    benchStoreWorkload("working set", BENCH_STORE_WORKING_SET);
+    benchStoreWorkload("uniform", BENCH_STORE_UNIFORM);
+#endif /* AUTH_STORE_ENABLED */
+}
+
+/** @brief Data list managers of the storage check, one for each boot. */
+static DataListManager storageBoots[4];
+
+/**
+ * @brief Boot on a storage: read the memory image and the user store, then build the lists.
+ * @param name Name of the boot.
+ * @param image Storage of the memory image.
+ * @param store Storage of the user store.
+ * @param manager Data list manager of the boot.
+ */
+static void bootOnStorage(const char *name, StorageBackend *image, StorageBackend *store, DataListManager *manager)
+{
+    bench_timer_t timer;
+    startTimer(&timer);
+    EEPROM_Init(image);
+    AUTHSTORE_Init(store);
+    manager->Initialize();
+    report(&timer, name, 1);
+}
+
+/**
+ * @brief Fill the auth list, the logs and the user store, and write them to the storages.
+ * @param manager Data list manager of the first boot on the storages.
+ */
+static void fillStorage(DataListManager *manager)
+{
+    uint8_t uid[10];
+    manager->beginAuthBatch(false);
+    for (uint32_t i = 0; i < AUTH_LIST_SIZE; i++)
+    {
+        makeUid(i, uid);
+        manager->getAuthBatch()->add(uid, "User", 6 * 3600 + (i % 8) * 1800, 18 * 3600);
+    }
+    manager->commitAuthBatch();
+
+    manager->logList.clear();
+    for (uint32_t i = 0; i < BENCH_STORAGE_LOGS; i++)
+    {
+        makeUid(i % AUTH_LIST_SIZE, uid);
+        manager->logList.add(uid, 1800000000UL + i * 60, (uint8_t)(i % 8 != 0));
+    }
+    manager->updateEepromFromList();
+
+#if AUTH_STORE_ENABLED
+    auth_store_record_t record;
+    AUTHSTORE_Clear();
+    for (uint32_t i = 0; i < BENCH_STORAGE_STORE_USERS; i++)
+    {
+        makeUid(i, record.uid);
+        snprintf(record.name, sizeof(record.name), "User %u", (unsigned int)i);
+        record.intervalStart = 6 * 3600;
+        record.intervalEnd = 18 * 3600;
+        AUTHSTORE_Put(&record);
+    }
+#endif /* AUTH_STORE_ENABLED */
+}
+
+/**
+ * @brief Check that the second boot got what the first one saved.
+ * @param name Name of the storage.
+ * @param saved Data list manager of the first boot.
+ * @param restored Data list manager of the second boot.
+ */
+static void checkStorage(const char *name, const DataListManager *saved, const DataListManager *restored)
+{
+    bool ok = (restored->getAuthList()->hashUids() == saved->getAuthList()->hashUids()) &&
+              (restored->logList.size() == saved->logList.size());
+    for (int i = 0; ok && (i < saved->logList.size()); i++)
+    {
+        ok = (*(restored->logList.get(i)) == *(saved->logList.get(i)));
+    }
+
+#if AUTH_STORE_ENABLED
+    auth_store_record_t record;
+    for (uint32_t i = 0; ok && (i < BENCH_STORAGE_STORE_USERS); i++)
+    {
+        makeUid(i, record.uid);
+        ok = AUTHSTORE_Find(record.uid, &record) && (record.intervalEnd == 18 * 3600);
+    }
+#endif /* AUTH_STORE_ENABLED */
+
+    if (!ok)
+    {
+        printf("%s: the lists or the users differ after the restart\n", name);
+        exit(1);
+    }
+}
+
+/**
+ * @brief Run the persistence on the RAM and on the file storages, with a restart in between.
+ * @note The RAM storage keeps its content while the program runs, the restart only boots again.
+ *       The file storage is closed and opened again, as after a restart of the program.
+ */
+static void checkStorageBackends(void)
+{
+    static uint8_t ramImage[EEPROM_SIZE];
+    static uint8_t ramStore[AUTH_STORE_SIZE];
+    RamStorageBackend ramImageStorage(ramImage, sizeof(ramImage), EEPROM_24LC64_PAGE_SIZE,
+                                      EEPROM_24LC64_WRITE_DELAY_MS);
+    RamStorageBackend ramStoreStorage(ramStore, sizeof(ramStore), EEPROM_24LC64_PAGE_SIZE,
+                                      EEPROM_24LC64_WRITE_DELAY_MS);
+    bootOnStorage("boot, new RAM storage", &ramImageStorage, &ramStoreStorage, &(storageBoots[0]));
+    fillStorage(&(storageBoots[0]));
+    bootOnStorage("boot, RAM storage again", &ramImageStorage, &ramStoreStorage, &(storageBoots[1]));
+    checkStorage("RAM storage", &(storageBoots[0]), &(storageBoots[1]));
+
+    char directory[] = "/tmp/central_bench_XXXXXX";
+    if (mkdtemp(directory) == nullptr)
+    {
+        printf("file storage: no temporary directory\n");
+        exit(1);
+    }
+    std::string imagePath = std::string(directory) + "/image.bin";
+    std::string storePath = std::string(directory) + "/store.bin";
+    uint32_t pageWrites;
+    {
+        MmapStorageBackend imageStorage(imagePath.c_str(), EEPROM_SIZE, EEPROM_24LC64_PAGE_SIZE,
+                                        EEPROM_24LC64_WRITE_DELAY_MS);
+        MmapStorageBackend storeStorage(storePath.c_str(), AUTH_STORE_SIZE, EEPROM_24LC64_PAGE_SIZE,
+                                        EEPROM_24LC64_WRITE_DELAY_MS);
+        if (!imageStorage.isOpen() || !storeStorage.isOpen())
+        {
+            printf("file storage: the files could not be mapped\n");
+            exit(1);
+        }
+        bootOnStorage("boot, new file storage", &imageStorage, &storeStorage, &(storageBoots[2]));
+        fillStorage(&(storageBoots[2]));
+        pageWrites = imageStorage.getPageWrites() + storeStorage.getPageWrites();
+    }
+    {
+        MmapStorageBackend imageStorage(imagePath.c_str(), EEPROM_SIZE, EEPROM_24LC64_PAGE_SIZE,
+                                        EEPROM_24LC64_WRITE_DELAY_MS);
+        MmapStorageBackend storeStorage(storePath.c_str(), AUTH_STORE_SIZE, EEPROM_24LC64_PAGE_SIZE,
+                                        EEPROM_24LC64_WRITE_DELAY_MS);
+        bootOnStorage("boot, file storage reopened", &imageStorage, &storeStorage, &(storageBoots[3]));
+        checkStorage("file storage", &(storageBoots[2]), &(storageBoots[3]));
+    }
+    unlink(imagePath.c_str());
+    unlink(storePath.c_str());
+    rmdir(directory);
+    printf("storage: %d users, %d logs and %d stored users survive a restart, %u pages written\n",
+           storageBoots[3].getAuthList()->size(), storageBoots[3].logList.size(), BENCH_STORAGE_STORE_USERS,
+           (unsigned int)pageWrites);
+
+    // Back to the EEPROMs of the sketch
+    EEPROM_Init(&eepromStorage);
+    AUTHSTORE_Init(&authStoreStorage);
+}
+
+int main(void)
+{
+    printf("%-32s %8s %14s %14s\n", "operation", "count", "host ns/op", "board us/op");
+
+    benchBoot();
+    benchSerialBatch();
+    benchLookup();
+    checkUidFilter();
+    benchUpsert();
+    benchLogAdd();
+    benchParse();
+    benchFrames();
+    checkLogQuery();
+    checkAccessStats();
+    checkLogPack();
+    benchFlushCommit();
+    checkSerialStaging();
+    benchDump("<L>", true, "L dump, blocking");
+    benchDump("<L>", false, "L dump, staged");
+    benchDump("<Q>", true, "Q dump, blocking");
+    benchDump("<Q>", false, "Q dump, staged");
+    checkPipeline(100);
+    benchAuthStore();
+    checkStorageBackends();
+
+    return 0;
+}
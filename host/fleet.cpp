@@ -0,0 +1,678 @@
+/**
+ ***************************************************************************************************
+ * @file fleet.cpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Load test of the central module with a fleet of simulated readers and an operator.
+ *
+ * Usage: central_fleet [-v] [-r READERS] [-d SECONDS] [-n MS] [-t MS] [-s MS] [-m MS] [-e MS]
+ *                      [-l LOGS] [-b BYTES] [-o MS] [-u MS] [-x MS] [-k MS]
+ * -v prints the serial output of the central.
+ * -r number of readers, 4 by default.
+ * -d simulated duration of the test in seconds, 300 by default.
+ * -n, -t, -s, -m, -e: interval of the memory image downloads (N), time requests (T), time
+ *    synchronisations (S), memory image uploads (M) and log pushes (E) of a reader in ms, 0
+ *    disables the request. The log pushes are off by default.
+ * -l number of logs in an uploaded image, and of the new logs of a reader between two pushes.
+ * -b size of the uploaded image in bytes.
+ * -o timeout of a request in ms, the reader gives up and goes on with its next request.
+ * -u interval of the button presses of the operator in ms, 0 for no operator.
+ * -x loop passes longer than this many ms are counted as stalls.
+ * -k interval of the restarts of a reader in ms, 0 for none. A restarted reader numbers its
+ *    logs from 0 again in a new epoch, the logs it has not pushed yet are kept.
+ *
+ * The readers are simulated in the same thread as the central, each one is a state machine that
+ * sends its due requests one at a time, like the single threaded readers do. The requests
+ * arrive at the speed of the WiFi and the central is run in passes on the simulated clock, so a
+ * run is deterministic and the same options give the same report.
+ ***************************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BeleptetoRendszer_Kozponti.h"
+#include "button.h"
+#include "eeprom.h"
+#include "logsync.h"
+#include "sim.h"
+#include "sketch.h"
+
+/**
+ * @brief Simulated time between two passes of the loop.
+ */
+#define FLEET_LOOP_MICROS 100
+
+/**
+ * @brief IP address of the first reader (192.168.4.2), the others follow it.
+ */
+#define FLEET_FIRST_ADDRESS 0x0204A8C0UL
+
+/**
+ * @brief UNIX time of the start of the test, set on the central over the serial port.
+ */
+#define FLEET_START_TIME 1760000000UL
+
+/**
+ * @brief Number of users whose tags are logged by the readers.
+ */
+#define FLEET_USERS 64
+
+/**
+ * @brief Duration of a button press of the operator.
+ */
+#define FLEET_PRESS_MS 150
+
+/**
+ * @brief Layout of the memory image of a reader, see DataListManager.
+ * @{
+ */
+#define FLEET_IMAGE_HEADER_SIZE 14
+#define FLEET_IMAGE_LOG_BASE (EEPROM_SIZE / 2)
+#define FLEET_IMAGE_LOG_SIZE 15
+/** @} */
+
+/**
+ * @brief Requests of a reader.
+ */
+typedef enum _fleet_request
+{
+    FLEET_REQUEST_N,
+    FLEET_REQUEST_T,
+    FLEET_REQUEST_S,
+    FLEET_REQUEST_M,
+    FLEET_REQUEST_E,
+    FLEET_REQUEST_COUNT
+} fleet_request_t;
+
+/** @brief Types of the requests on the wire, indexed by fleet_request_t. */
+static const char requestTypes[FLEET_REQUEST_COUNT] = {'N', 'T', 'S', 'M', 'E'};
+
+/**
+ * @brief Options of the test.
+ */
+typedef struct _fleet_options
+{
+    bool verbose;
+    int readers;
+    uint32_t durationMs;
+    uint32_t intervalMs[FLEET_REQUEST_COUNT];
+    int uploadLogs;
+    int uploadBytes;
+    uint32_t timeoutMs;
+    uint32_t operatorMs;
+    uint32_t stallMs;
+    uint32_t restartMs;
+} fleet_options_t;
+
+/**
+ * @brief State of a simulated reader.
+ */
+typedef struct _fleet_reader
+{
+    uint32_t address;                                /**< IP address */
+    int32_t clockOffsetMs;                           /**< Error of the clock of the reader */
+    uint64_t nextMicros[FLEET_REQUEST_COUNT];        /**< When the requests are due */
+    uint64_t restartMicros;                          /**< When the reader restarts */
+    std::shared_ptr<sim_connection_t> connection;    /**< The request in progress */
+    fleet_request_t pendingRequest;                  /**< Type of the request in progress */
+    uint64_t pendingT1;                              /**< t1 of the time sync in progress */
+    uint64_t previousT1;                             /**< t1 of the last answered time sync */
+    uint64_t previousT4;                             /**< Arrival of the last time sync answer */
+    uint32_t logEpoch;                               /**< Boot epoch of the log sequence numbers */
+    uint32_t nextLogSequence;                        /**< Sequence number of the next new log */
+    uint32_t ackedLogSequence;                       /**< High-water mark answered by the central */
+    uint32_t pushedLogSequence;                      /**< Sequence number after the push in progress */
+} fleet_reader_t;
+
+/**
+ * @brief Results of a type of request.
+ */
+typedef struct _fleet_stats
+{
+    uint32_t sent = 0;
+    uint32_t failed = 0;
+    uint32_t timedOut = 0;
+    std::vector<uint32_t> latencies; /**< Of the answered requests, in us */
+} fleet_stats_t;
+
+/** @brief Pins of the buttons, indexed by the button IDs. */
+static const uint8_t buttonPins[BUTTON_COUNT] = {BUTTON_1_PIN, BUTTON_2_PIN, BUTTON_3_PIN, BUTTON_E_PIN};
+
+/** @brief State of the pseudo random generator of the test data. */
+static uint32_t randomState = 1;
+
+/**
+ * @brief Get a pseudo random number, the same sequence on every run.
+ * @return The number.
+ */
+static uint32_t nextRandom(void)
+{
+    randomState = randomState * 1103515245UL + 12345UL;
+    return randomState >> 8;
+}
+
+/**
+ * @brief Get the time on the clock of a reader.
+ * @param reader The reader.
+ * @param micros Simulated time.
+ * @return UNIX time in ms.
+ */
+static uint64_t readerMillis(const fleet_reader_t *reader, uint64_t micros)
+{
+    return (uint64_t)FLEET_START_TIME * 1000 + micros / 1000 + reader->clockOffsetMs;
+}
+
+/**
+ * @brief Put a big endian number into a memory image.
+ * @param image The image.
+ * @param address Address of the number.
+ * @param value The number.
+ * @param bytes Size of the number.
+ */
+static void putBigEndian(std::string *image, int address, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+    {
+        (*image)[address + i] = (char)(value >> ((bytes - 1 - i) * 8));
+    }
+}
+
+/**
+ * @brief Put a log in the legacy format into a request.
+ * @param data The request.
+ * @param address Address of the log.
+ * @param time Timestamp of the log.
+ */
+static void putLog(std::string *data, int address, uint32_t time)
+{
+    uint32_t user = nextRandom() % FLEET_USERS;
+    for (int j = 0; j < 10; j++)
+    {
+        (*data)[address + j] = (char)((user * 2654435761UL) >> ((j % 4) * 8)) ^ (j * 37);
+    }
+    putBigEndian(data, address + 10, time, 4);
+    (*data)[address + 14] = (char)((user % 8) != 0);
+}
+
+/**
+ * @brief Make the memory image a reader uploads.
+ * @param reader The reader.
+ * @param options Options of the test.
+ * @return The image, with the newest logs of the reader.
+ */
+static std::string makeImage(const fleet_reader_t *reader, const fleet_options_t *options)
+{
+    std::string image(options->uploadBytes, (char)0xFF);
+    uint32_t now = readerMillis(reader, SIM_GetMicros()) / 1000;
+
+    putBigEndian(&image, 0, FLEET_IMAGE_HEADER_SIZE, 2);
+    putBigEndian(&image, 2, 0, 2);
+    putBigEndian(&image, 4, FLEET_IMAGE_HEADER_SIZE, 2);
+    putBigEndian(&image, 6, options->uploadLogs * FLEET_IMAGE_LOG_SIZE, 2);
+    putBigEndian(&image, 8, FLEET_IMAGE_LOG_BASE, 2);
+    putBigEndian(&image, 10, now, 4);
+
+    for (int i = 0; i < options->uploadLogs; i++)
+    {
+        putLog(&image, FLEET_IMAGE_LOG_BASE + i * FLEET_IMAGE_LOG_SIZE, now - (options->uploadLogs - i) * 5);
+    }
+    return image;
+}
+
+/**
+ * @brief Make the log push of a reader.
+ * @param reader The reader, the new logs are counted in it.
+ * @param options Options of the test.
+ * @return The payload of the push: the epoch, the first sequence number and the logs the central
+ *         has not acknowledged yet.
+ */
+static std::string makePush(fleet_reader_t *reader, const fleet_options_t *options)
+{
+    uint32_t now = readerMillis(reader, SIM_GetMicros()) / 1000;
+    reader->nextLogSequence += options->uploadLogs;
+
+    uint32_t count = reader->nextLogSequence - reader->ackedLogSequence;
+    if (count > LOGSYNC_MAX_PUSH_LOGS)
+    {
+        count = LOGSYNC_MAX_PUSH_LOGS;
+    }
+    reader->pushedLogSequence = reader->ackedLogSequence + count;
+
+    std::string head = std::to_string(count) + " " + std::to_string(reader->logEpoch) + " " +
+                       std::to_string(reader->ackedLogSequence) + " ";
+    std::string logs(count * FLEET_IMAGE_LOG_SIZE, '\0');
+    for (uint32_t i = 0; i < count; i++)
+    {
+        putLog(&logs, i * FLEET_IMAGE_LOG_SIZE, now - (reader->nextLogSequence - reader->ackedLogSequence - i) * 5);
+    }
+    return head + logs;
+}
+
+/**
+ * @brief Make a request of a reader.
+ * @param reader The reader, the t1 of a time sync is stored in it.
+ * @param request Type of the request.
+ * @param options Options of the test.
+ * @return The request.
+ */
+static std::string makeRequest(fleet_reader_t *reader, fleet_request_t request, const fleet_options_t *options)
+{
+    std::string text(1, requestTypes[request]);
+    switch (request)
+    {
+    case FLEET_REQUEST_N:
+        return text + " " + std::to_string(EEPROM_SIZE) + " ";
+
+    case FLEET_REQUEST_T:
+        return text + " 0 ";
+
+    case FLEET_REQUEST_S:
+        reader->pendingT1 = readerMillis(reader, SIM_GetMicros());
+        if (reader->previousT1 == 0)
+        {
+            return text + " 1 " + std::to_string(reader->pendingT1) + "\n";
+        }
+        return text + " 3 " + std::to_string(reader->pendingT1) + " " + std::to_string(reader->previousT1) + " " +
+               std::to_string(reader->previousT4) + "\n";
+
+    case FLEET_REQUEST_M:
+        return text + " " + std::to_string(options->uploadBytes) + " " + makeImage(reader, options);
+
+    case FLEET_REQUEST_E:
+    default:
+        return text + " " + makePush(reader, options);
+    }
+}
+
+/**
+ * @brief Check the answer of the central to a request.
+ * @param reader The reader, the result of a time sync is stored in it.
+ * @param connection The closed connection.
+ * @return True if the request was served.
+ */
+static bool checkAnswer(fleet_reader_t *reader, const sim_connection_t *connection)
+{
+    const std::string &response = connection->response;
+    switch (reader->pendingRequest)
+    {
+    case FLEET_REQUEST_N:
+        return response.size() == EEPROM_SIZE;
+
+    case FLEET_REQUEST_T:
+        return (response.size() > 2) && (response.back() == '\n');
+
+    case FLEET_REQUEST_S:
+    {
+        unsigned long long t1;
+        unsigned long long t2;
+        unsigned long long t3;
+        if ((sscanf(response.c_str(), "%llu %llu %llu", &t1, &t2, &t3) != 3) || (t1 != reader->pendingT1))
+        {
+            return false;
+        }
+        reader->previousT1 = t1;
+        reader->previousT4 = readerMillis(reader, connection->closeMicros);
+        return true;
+    }
+
+    case FLEET_REQUEST_M:
+        // No answer, the whole image has to be read
+        return connection->readIndex == connection->request.size();
+
+    case FLEET_REQUEST_E:
+    default:
+    {
+        unsigned long mark;
+        if (sscanf(response.c_str(), "%lu", &mark) != 1)
+        {
+            return false;
+        }
+        reader->ackedLogSequence = mark;
+        return mark == reader->pushedLogSequence;
+    }
+    }
+}
+
+/**
+ * @brief Get a percentile of sorted values.
+ * @param values The values, sorted.
+ * @param percent The percentile.
+ * @return The value in ms.
+ */
+static double percentileMs(const std::vector<uint32_t> &values, int percent)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    return values[(values.size() - 1) * percent / 100] / 1e3;
+}
+
+/**
+ * @brief Parse a number option.
+ * @param text The option.
+ * @param value The number.
+ * @return True if the option is a number.
+ */
+static bool parseNumber(const char *text, uint32_t *value)
+{
+    char *end;
+    unsigned long number = strtoul(text, &end, 10);
+    if ((*text == '\0') || (*end != '\0'))
+    {
+        return false;
+    }
+    *value = number;
+    return true;
+}
+
+/**
+ * @brief Parse the options.
+ * @param argc Number of arguments.
+ * @param argv The arguments.
+ * @param options The options.
+ * @return True if the options are valid.
+ */
+static bool parseOptions(int argc, char **argv, fleet_options_t *options)
+{
+    uint32_t value;
+    int option;
+
+    while ((option = getopt(argc, argv, "vr:d:n:t:s:m:e:l:b:o:u:x:k:")) != -1)
+    {
+        if (option == 'v')
+        {
+            options->verbose = true;
+            continue;
+        }
+        if ((option == '?') || !parseNumber(optarg, &value))
+        {
+            return false;
+        }
+        switch (option)
+        {
+        case 'r':
+            options->readers = value;
+            break;
+        case 'd':
+            options->durationMs = value * 1000;
+            break;
+        case 'n':
+            options->intervalMs[FLEET_REQUEST_N] = value;
+            break;
+        case 't':
+            options->intervalMs[FLEET_REQUEST_T] = value;
+            break;
+        case 's':
+            options->intervalMs[FLEET_REQUEST_S] = value;
+            break;
+        case 'm':
+            options->intervalMs[FLEET_REQUEST_M] = value;
+            break;
+        case 'e':
+            options->intervalMs[FLEET_REQUEST_E] = value;
+            break;
+        case 'l':
+            options->uploadLogs = value;
+            break;
+        case 'b':
+            options->uploadBytes = value;
+            break;
+        case 'o':
+            options->timeoutMs = value;
+            break;
+        case 'u':
+            options->operatorMs = value;
+            break;
+        case 'x':
+            options->stallMs = value;
+            break;
+        case 'k':
+            options->restartMs = value;
+            break;
+        }
+    }
+
+    return (optind == argc) && (options->readers > 0) && (options->readers < 250) &&
+           (options->uploadBytes <= EEPROM_SIZE) &&
+           (FLEET_IMAGE_LOG_BASE + options->uploadLogs * FLEET_IMAGE_LOG_SIZE <= options->uploadBytes);
+}
+
+int main(int argc, char **argv)
+{
+    fleet_options_t options;
+    options.verbose = false;
+    options.readers = 4;
+    options.durationMs = 300000;
+    options.intervalMs[FLEET_REQUEST_N] = 10000;
+    options.intervalMs[FLEET_REQUEST_T] = 60000;
+    options.intervalMs[FLEET_REQUEST_S] = 5000;
+    options.intervalMs[FLEET_REQUEST_M] = 10000;
+    options.intervalMs[FLEET_REQUEST_E] = 0;
+    options.uploadLogs = 20;
+    options.uploadBytes = EEPROM_SIZE;
+    options.timeoutMs = 5000;
+    options.operatorMs = 2000;
+    options.stallMs = 50;
+    options.restartMs = 0;
+
+    if (!parseOptions(argc, argv, &options))
+    {
+        fprintf(stderr, "usage: central_fleet [-v] [-r READERS] [-d SECONDS] [-n MS] [-t MS] [-s MS] [-m MS] [-e MS]\n"
+                        "                     [-l LOGS] [-b BYTES] [-o MS] [-u MS] [-x MS] [-k MS]\n"
+                        "the uploaded images hold at least %d bytes and at most %d\n",
+                FLEET_IMAGE_LOG_BASE + options.uploadLogs * FLEET_IMAGE_LOG_SIZE, EEPROM_SIZE);
+        return 2;
+    }
+
+    setup();
+    const uint64_t startMicros = SIM_GetMicros();
+    const uint64_t endMicros = startMicros + (uint64_t)options.durationMs * 1000;
+    const uint32_t startWrites = SIM_EepromWrites();
+
+    std::string setTime = "<T " + std::to_string(FLEET_START_TIME) + ">";
+    SIM_SerialInput(setTime.data(), setTime.size());
+
+    std::vector<fleet_reader_t> readers(options.readers);
+    for (int i = 0; i < options.readers; i++)
+    {
+        fleet_reader_t *reader = &(readers[i]);
+        reader->address = FLEET_FIRST_ADDRESS + ((uint32_t)i << 24);
+        reader->clockOffsetMs = (int32_t)(nextRandom() % 2001) - 1000;
+        reader->pendingRequest = FLEET_REQUEST_N;
+        reader->previousT1 = 0;
+        reader->previousT4 = 0;
+        reader->logEpoch = nextRandom();
+        reader->nextLogSequence = nextRandom();
+        reader->ackedLogSequence = reader->nextLogSequence;
+        reader->pushedLogSequence = reader->nextLogSequence;
+        reader->restartMicros = (options.restartMs == 0) ? UINT64_MAX
+                                                         : startMicros + (uint64_t)(nextRandom() % options.restartMs) * 1000;
+        for (int r = 0; r < FLEET_REQUEST_COUNT; r++)
+        {
+            // The readers are switched on at random times, spread their requests
+            uint32_t interval = options.intervalMs[r];
+            reader->nextMicros[r] = (interval == 0) ? UINT64_MAX
+                                                    : startMicros + (uint64_t)(nextRandom() % interval) * 1000;
+        }
+    }
+
+    fleet_stats_t stats[FLEET_REQUEST_COUNT];
+    std::vector<uint32_t> blockingPasses;
+    uint64_t stallMicros = 0;
+    uint32_t stalls = 0;
+    uint64_t worstMicros = 0;
+    uint64_t worstAtMicros = 0;
+    uint64_t passes = 0;
+    uint32_t presses = 0;
+    uint32_t restarts = 0;
+    uint64_t nextPressMicros = (options.operatorMs == 0) ? UINT64_MAX : startMicros + options.operatorMs * 1000ULL;
+    uint64_t releaseMicros = UINT64_MAX;
+    uint8_t pressedPin = 0;
+    bool busy = true;
+
+    while ((SIM_GetMicros() < endMicros) || busy)
+    {
+        uint64_t now = SIM_GetMicros();
+        busy = (SIM_SerialInputPending() > 0) || (SIM_WifiPending() > 0) || (dumpType != 0) ||
+               !SERIALTX_IsEmpty() || (releaseMicros != UINT64_MAX);
+
+        for (size_t i = 0; i < readers.size(); i++)
+        {
+            fleet_reader_t *reader = &(readers[i]);
+            fleet_stats_t *requestStats = &(stats[reader->pendingRequest]);
+
+            uint64_t timeoutMicros = options.timeoutMs * 1000ULL;
+            if (reader->connection && reader->connection->closed)
+            {
+                uint64_t latency = reader->connection->closeMicros - reader->connection->connectMicros;
+                if (latency > timeoutMicros)
+                {
+                    // Answered during a blocking pass, after the reader gave up
+                    requestStats->timedOut++;
+                }
+                else if (checkAnswer(reader, reader->connection.get()))
+                {
+                    requestStats->latencies.push_back(latency);
+                }
+                else
+                {
+                    requestStats->failed++;
+                }
+                reader->connection.reset();
+            }
+            else if (reader->connection && (now - reader->connection->connectMicros > timeoutMicros))
+            {
+                // The reader gives up, the central still serves the request when it gets to it
+                requestStats->timedOut++;
+                reader->connection.reset();
+            }
+            if (reader->connection)
+            {
+                busy = true;
+                continue;
+            }
+            if (now >= endMicros)
+            {
+                continue;
+            }
+
+            if (now >= reader->restartMicros)
+            {
+                // The counter starts over, below the mark of the central in the previous epoch
+                uint32_t unpushed = reader->nextLogSequence - reader->ackedLogSequence;
+                reader->logEpoch = nextRandom();
+                reader->ackedLogSequence = 0;
+                reader->pushedLogSequence = 0;
+                reader->nextLogSequence = unpushed;
+                reader->previousT1 = 0;
+                reader->previousT4 = 0;
+                reader->restartMicros += options.restartMs * 1000ULL;
+                restarts++;
+            }
+
+            int due = -1;
+            for (int r = 0; r < FLEET_REQUEST_COUNT; r++)
+            {
+                if ((reader->nextMicros[r] <= now) && ((due < 0) || (reader->nextMicros[r] < reader->nextMicros[due])))
+                {
+                    due = r;
+                }
+            }
+            if (due < 0)
+            {
+                continue;
+            }
+
+            // A request that waited for the previous one is not repeated to catch up
+            reader->nextMicros[due] = std::max<uint64_t>(reader->nextMicros[due] + options.intervalMs[due] * 1000ULL, now);
+            reader->pendingRequest = (fleet_request_t)due;
+            reader->connection = SIM_WifiConnect(reader->address, makeRequest(reader, reader->pendingRequest, &options));
+            stats[due].sent++;
+            busy = true;
+        }
+
+        if (now >= releaseMicros)
+        {
+            SIM_SetPin(pressedPin, !BUTTON_PRESSED);
+            releaseMicros = UINT64_MAX;
+        }
+        if ((now >= nextPressMicros) && (now < endMicros))
+        {
+            pressedPin = buttonPins[nextRandom() % BUTTON_COUNT];
+            SIM_SetPin(pressedPin, BUTTON_PRESSED);
+            releaseMicros = now + FLEET_PRESS_MS * 1000;
+            nextPressMicros += options.operatorMs * 1000ULL;
+            presses++;
+        }
+
+        uint64_t passStart = SIM_GetMicros();
+        loop();
+        uint64_t pass = SIM_GetMicros() - passStart;
+        passes++;
+        if (pass > 0)
+        {
+            // Only the passes that waited for the hardware take simulated time
+            blockingPasses.push_back((uint32_t)pass);
+        }
+        if (pass > options.stallMs * 1000ULL)
+        {
+            stalls++;
+            stallMicros += pass;
+        }
+        if (pass > worstMicros)
+        {
+            worstMicros = pass;
+            worstAtMicros = passStart - startMicros;
+        }
+
+        if (options.verbose)
+        {
+            fwrite(SIM_SerialOutput().data(), 1, SIM_SerialOutput().size(), stdout);
+        }
+        SIM_SerialOutputClear();
+
+        SIM_Advance(FLEET_LOOP_MICROS);
+    }
+
+    double simSeconds = (SIM_GetMicros() - startMicros) / 1e6;
+    printf("readers           %d, %.3f s simulated, %llu loop passes, %u button presses, %u restarts\n",
+           options.readers, simSeconds, (unsigned long long)passes, (unsigned int)presses, (unsigned int)restarts);
+    printf("request      sent     ok failed timeout   p50 ms   p90 ms   p99 ms   max ms\n");
+
+    fleet_stats_t total;
+    for (int r = 0; r < FLEET_REQUEST_COUNT; r++)
+    {
+        fleet_stats_t *s = &(stats[r]);
+        total.sent += s->sent;
+        total.failed += s->failed;
+        total.timedOut += s->timedOut;
+        total.latencies.insert(total.latencies.end(), s->latencies.begin(), s->latencies.end());
+        std::sort(s->latencies.begin(), s->latencies.end());
+        printf("%c        %8u %6zu %6u %7u %8.1f %8.1f %8.1f %8.1f\n", requestTypes[r], (unsigned int)s->sent,
+               s->latencies.size(), (unsigned int)s->failed, (unsigned int)s->timedOut, percentileMs(s->latencies, 50),
+               percentileMs(s->latencies, 90), percentileMs(s->latencies, 99), percentileMs(s->latencies, 100));
+    }
+    std::sort(total.latencies.begin(), total.latencies.end());
+    printf("all      %8u %6zu %6u %7u %8.1f %8.1f %8.1f %8.1f\n", (unsigned int)total.sent, total.latencies.size(),
+           (unsigned int)total.failed, (unsigned int)total.timedOut, percentileMs(total.latencies, 50),
+           percentileMs(total.latencies, 90), percentileMs(total.latencies, 99), percentileMs(total.latencies, 100));
+
+    std::sort(blockingPasses.begin(), blockingPasses.end());
+    printf("loop stall        worst %.3f ms at %.3f s, p99 %.3f ms of %zu blocking passes\n", worstMicros / 1e3,
+           worstAtMicros / 1e6, percentileMs(blockingPasses, 99), blockingPasses.size());
+    printf("                  %u passes over %u ms, %.3f s stalled (%.1f%%)\n", (unsigned int)stalls,
+           (unsigned int)options.stallMs, stallMicros / 1e6, 100.0 * stallMicros / 1e6 / simSeconds);
+    printf("EEPROM writes     %u, lost transfers %u\n", (unsigned int)(SIM_EepromWrites() - startWrites),
+           (unsigned int)SIM_EepromNacks());
+
+    return 0;
+}
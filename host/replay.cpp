@@ -0,0 +1,393 @@
+/**
+ ***************************************************************************************************
+ * @file replay.cpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Replays a traffic capture of the central module through loop() on the simulated clock.
+ *
+ * Usage: central_replay [-v] CAPTURE [IMAGE]
+ * -v prints the serial output of the central.
+ * CAPTURE is a serial log with the "<Y ...>" records of capture.h, the other lines are ignored.
+ * IMAGE is an optional 8 KB EEPROM image the central boots from, a new EEPROM is used without it.
+ *
+ * The events are fed at their recorded times relative to the first one, after the boot. The run
+ * is deterministic: the same capture gives the same report, except for the host CPU times, and
+ * the same hash of the serial output and of the EEPROM.
+ ***************************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BeleptetoRendszer_Kozponti.h"
+#include "button.h"
+#include "eeprom.h"
+#include "frame.h"
+#include "sim.h"
+#include "sketch.h"
+
+/**
+ * @brief Simulated time between two passes of the loop.
+ */
+#define REPLAY_LOOP_MICROS 100
+
+/**
+ * @brief The replay goes on this long after the last event, for the delayed EEPROM writes.
+ */
+#define REPLAY_SETTLE_MS 3000
+
+/**
+ * @brief A recorded event.
+ */
+typedef struct _replay_event
+{
+    uint32_t millis;   /**< Time of the event on the recording central */
+    char kind;         /**< Kind of the event, see capture.h */
+    std::string data;  /**< Bytes to send: serial bytes, request of a reader */
+    uint32_t address;  /**< IP address of the reader */
+    uint8_t button;    /**< ID of the button */
+    bool pressed;      /**< State of the button */
+} replay_event_t;
+
+/** @brief Pins of the buttons, indexed by the button IDs. */
+static const uint8_t buttonPins[BUTTON_COUNT] = {BUTTON_1_PIN, BUTTON_2_PIN, BUTTON_3_PIN, BUTTON_E_PIN};
+
+/**
+ * @brief Decode hex digits.
+ * @param hex The digits, an even number of them.
+ * @param out The bytes, appended.
+ * @return True if all digits were valid.
+ */
+static bool decodeHex(const std::string &hex, std::string *out)
+{
+    if (hex.size() % 2 != 0)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < hex.size(); i += 2)
+    {
+        char digits[3] = {hex[i], hex[i + 1], '\0'};
+        char *end;
+        long value = strtol(digits, &end, 16);
+        if (*end != '\0')
+        {
+            return false;
+        }
+        out->push_back((char)value);
+    }
+    return true;
+}
+
+/**
+ * @brief Parse a record of a capture.
+ * @param record The record, between "<Y " and ">".
+ * @param event The event.
+ * @return True if the record is valid.
+ */
+static bool parseRecord(const std::string &record, replay_event_t *event)
+{
+    unsigned long millis;
+    char kind;
+    int consumed = 0;
+    if (sscanf(record.c_str(), "%lu %c %n", &millis, &kind, &consumed) < 2)
+    {
+        return false;
+    }
+    event->millis = millis;
+    event->kind = kind;
+    std::string rest = record.substr(consumed);
+
+    if (kind == 'S')
+    {
+        event->data = "<" + rest + ">";
+        return true;
+    }
+    if (kind == 'F')
+    {
+        event->data.push_back((char)0x00);
+        bool valid = decodeHex(rest, &(event->data));
+        event->data.push_back((char)0x00);
+        return valid;
+    }
+    if (kind == 'O')
+    {
+        // The bytes were not recorded, any bytes but the delimiter make the same overlong frame
+        int length;
+        if ((sscanf(rest.c_str(), "%d", &length) != 1) || (length <= FRAME_MAX_ENCODED))
+        {
+            return false;
+        }
+        event->data.push_back((char)0x00);
+        event->data.append(length, (char)0x01);
+        event->data.push_back((char)0x00);
+        return true;
+    }
+    if (kind == 'W')
+    {
+        unsigned long address;
+        char type;
+        int size;
+        char hex[2 * EEPROM_SIZE + 1] = "";
+        if (sscanf(rest.c_str(), "%lu %c %d %16384s", &address, &type, &size, hex) < 3)
+        {
+            return false;
+        }
+        event->address = address;
+        event->data = std::string(1, type) + " " + std::to_string(size) + " ";
+        return decodeHex(hex, &(event->data));
+    }
+    if (kind == 'B')
+    {
+        int button;
+        int pressed;
+        if ((sscanf(rest.c_str(), "%d %d", &button, &pressed) != 2) || (button < 0) || (button >= BUTTON_COUNT))
+        {
+            return false;
+        }
+        event->button = button;
+        event->pressed = (pressed != 0);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Read the events of a capture.
+ * @param path Path of the capture.
+ * @param events The events, in order of time.
+ * @return True if the file could be read.
+ */
+static bool readCapture(const char *path, std::vector<replay_event_t> *events)
+{
+    FILE *file = fopen(path, "r");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    std::string line;
+    int c;
+    int skipped = 0;
+    do
+    {
+        c = fgetc(file);
+        if ((c != '\n') && (c != EOF))
+        {
+            line.push_back((char)c);
+            continue;
+        }
+
+        // A record may follow a reply on the same line, the records never contain '>'
+        size_t begin = line.find("<Y ");
+        while (begin != std::string::npos)
+        {
+            size_t end = line.find('>', begin);
+            if (end == std::string::npos)
+            {
+                skipped++;
+                break;
+            }
+            replay_event_t event;
+            if (parseRecord(line.substr(begin + 3, end - begin - 3), &event))
+            {
+                events->push_back(event);
+            }
+            else
+            {
+                skipped++;
+            }
+            begin = line.find("<Y ", end);
+        }
+        line.clear();
+    } while (c != EOF);
+    fclose(file);
+
+    if (skipped > 0)
+    {
+        printf("skipped %d damaged records\n", skipped);
+    }
+    // The records are sent in order, but keep the replay monotonic on a damaged capture
+    std::stable_sort(events->begin(), events->end(),
+                     [](const replay_event_t &a, const replay_event_t &b)
+                     { return (int32_t)(a.millis - b.millis) < 0; });
+    return true;
+}
+
+/**
+ * @brief Add bytes to an FNV-1a hash.
+ * @param hash The hash, updated.
+ * @param data The bytes.
+ * @param length Number of bytes.
+ */
+static void hashBytes(uint32_t *hash, const uint8_t *data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        *hash ^= data[i];
+        *hash *= 16777619UL;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool verbose = (argc > 1) && (strcmp(argv[1], "-v") == 0);
+    if (verbose)
+    {
+        argv++;
+        argc--;
+    }
+    if ((argc < 2) || (argc > 3))
+    {
+        fprintf(stderr, "usage: central_replay [-v] CAPTURE [IMAGE]\n");
+        return 2;
+    }
+
+    std::vector<replay_event_t> events;
+    if (!readCapture(argv[1], &events))
+    {
+        fprintf(stderr, "can not read %s\n", argv[1]);
+        return 1;
+    }
+    if (events.empty())
+    {
+        fprintf(stderr, "no records in %s\n", argv[1]);
+        return 1;
+    }
+
+    if (argc == 3)
+    {
+        uint32_t size;
+        uint8_t *memory = SIM_EepromMemory(SIM_I2C_EEPROM_IMAGE, &size);
+        FILE *file = fopen(argv[2], "rb");
+        if ((file == nullptr) || (fread(memory, 1, size, file) != size))
+        {
+            fprintf(stderr, "can not read an EEPROM image of %u bytes from %s\n", (unsigned int)size, argv[2]);
+            return 1;
+        }
+        fclose(file);
+    }
+
+    setup();
+    SIM_SerialOutputClear();
+
+    const uint64_t startMicros = SIM_GetMicros();
+    const uint32_t firstMillis = events.front().millis;
+    const uint64_t endMicros = startMicros + (uint64_t)(events.back().millis - firstMillis + REPLAY_SETTLE_MS) * 1000;
+    const uint32_t startWrites = SIM_EepromWrites();
+
+    std::vector<std::shared_ptr<sim_connection_t>> connections;
+    std::vector<uint32_t> latencies;
+    uint64_t passes = 0;
+    uint64_t worstMicros = 0;
+    uint64_t worstAtMicros = 0;
+    double worstHostMicros = 0;
+    double hostMicros = 0;
+    uint32_t outputHash = 2166136261UL;
+    size_t outputBytes = 0;
+    size_t next = 0;
+    int counts[128] = {0};
+
+    while ((next < events.size()) || (SIM_GetMicros() < endMicros) || (SIM_SerialInputPending() > 0) ||
+           (SIM_WifiPending() > 0) || (dumpType != 0) || !SERIALTX_IsEmpty())
+    {
+        while ((next < events.size()) &&
+               (startMicros + (uint64_t)(events[next].millis - firstMillis) * 1000 <= SIM_GetMicros()))
+        {
+            const replay_event_t &event = events[next++];
+            counts[event.kind & 0x7F]++;
+            if ((event.kind == 'S') || (event.kind == 'F') || (event.kind == 'O'))
+            {
+                SIM_SerialInput(event.data.data(), event.data.size());
+            }
+            else if (event.kind == 'W')
+            {
+                connections.push_back(SIM_WifiConnect(event.address, event.data));
+            }
+            else if (event.kind == 'B')
+            {
+                SIM_SetPin(buttonPins[event.button], event.pressed ? BUTTON_PRESSED : !BUTTON_PRESSED);
+            }
+        }
+
+        uint64_t passStart = SIM_GetMicros();
+        std::chrono::steady_clock::time_point hostStart = std::chrono::steady_clock::now();
+        loop();
+        double hostPass = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - hostStart).count();
+        uint64_t pass = SIM_GetMicros() - passStart;
+
+        passes++;
+        hostMicros += hostPass;
+        if (hostPass > worstHostMicros)
+        {
+            worstHostMicros = hostPass;
+        }
+        if (pass > 0)
+        {
+            // Only the passes that waited for the hardware take simulated time
+            latencies.push_back((uint32_t)pass);
+        }
+        if (pass > worstMicros)
+        {
+            worstMicros = pass;
+            worstAtMicros = passStart - startMicros;
+        }
+
+        const std::string &output = SIM_SerialOutput();
+        hashBytes(&outputHash, (const uint8_t *)output.data(), output.size());
+        outputBytes += output.size();
+        if (verbose)
+        {
+            fwrite(output.data(), 1, output.size(), stdout);
+        }
+        SIM_SerialOutputClear();
+
+        SIM_Advance(REPLAY_LOOP_MICROS);
+    }
+
+    uint32_t size;
+    const uint8_t *memory = SIM_EepromMemory(SIM_I2C_EEPROM_IMAGE, &size);
+    uint32_t eepromHash = 2166136261UL;
+    hashBytes(&eepromHash, memory, size);
+
+    uint64_t requestWorstMicros = 0;
+    uint64_t requestTotalMicros = 0;
+    for (size_t i = 0; i < connections.size(); i++)
+    {
+        uint64_t latency = connections[i]->closeMicros - connections[i]->connectMicros;
+        requestTotalMicros += latency;
+        if (latency > requestWorstMicros)
+        {
+            requestWorstMicros = latency;
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    double simSeconds = (SIM_GetMicros() - startMicros) / 1e6;
+    size_t eventCount = events.size();
+
+    printf("events            %zu (serial %d, frames %d, WiFi %d, buttons %d)\n", eventCount,
+           counts['S'], counts['F'] + counts['O'], counts['W'], counts['B']);
+    printf("simulated time    %.3f s, %llu loop passes\n", simSeconds, (unsigned long long)passes);
+    printf("throughput        %.1f events/s simulated, %.0f events/s host CPU\n",
+           eventCount / simSeconds, eventCount / (hostMicros / 1e6));
+    printf("loop latency      worst %.3f ms at %.3f s, p99 %.3f ms of %zu blocking passes\n",
+           worstMicros / 1e3, worstAtMicros / 1e6,
+           latencies.empty() ? 0.0 : latencies[latencies.size() * 99 / 100] / 1e3, latencies.size());
+    printf("host loop time    worst %.1f us, mean %.2f us\n", worstHostMicros, hostMicros / passes);
+    printf("WiFi requests     %zu, mean %.3f ms, worst %.3f ms until closed\n", connections.size(),
+           connections.empty() ? 0.0 : requestTotalMicros / 1e3 / connections.size(), requestWorstMicros / 1e3);
+    printf("EEPROM writes     %u, lost transfers %u\n", (unsigned int)(SIM_EepromWrites() - startWrites),
+           (unsigned int)SIM_EepromNacks());
+    printf("serial output     %zu bytes, hash %08X\n", outputBytes, (unsigned int)outputHash);
+    printf("EEPROM image hash %08X\n", (unsigned int)eepromHash);
+
+    return 0;
+}
@@ -0,0 +1,300 @@
+/**
+ ***************************************************************************************************
+ * @file Arduino.cpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Implementation of the host shim of the Arduino core and of the clock, pins and UART of
+ *        sim.h.
+ ***************************************************************************************************
+ */
+
+#include <Arduino.h>
+
+#include <deque>
+
+#include "sim.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+/** @brief The simulated time in microseconds. */
+static uint64_t nowMicros = 0;
+
+/** @brief Levels of the pins, the buttons are pulled up. */
+static int pinLevel[32];
+static bool pinLevelInitialized = false;
+
+/** @brief Pin change interrupt handlers, indexed by the interrupt numbers. */
+static void (*pinIsrs[16])(void);
+
+/** @brief Bytes sent to the UART, received one by one at the baud rate. */
+static std::deque<uint8_t> serialInput;
+
+/** @brief Arrival time of the bytes of serialInput. */
+static std::deque<uint64_t> serialInputMicros;
+
+/** @brief Size of the receive buffer of the UART. */
+static size_t serialRxBufferSize = SIM_UART_RX_BUFFER_SIZE;
+
+/** @brief Number of received bytes lost because the receive buffer was full. */
+static uint32_t serialInputDropped = 0;
+
+/** @brief Bytes sent by the UART. */
+static std::string serialOutput;
+
+/** @brief Time when the transmit FIFO of the UART becomes empty. */
+static uint64_t uartIdleMicros = 0;
+
+/** @brief State of the pseudo random generator, fixed so runs are repeatable. */
+static uint32_t randomState = 0x12345678;
+
+unsigned long millis(void)
+{
+    // 32 bits like on the ESP8266
+    return (uint32_t)(nowMicros / 1000);
+}
+
+unsigned long micros(void)
+{
+    return (uint32_t)nowMicros;
+}
+
+void delay(unsigned long ms)
+{
+    nowMicros += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    nowMicros += us;
+}
+
+void yield(void)
+{
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    (void)pin;
+    (void)mode;
+}
+
+int digitalRead(uint8_t pin)
+{
+    if (!pinLevelInitialized)
+    {
+        for (int i = 0; i < 32; i++)
+        {
+            pinLevel[i] = HIGH;
+        }
+        pinLevelInitialized = true;
+    }
+    return (pin < 32) ? pinLevel[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    SIM_SetPin(pin, value);
+}
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode)
+{
+    // Only CHANGE is used, SIM_SetPin() calls the handler on every edge
+    (void)mode;
+    if (interrupt < 16)
+    {
+        pinIsrs[interrupt] = isr;
+    }
+}
+
+uint32_t EspClass::random(void)
+{
+    // xorshift32
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+/**
+ * @brief Drop the arrived bytes that did not fit in the receive buffer.
+ * @return Number of the arrived bytes in the buffer.
+ * @note Nothing was read since the last call, so the bytes over the size arrived when the buffer
+ *       was full, the core drops them.
+ */
+static int receiveArrived(void)
+{
+    // The arrival times are increasing, only the arrived bytes are counted
+    size_t count = 0;
+    while ((count < serialInputMicros.size()) && (serialInputMicros[count] <= nowMicros))
+    {
+        count++;
+    }
+    if (count > serialRxBufferSize)
+    {
+        serialInput.erase(serialInput.begin() + serialRxBufferSize, serialInput.begin() + count);
+        serialInputMicros.erase(serialInputMicros.begin() + serialRxBufferSize, serialInputMicros.begin() + count);
+        serialInputDropped += count - serialRxBufferSize;
+        count = serialRxBufferSize;
+    }
+    return (int)count;
+}
+
+size_t HardwareSerial::setRxBufferSize(size_t size)
+{
+    serialRxBufferSize = size;
+    return size;
+}
+
+int HardwareSerial::available(void)
+{
+    return receiveArrived();
+}
+
+int HardwareSerial::read(void)
+{
+    receiveArrived();
+    if (serialInput.empty() || (serialInputMicros.front() > nowMicros))
+    {
+        return -1;
+    }
+    uint8_t data = serialInput.front();
+    serialInput.pop_front();
+    serialInputMicros.pop_front();
+    return data;
+}
+
+int HardwareSerial::peek(void)
+{
+    receiveArrived();
+    if (serialInput.empty() || (serialInputMicros.front() > nowMicros))
+    {
+        return -1;
+    }
+    return serialInput.front();
+}
+
+int HardwareSerial::availableForWrite(void)
+{
+    if (uartIdleMicros <= nowMicros)
+    {
+        return SIM_UART_FIFO_SIZE;
+    }
+    uint64_t queued = (uartIdleMicros - nowMicros + SIM_UART_BYTE_MICROS - 1) / SIM_UART_BYTE_MICROS;
+    return (queued >= SIM_UART_FIFO_SIZE) ? 0 : (SIM_UART_FIFO_SIZE - queued);
+}
+
+size_t HardwareSerial::write(uint8_t data)
+{
+    return write(&data, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        if (availableForWrite() == 0)
+        {
+            // Blocks like the core does when the FIFO is full
+            nowMicros = uartIdleMicros - (SIM_UART_FIFO_SIZE - 1) * SIM_UART_BYTE_MICROS;
+        }
+        uartIdleMicros = ((uartIdleMicros > nowMicros) ? uartIdleMicros : nowMicros) + SIM_UART_BYTE_MICROS;
+        serialOutput.push_back(data[i]);
+    }
+    return length;
+}
+
+/**
+ * @brief Advance the simulated time.
+ * @param us Microseconds to advance by.
+ */
+void SIM_Advance(uint64_t us)
+{
+    nowMicros += us;
+}
+
+/**
+ * @brief Get the simulated time.
+ * @return Microseconds since the start, not truncated to 32 bits.
+ */
+uint64_t SIM_GetMicros(void)
+{
+    return nowMicros;
+}
+
+/**
+ * @brief Send bytes to the UART, they arrive one by one at 115200 baud from now on.
+ * @param data The bytes.
+ * @param length Number of bytes.
+ */
+void SIM_SerialInput(const char *data, size_t length)
+{
+    uint64_t arrival = serialInputMicros.empty() ? nowMicros : serialInputMicros.back();
+    if (arrival < nowMicros)
+    {
+        arrival = nowMicros;
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        arrival += SIM_UART_BYTE_MICROS;
+        serialInput.push_back(data[i]);
+        serialInputMicros.push_back(arrival);
+    }
+}
+
+/**
+ * @brief Get the number of bytes the sketch has not read yet.
+ * @return Number of bytes sent to the UART and not read, including the ones still arriving.
+ */
+size_t SIM_SerialInputPending(void)
+{
+    receiveArrived();
+    return serialInput.size();
+}
+
+/**
+ * @brief Get the number of received bytes lost because the receive buffer of the UART was full.
+ * @return Number of bytes.
+ */
+uint32_t SIM_SerialInputDropped(void)
+{
+    return serialInputDropped;
+}
+
+/**
+ * @brief Get the bytes sent by the UART since the last clear.
+ * @return The bytes.
+ */
+const std::string &SIM_SerialOutput(void)
+{
+    return serialOutput;
+}
+
+/**
+ * @brief Clear the bytes sent by the UART.
+ */
+void SIM_SerialOutputClear(void)
+{
+    serialOutput.clear();
+}
+
+/**
+ * @brief Set the level of a pin.
+ * @param pin The pin.
+ * @param value HIGH or LOW.
+ */
+void SIM_SetPin(uint8_t pin, int value)
+{
+    digitalRead(0);
+    if ((pin < 32) && (pinLevel[pin] != value))
+    {
+        pinLevel[pin] = value;
+        // The pin change interrupt, it catches the edges while the loop is blocked
+        int interrupt = digitalPinToInterrupt(pin);
+        if ((interrupt != NOT_AN_INTERRUPT) && (pinIsrs[interrupt] != nullptr))
+        {
+            pinIsrs[interrupt]();
+        }
+    }
+}
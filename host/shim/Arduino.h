@@ -0,0 +1,148 @@
+/**
+ ***************************************************************************************************
+ * @file Arduino.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Host shim of the Arduino core of the ESP8266.
+ *
+ * The time is simulated, it only advances with delay(), the I2C transfers and SIM_Advance(), so a
+ * run on the host is repeatable. See sim.h for driving the simulation.
+ ***************************************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#include "Print.h"
+
+/**
+ * @defgroup arduino_pins Pin constants
+ * @{
+ */
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 3
+#define RISING 1
+#define FALLING 2
+#define NOT_AN_INTERRUPT -1
+/** @} */
+
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield(void);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode);
+
+inline int digitalPinToInterrupt(int pin)
+{
+    return (pin < 16) ? pin : NOT_AN_INTERRUPT;
+}
+
+inline void noInterrupts(void) {}
+inline void interrupts(void) {}
+
+#include "Stream.h"
+
+/**
+ * @brief The subset of the Arduino String used by the sketch.
+ */
+class String
+{
+private:
+    std::string str;
+
+public:
+    String(const char *c_str = "") : str(c_str) {}
+    String(const std::string &s) : str(s) {}
+
+    char operator[](unsigned int index) const
+    {
+        return (index < str.size()) ? str[index] : 0;
+    }
+
+    String substring(unsigned int begin, unsigned int end) const
+    {
+        if (begin > str.size())
+        {
+            return String();
+        }
+        return String(str.substr(begin, end - begin));
+    }
+
+    String substring(unsigned int begin) const
+    {
+        if (begin > str.size())
+        {
+            return String();
+        }
+        return String(str.substr(begin));
+    }
+
+    const char *c_str(void) const
+    {
+        return str.c_str();
+    }
+
+    long toInt(void) const
+    {
+        return atol(str.c_str());
+    }
+
+    unsigned int length(void) const
+    {
+        return str.size();
+    }
+}; // String
+
+/**
+ * @brief The UART, fed and drained by the simulation.
+ */
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long baud)
+    {
+        (void)baud;
+    }
+
+    size_t setRxBufferSize(size_t size);
+
+    int available(void) override;
+    int read(void) override;
+    int peek(void) override;
+    int availableForWrite(void);
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t *data, size_t length) override;
+    using Print::write;
+}; // HardwareSerial
+
+extern HardwareSerial Serial;
+
+/**
+ * @brief The ESP8266 specific functions used by the sketch.
+ */
+class EspClass
+{
+public:
+    uint32_t random(void);
+}; // EspClass
+
+extern EspClass ESP;
@@ -0,0 +1,161 @@
+/**
+ ***************************************************************************************************
+ * @file ESP8266WiFi.cpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Implementation of the host shim of the ESP8266WiFi library and the connections of sim.h.
+ *
+ * A request is accepted once all of its bytes have arrived. Writing the response takes its time
+ * on the air, like the blocking writes of the core.
+ ***************************************************************************************************
+ */
+
+#include <ESP8266WiFi.h>
+
+#include <deque>
+
+ESP8266WiFiClass WiFi;
+
+/** @brief The connections not accepted yet, in order of arrival. */
+static std::deque<std::shared_ptr<sim_connection_t>> pending;
+
+class SimClientLink
+{
+public:
+    std::shared_ptr<sim_connection_t> connection;
+
+    SimClientLink(const std::shared_ptr<sim_connection_t> &connection) : connection(connection) {}
+
+    ~SimClientLink(void)
+    {
+        close();
+    }
+
+    void close(void)
+    {
+        if (!connection->closed)
+        {
+            connection->closed = true;
+            connection->closeMicros = SIM_GetMicros();
+        }
+    }
+}; // SimClientLink
+
+WiFiClient::WiFiClient(const std::shared_ptr<sim_connection_t> &connection)
+    : link(std::make_shared<SimClientLink>(connection))
+{
+}
+
+sim_connection_t *WiFiClient::connection(void) const
+{
+    return link ? link->connection.get() : nullptr;
+}
+
+int WiFiClient::available(void)
+{
+    sim_connection_t *c = connection();
+    return (c == nullptr) ? 0 : (c->request.size() - c->readIndex);
+}
+
+int WiFiClient::read(void)
+{
+    sim_connection_t *c = connection();
+    if ((c == nullptr) || (c->readIndex >= c->request.size()))
+    {
+        return -1;
+    }
+    return (uint8_t)c->request[c->readIndex++];
+}
+
+int WiFiClient::peek(void)
+{
+    sim_connection_t *c = connection();
+    if ((c == nullptr) || (c->readIndex >= c->request.size()))
+    {
+        return -1;
+    }
+    return (uint8_t)c->request[c->readIndex];
+}
+
+size_t WiFiClient::write(uint8_t data)
+{
+    return write(&data, 1);
+}
+
+size_t WiFiClient::write(const uint8_t *data, size_t length)
+{
+    sim_connection_t *c = connection();
+    if ((c == nullptr) || c->closed)
+    {
+        return 0;
+    }
+    SIM_Advance((uint64_t)length * SIM_WIFI_BYTE_MICROS);
+    c->response.append((const char *)data, length);
+    return length;
+}
+
+uint8_t WiFiClient::connected(void)
+{
+    sim_connection_t *c = connection();
+    return (c != nullptr) && !c->closed;
+}
+
+void WiFiClient::stop(void)
+{
+    if (link)
+    {
+        link->close();
+    }
+}
+
+IPAddress WiFiClient::remoteIP(void)
+{
+    sim_connection_t *c = connection();
+    return (c == nullptr) ? IPAddress() : IPAddress(c->address);
+}
+
+WiFiClient WiFiServer::available(void)
+{
+    if (pending.empty() || (pending.front()->readyMicros > SIM_GetMicros()))
+    {
+        return WiFiClient();
+    }
+    std::shared_ptr<sim_connection_t> connection = pending.front();
+    pending.pop_front();
+    connection->accepted = true;
+    connection->acceptMicros = SIM_GetMicros();
+    return WiFiClient(connection);
+}
+
+/**
+ * @brief Connect a reader to the server and send its request.
+ * @param address IP address of the reader.
+ * @param request The request.
+ * @return The connection, the response and the times are filled in by the central.
+ * @note The connections are accepted in order, a request is ready when all of its bytes have
+ *       arrived at SIM_WIFI_BYTE_MICROS each.
+ */
+std::shared_ptr<sim_connection_t> SIM_WifiConnect(uint32_t address, const std::string &request)
+{
+    std::shared_ptr<sim_connection_t> connection = std::make_shared<sim_connection_t>();
+    connection->address = address;
+    connection->request = request;
+    connection->connectMicros = SIM_GetMicros();
+    connection->readyMicros = connection->connectMicros + (uint64_t)request.size() * SIM_WIFI_BYTE_MICROS;
+    if (!pending.empty() && (connection->readyMicros < pending.back()->readyMicros))
+    {
+        connection->readyMicros = pending.back()->readyMicros;
+    }
+    pending.push_back(connection);
+    return connection;
+}
+
+/**
+ * @brief Get the number of connections the central has not accepted yet.
+ * @return Number of waiting connections.
+ */
+size_t SIM_WifiPending(void)
+{
+    return pending.size();
+}
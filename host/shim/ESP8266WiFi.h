@@ -0,0 +1,114 @@
+/**
+ ***************************************************************************************************
+ * @file ESP8266WiFi.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Host shim of the ESP8266WiFi library, the readers connect through sim.h.
+ ***************************************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <memory>
+
+#include "sim.h"
+
+/**
+ * @brief An IPv4 address.
+ */
+class IPAddress
+{
+private:
+    uint32_t address = 0;
+
+public:
+    IPAddress(void) {}
+    IPAddress(uint32_t address) : address(address) {}
+
+    operator uint32_t() const
+    {
+        return address;
+    }
+}; // IPAddress
+
+/**
+ * @brief Closes the connection when the last copy of its client is gone.
+ */
+class SimClientLink;
+
+/**
+ * @brief A TCP connection accepted by the server.
+ */
+class WiFiClient : public Stream
+{
+private:
+    std::shared_ptr<SimClientLink> link;
+
+    sim_connection_t *connection(void) const;
+
+public:
+    WiFiClient(void) {}
+    WiFiClient(const std::shared_ptr<sim_connection_t> &connection);
+
+    int available(void) override;
+    int read(void) override;
+    int peek(void) override;
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t *data, size_t length) override;
+    using Print::write;
+
+    uint8_t connected(void);
+    void stop(void);
+    IPAddress remoteIP(void);
+
+    explicit operator bool(void)
+    {
+        return connection() != nullptr;
+    }
+}; // WiFiClient
+
+/**
+ * @brief A TCP server.
+ */
+class WiFiServer
+{
+public:
+    WiFiServer(uint16_t port)
+    {
+        (void)port;
+    }
+
+    void begin(void) {}
+
+    WiFiClient available(void);
+}; // WiFiServer
+
+#define WIFI_AP 2
+
+/**
+ * @brief The WiFi interface.
+ */
+class ESP8266WiFiClass
+{
+public:
+    bool mode(int mode)
+    {
+        (void)mode;
+        return true;
+    }
+
+    bool softAP(const char *ssid, const char *password, int channel, int hidden, int max_connection)
+    {
+        (void)ssid;
+        (void)password;
+        (void)channel;
+        (void)hidden;
+        (void)max_connection;
+        return true;
+    }
+}; // ESP8266WiFiClass
+
+extern ESP8266WiFiClass WiFi;
@@ -0,0 +1,80 @@
+/**
+ ***************************************************************************************************
+ * @file LCD_I2C.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Host shim of the LCD_I2C library, the display content is kept in RAM.
+ ***************************************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief A character LCD of up to 4 rows and 20 columns.
+ */
+class LCD_I2C : public Print
+{
+private:
+    char text[4][20 + 1];
+    uint8_t columns;
+    uint8_t rows;
+    uint8_t column = 0;
+    uint8_t row = 0;
+
+public:
+    LCD_I2C(uint8_t address, uint8_t columns, uint8_t rows)
+        : columns((columns <= 20) ? columns : 20), rows((rows <= 4) ? rows : 4)
+    {
+        (void)address;
+        clear();
+    }
+
+    void begin(bool begin_wire)
+    {
+        (void)begin_wire;
+    }
+
+    void backlight(void) {}
+    void noBacklight(void) {}
+
+    void clear(void)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            memset(text[i], ' ', columns);
+            text[i][columns] = '\0';
+        }
+        column = 0;
+        row = 0;
+    }
+
+    void setCursor(uint8_t col, uint8_t line)
+    {
+        column = col;
+        row = line;
+    }
+
+    size_t write(uint8_t data) override
+    {
+        if ((row < rows) && (column < columns))
+        {
+            text[row][column] = data;
+        }
+        column++;
+        return 1;
+    }
+    using Print::write;
+
+    /**
+     * @brief Get a row of the display.
+     * @param line Index of the row.
+     * @return The characters of the row.
+     */
+    const char *getRow(uint8_t line) const
+    {
+        return text[(line < rows) ? line : 0];
+    }
+}; // LCD_I2C
@@ -0,0 +1,88 @@
+/**
+ ***************************************************************************************************
+ * @file Print.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Host shim of the Print class of the Arduino core.
+ ***************************************************************************************************
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Byte sink with the text formatting of the Arduino core.
+ */
+class Print
+{
+public:
+    virtual ~Print(void) {}
+
+    virtual size_t write(uint8_t data) = 0;
+
+    virtual size_t write(const uint8_t *data, size_t length)
+    {
+        size_t i = 0;
+        while ((i < length) && (write(data[i]) == 1))
+        {
+            i++;
+        }
+        return i;
+    }
+
+    size_t write(const char *str)
+    {
+        return write((const uint8_t *)str, strlen(str));
+    }
+
+    size_t print(const char *str)
+    {
+        return write(str);
+    }
+
+    size_t print(char c)
+    {
+        return write((uint8_t)c);
+    }
+
+    size_t print(long value)
+    {
+        char buffer[24];
+        snprintf(buffer, sizeof(buffer), "%ld", value);
+        return write(buffer);
+    }
+
+    size_t print(unsigned long value)
+    {
+        char buffer[24];
+        snprintf(buffer, sizeof(buffer), "%lu", value);
+        return write(buffer);
+    }
+
+    size_t print(int value)
+    {
+        return print((long)value);
+    }
+
+    size_t print(unsigned int value)
+    {
+        return print((unsigned long)value);
+    }
+
+    size_t println(void)
+    {
+        return write("\r\n");
+    }
+
+    template <typename T>
+    size_t println(T value)
+    {
+        size_t length = print(value);
+        return length + println();
+    }
+}; // Print
@@ -0,0 +1,104 @@
+/**
+ ***************************************************************************************************
+ * @file Stream.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Host shim of the Stream class of the Arduino core.
+ ***************************************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "Print.h"
+
+/**
+ * @brief Byte source with the parsing of the Arduino core.
+ * @note The reads wait for the data up to the timeout on the simulated clock, as on the board.
+ */
+class Stream : public Print
+{
+private:
+    unsigned long timeout = 1000;
+
+    int timedRead(void)
+    {
+        unsigned long start = millis();
+        do
+        {
+            int c = read();
+            if (c >= 0)
+            {
+                return c;
+            }
+            delay(1);
+        } while ((millis() - start) < timeout);
+        return -1;
+    }
+
+    int timedPeek(void)
+    {
+        unsigned long start = millis();
+        do
+        {
+            int c = peek();
+            if (c >= 0)
+            {
+                return c;
+            }
+            delay(1);
+        } while ((millis() - start) < timeout);
+        return -1;
+    }
+
+public:
+    virtual int available(void) = 0;
+    virtual int read(void) = 0;
+    virtual int peek(void) = 0;
+
+    void setTimeout(unsigned long timeout_ms)
+    {
+        timeout = timeout_ms;
+    }
+
+    size_t readBytes(uint8_t *buffer, size_t length)
+    {
+        size_t i = 0;
+        while (i < length)
+        {
+            int c = timedRead();
+            if (c < 0)
+            {
+                break;
+            }
+            buffer[i++] = c;
+        }
+        return i;
+    }
+
+    long parseInt(void)
+    {
+        int c = timedPeek();
+        while ((c >= 0) && (c != '-') && ((c < '0') || (c > '9')))
+        {
+            read();
+            c = timedPeek();
+        }
+        bool negative = (c == '-');
+        if (negative)
+        {
+            read();
+            c = timedPeek();
+        }
+        long value = 0;
+        while ((c >= '0') && (c <= '9'))
+        {
+            value = value * 10 + (c - '0');
+            read();
+            c = timedPeek();
+        }
+        return negative ? -value : value;
+    }
+}; // Stream
@@ -0,0 +1,201 @@
+/**
+ ***************************************************************************************************
+ * @file Wire.cpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Implementation of the host shim of the I2C library and the EEPROMs of sim.h.
+ *
+ * Every transfer advances the simulated clock by its duration on the bus. An EEPROM does not
+ * acknowledge for 5 ms after a write, as the real parts, the lost transfers are counted.
+ ***************************************************************************************************
+ */
+
+#include <Wire.h>
+
+#include <vector>
+
+#include "sim.h"
+
+TwoWire Wire;
+
+/**
+ * @brief Duration of the write cycle of the EEPROMs.
+ */
+#define SIM_EEPROM_WRITE_MICROS 5000
+
+/**
+ * @brief A simulated EEPROM of the 24LC family.
+ */
+typedef struct _sim_eeprom
+{
+    uint8_t address;        /**< Device address */
+    uint32_t size;          /**< Size in bytes */
+    uint16_t pageSize;      /**< Size of a page in bytes */
+    uint8_t *memory;        /**< Content */
+    uint32_t pointer;       /**< Address of the next read */
+    uint64_t busyUntil;     /**< End of the write cycle */
+} sim_eeprom_t;
+
+static uint8_t imageMemory[8192];
+static uint8_t storeMemory[65536];
+
+static sim_eeprom_t eeproms[] = {
+    {SIM_I2C_EEPROM_IMAGE, sizeof(imageMemory), 32, imageMemory, 0, 0},
+    {SIM_I2C_EEPROM_STORE, sizeof(storeMemory), 128, storeMemory, 0, 0},
+};
+
+static bool eepromsErased = false;
+static uint8_t txAddress = 0;
+static std::vector<uint8_t> txData;
+static std::vector<uint8_t> rxData;
+static size_t rxIndex = 0;
+static uint32_t writes = 0;
+static uint32_t nacks = 0;
+
+/**
+ * @brief Find a device on the bus.
+ * @param address Device address.
+ * @return The EEPROM, nullptr if nothing answers at the address.
+ */
+static sim_eeprom_t *findEeprom(uint8_t address)
+{
+    if (!eepromsErased)
+    {
+        // New parts read as 0xFF
+        memset(imageMemory, 0xFF, sizeof(imageMemory));
+        memset(storeMemory, 0xFF, sizeof(storeMemory));
+        eepromsErased = true;
+    }
+    for (size_t i = 0; i < sizeof(eeproms) / sizeof(eeproms[0]); i++)
+    {
+        if (eeproms[i].address == address)
+        {
+            return &(eeproms[i]);
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Advance the clock by the duration of a transfer.
+ * @param bytes Number of bytes after the control byte.
+ */
+static void transfer(size_t bytes)
+{
+    // Start + control byte + bytes, 9 bits each with the acknowledge + stop
+    SIM_Advance((uint64_t)(1 + (1 + bytes) * 9 + 1) * SIM_I2C_BIT_MICROS);
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    txAddress = address;
+    txData.clear();
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+    txData.push_back(data);
+    return 1;
+}
+
+uint8_t TwoWire::endTransmission(bool stop)
+{
+    (void)stop;
+    sim_eeprom_t *eeprom = findEeprom(txAddress);
+    if ((eeprom == nullptr) || (SIM_GetMicros() < eeprom->busyUntil))
+    {
+        // Address not acknowledged
+        transfer(0);
+        nacks++;
+        return 2;
+    }
+
+    transfer(txData.size());
+    if (txData.size() < 2)
+    {
+        return 0;
+    }
+
+    uint32_t address = (((uint32_t)txData[0] << 8) | txData[1]) % eeprom->size;
+    eeprom->pointer = address;
+    if (txData.size() > 2)
+    {
+        // The address wraps around within the page
+        uint32_t page = address - (address % eeprom->pageSize);
+        for (size_t i = 2; i < txData.size(); i++)
+        {
+            eeprom->memory[page + (address + i - 2) % eeprom->pageSize] = txData[i];
+        }
+        eeprom->busyUntil = SIM_GetMicros() + SIM_EEPROM_WRITE_MICROS;
+        writes++;
+    }
+    return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, size_t length)
+{
+    rxData.clear();
+    rxIndex = 0;
+
+    sim_eeprom_t *eeprom = findEeprom(address);
+    if ((eeprom == nullptr) || (SIM_GetMicros() < eeprom->busyUntil))
+    {
+        transfer(0);
+        nacks++;
+        return 0;
+    }
+
+    transfer(length);
+    for (size_t i = 0; i < length; i++)
+    {
+        rxData.push_back(eeprom->memory[eeprom->pointer]);
+        eeprom->pointer = (eeprom->pointer + 1) % eeprom->size;
+    }
+    return length;
+}
+
+int TwoWire::available(void)
+{
+    return rxData.size() - rxIndex;
+}
+
+int TwoWire::read(void)
+{
+    return (rxIndex < rxData.size()) ? rxData[rxIndex++] : -1;
+}
+
+/**
+ * @brief Get the content of a simulated EEPROM.
+ * @param address Device address.
+ * @param size Size of the EEPROM.
+ * @return The content, nullptr if there is no EEPROM at the address.
+ */
+uint8_t *SIM_EepromMemory(uint8_t address, uint32_t *size)
+{
+    sim_eeprom_t *eeprom = findEeprom(address);
+    if (eeprom == nullptr)
+    {
+        return nullptr;
+    }
+    *size = eeprom->size;
+    return eeprom->memory;
+}
+
+/**
+ * @brief Get the number of writes to the simulated EEPROMs.
+ * @return Number of page and byte writes.
+ */
+uint32_t SIM_EepromWrites(void)
+{
+    return writes;
+}
+
+/**
+ * @brief Get the number of transfers the simulated EEPROMs did not acknowledge.
+ * @return Number of transfers during a write cycle or to a missing device.
+ */
+uint32_t SIM_EepromNacks(void)
+{
+    return nacks;
+}
@@ -0,0 +1,40 @@
+/**
+ ***************************************************************************************************
+ * @file Wire.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Host shim of the I2C library, the bus is simulated with EEPROMs on it.
+ ***************************************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief The I2C master.
+ */
+class TwoWire
+{
+public:
+    void begin(int sda, int scl)
+    {
+        (void)sda;
+        (void)scl;
+    }
+
+    void setClock(uint32_t frequency)
+    {
+        (void)frequency;
+    }
+
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t data);
+    uint8_t endTransmission(bool stop = true);
+    uint8_t requestFrom(uint8_t address, size_t length);
+    int available(void);
+    int read(void);
+}; // TwoWire
+
+extern TwoWire Wire;
@@ -0,0 +1,98 @@
+/**
+ ***************************************************************************************************
+ * @file sim.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Header file for driving the simulated hardware of the host build.
+ *
+ * The simulated clock starts at 0 and only advances when the sketch waits (delay(), a full UART
+ * transmit FIFO, an I2C transfer) or when SIM_Advance() is called.
+ ***************************************************************************************************
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+/**
+ * @defgroup sim_i2c Simulated I2C bus
+ * @brief The bus runs at 100 kHz like on the board, which the LCD limits.
+ * @{
+ */
+#define SIM_I2C_BIT_MICROS 10
+/** @brief Device address of the 24LC64 of the memory image. */
+#define SIM_I2C_EEPROM_IMAGE 0x57
+/** @brief Device address of the 24LC512 of the user store. */
+#define SIM_I2C_EEPROM_STORE 0x50
+/** @} */
+
+/**
+ * @brief Duration of a byte on the UART at 115200 baud, 10 bits.
+ */
+#define SIM_UART_BYTE_MICROS 87
+
+/**
+ * @brief Size of the transmit FIFO of the UART.
+ */
+#define SIM_UART_FIFO_SIZE 128
+
+/**
+ * @brief Default size of the receive buffer of the UART in the ESP8266 core.
+ */
+#define SIM_UART_RX_BUFFER_SIZE 256
+
+/**
+ * @brief Duration of a byte on the WiFi link, about 1 Mbit/s of TCP throughput of the soft AP.
+ */
+#define SIM_WIFI_BYTE_MICROS 8
+
+/**
+ * @brief A TCP connection of a simulated reader.
+ */
+typedef struct _sim_connection
+{
+    uint32_t address = 0;       /**< IP address of the reader */
+    std::string request;        /**< Bytes sent by the reader */
+    size_t readIndex = 0;       /**< Number of bytes read by the central */
+    std::string response;       /**< Bytes sent by the central */
+    uint64_t connectMicros = 0; /**< Time of the connection */
+    uint64_t readyMicros = 0;   /**< Time when the request has arrived */
+    uint64_t acceptMicros = 0;  /**< Time of the acceptance by the central */
+    uint64_t closeMicros = 0;   /**< Time of the closing by the central */
+    bool accepted = false;      /**< Set when the central accepted the connection */
+    bool closed = false;        /**< Set when the central closed the connection */
+} sim_connection_t;
+
+void SIM_Advance(uint64_t us);
+
+uint64_t SIM_GetMicros(void);
+
+void SIM_SerialInput(const char *data, size_t length);
+
+size_t SIM_SerialInputPending(void);
+
+uint32_t SIM_SerialInputDropped(void);
+
+const std::string &SIM_SerialOutput(void);
+
+void SIM_SerialOutputClear(void);
+
+void SIM_SetPin(uint8_t pin, int value);
+
+uint8_t *SIM_EepromMemory(uint8_t address, uint32_t *size);
+
+uint32_t SIM_EepromWrites(void);
+
+uint32_t SIM_EepromNacks(void);
+
+std::shared_ptr<sim_connection_t> SIM_WifiConnect(uint32_t address, const std::string &request);
+
+size_t SIM_WifiPending(void);
+
+#endif /* SIM_H */
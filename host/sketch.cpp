@@ -0,0 +1,11 @@
+/**
+ ***************************************************************************************************
+ * @file sketch.cpp
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief The sketch compiled as a C++ source, as the Arduino IDE does with the .ino file.
+ ***************************************************************************************************
+ */
+
+#include "BeleptetoRendszer_Kozponti.ino"
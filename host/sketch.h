@@ -0,0 +1,37 @@
+/**
+ ***************************************************************************************************
+ * @file sketch.h
+ * @author Péter Varga
+ * @date 2026. 10. 18.
+ ***************************************************************************************************
+ * @brief Header file for the parts of the sketch used by the host programs.
+ ***************************************************************************************************
+ */
+
+#ifndef SKETCH_H
+#define SKETCH_H
+
+#include <stdint.h>
+
+#include "DataListManager.hpp"
+#include "EepromStorageBackend.hpp"
+#include "UiStateMachine.hpp"
+#include "serialtx.h"
+
+extern DataListManager dataListManager;
+extern UiStateMachine uiStateMachine;
+extern LCD_I2C lcd;
+extern char dumpType;
+extern EepromStorageBackend eepromStorage;
+extern EepromStorageBackend authStoreStorage;
+
+void setup();
+void loop();
+
+void processMessage(const char *msg);
+void processBinaryMessage(const uint8_t *frame, int length);
+void revceiveMessage(void);
+void startDump(char type, int index, int count);
+void taskSerialTransmit(void);
+
+#endif /* SKETCH_H */